@@ -0,0 +1,605 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <aversive/grid_planner/grid_planner.h>
+
+#define GRID_INF 1e20f
+
+/* Cells whose heap position is this value were already expanded */
+#define GRID_CLOSED (-2)
+
+static int grid_idx(const struct grid_planner* gp, int x, int y)
+{
+    return y * gp->size_x + x;
+}
+
+static int grid_is_occupied(const struct grid_planner* gp, int idx)
+{
+    return gp->static_occupancy[idx] || gp->dynamic_occupancy[idx];
+}
+
+static int grid_clamp(int v, int min, int max)
+{
+    if (v < min) {
+        return min;
+    }
+    if (v > max) {
+        return max;
+    }
+    return v;
+}
+
+static int grid_cell_x(const struct grid_planner* gp, float x)
+{
+    return floorf((x - gp->playground.x1) / gp->params.resolution_mm);
+}
+
+static int grid_cell_y(const struct grid_planner* gp, float y)
+{
+    return floorf((y - gp->playground.y1) / gp->params.resolution_mm);
+}
+
+static int grid_rect_is_empty(const struct grid_planner_rect* r)
+{
+    return r->x1 > r->x2 || r->y1 > r->y2;
+}
+
+/* Adds delta to the occupancy of every cell whose center is in the polygon.
+ * Returns the cells which were considered. */
+static struct grid_planner_rect grid_rasterize(struct grid_planner* gp, uint8_t* occupancy, const poly_t* poly, int delta)
+{
+    struct grid_planner_rect r = {0, 0, -1, -1};
+    float min_x, min_y, max_x, max_y;
+    int i, x, y;
+
+    if (poly->l < 3) {
+        return r;
+    }
+
+    min_x = max_x = poly->pts[0].x;
+    min_y = max_y = poly->pts[0].y;
+    for (i = 1; i < poly->l; i++) {
+        min_x = fminf(min_x, poly->pts[i].x);
+        max_x = fmaxf(max_x, poly->pts[i].x);
+        min_y = fminf(min_y, poly->pts[i].y);
+        max_y = fmaxf(max_y, poly->pts[i].y);
+    }
+
+    r.x1 = grid_clamp(grid_cell_x(gp, min_x), 0, gp->size_x - 1);
+    r.x2 = grid_clamp(grid_cell_x(gp, max_x), 0, gp->size_x - 1);
+    r.y1 = grid_clamp(grid_cell_y(gp, min_y), 0, gp->size_y - 1);
+    r.y2 = grid_clamp(grid_cell_y(gp, max_y), 0, gp->size_y - 1);
+
+    for (y = r.y1; y <= r.y2; y++) {
+        for (x = r.x1; x <= r.x2; x++) {
+            point_t center;
+            center.x = gp->playground.x1 + (x + 0.5f) * gp->params.resolution_mm;
+            center.y = gp->playground.y1 + (y + 0.5f) * gp->params.resolution_mm;
+
+            if (is_in_poly(&center, (poly_t*)poly)) {
+                occupancy[grid_idx(gp, x, y)] += delta;
+            }
+        }
+    }
+
+    return r;
+}
+
+/* 1D squared distance transform of a sampled function, see "Distance
+ * Transforms of Sampled Functions", P. Felzenszwalb and D. Huttenlocher. */
+static void grid_dt_1d(const float* f, int n, float* d, int* v, float* z)
+{
+    int k = 0;
+    int q;
+    float s;
+
+    v[0] = 0;
+    z[0] = -GRID_INF;
+    z[1] = GRID_INF;
+
+    for (q = 1; q < n; q++) {
+        s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+        while (s <= z[k]) {
+            k--;
+            s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+        }
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = GRID_INF;
+    }
+
+    k = 0;
+    for (q = 0; q < n; q++) {
+        while (z[k + 1] < q) {
+            k++;
+        }
+        d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+    }
+}
+
+/* Recomputes the distance of the cells in the given rectangle.
+ *
+ * Distances are capped at max_distance, so every obstacle which can change
+ * the result is at most max_distance cells away from the rectangle. Running
+ * the transform on the rectangle grown by that much is therefore exact. */
+static void grid_update_distances_in(struct grid_planner* gp, struct grid_planner_rect inner)
+{
+    const int m = gp->max_distance;
+    struct grid_planner_rect outer;
+    int x, y;
+
+    outer.x1 = grid_clamp(inner.x1 - m, 0, gp->size_x - 1);
+    outer.x2 = grid_clamp(inner.x2 + m, 0, gp->size_x - 1);
+    outer.y1 = grid_clamp(inner.y1 - m, 0, gp->size_y - 1);
+    outer.y2 = grid_clamp(inner.y2 + m, 0, gp->size_y - 1);
+
+    /* First pass along the columns of the outer rectangle */
+    for (x = outer.x1; x <= outer.x2; x++) {
+        int n = outer.y2 - outer.y1 + 1;
+        for (y = 0; y < n; y++) {
+            gp->dt_f[y] = grid_is_occupied(gp, grid_idx(gp, x, outer.y1 + y)) ? 0.f : GRID_INF;
+        }
+
+        grid_dt_1d(gp->dt_f, n, gp->dt_d, gp->dt_v, gp->dt_z);
+
+        for (y = inner.y1; y <= inner.y2; y++) {
+            gp->scratch[grid_idx(gp, x, y)] = gp->dt_d[y - outer.y1];
+        }
+    }
+
+    /* Second pass along the rows of the inner rectangle only */
+    for (y = inner.y1; y <= inner.y2; y++) {
+        int n = outer.x2 - outer.x1 + 1;
+        for (x = 0; x < n; x++) {
+            gp->dt_f[x] = gp->scratch[grid_idx(gp, outer.x1 + x, y)];
+        }
+
+        grid_dt_1d(gp->dt_f, n, gp->dt_d, gp->dt_v, gp->dt_z);
+
+        for (x = inner.x1; x <= inner.x2; x++) {
+            gp->distance[grid_idx(gp, x, y)] = fminf(sqrtf(gp->dt_d[x - outer.x1]), m);
+        }
+    }
+}
+
+int grid_planner_init(struct grid_planner* gp, const struct grid_planner_params* params, bbox_t playground)
+{
+    int cells, longest_side;
+
+    memset(gp, 0, sizeof(struct grid_planner));
+    gp->params = *params;
+    gp->playground = playground;
+    gp->size_x = ceilf((playground.x2 - playground.x1) / params->resolution_mm);
+    gp->size_y = ceilf((playground.y2 - playground.y1) / params->resolution_mm);
+    gp->max_distance = ceilf(fmaxf(params->clearance_mm, params->safety_margin_mm) / params->resolution_mm) + 1;
+
+    if (gp->size_x <= 0 || gp->size_y <= 0) {
+        return -1;
+    }
+
+    cells = gp->size_x * gp->size_y;
+    longest_side = gp->size_x > gp->size_y ? gp->size_x : gp->size_y;
+
+    gp->static_occupancy = calloc(cells, sizeof(uint8_t));
+    gp->dynamic_occupancy = calloc(cells, sizeof(uint8_t));
+    gp->distance = calloc(cells, sizeof(float));
+    gp->dynamic_rects = calloc(params->max_dynamic_obstacles, sizeof(struct grid_planner_rect));
+    gp->dynamic_points = calloc(params->max_dynamic_obstacles * GRID_PLANNER_MAX_POLY_PTS, sizeof(point_t));
+    gp->dynamic_len = calloc(params->max_dynamic_obstacles, sizeof(int));
+    gp->scratch = calloc(cells, sizeof(float));
+    gp->dt_f = calloc(longest_side, sizeof(float));
+    gp->dt_d = calloc(longest_side, sizeof(float));
+    gp->dt_z = calloc(longest_side + 1, sizeof(float));
+    gp->dt_v = calloc(longest_side, sizeof(int));
+    gp->g = calloc(cells, sizeof(float));
+    gp->parent = calloc(cells, sizeof(int32_t));
+    gp->heap = calloc(cells, sizeof(int32_t));
+    gp->heap_pos = calloc(cells, sizeof(int32_t));
+    gp->res = calloc(params->max_checkpoints, sizeof(point_t));
+
+    if (!gp->static_occupancy || !gp->dynamic_occupancy || !gp->distance
+        || !gp->dynamic_rects || !gp->dynamic_points || !gp->dynamic_len
+        || !gp->scratch || !gp->dt_f || !gp->dt_d || !gp->dt_z || !gp->dt_v
+        || !gp->g || !gp->parent || !gp->heap || !gp->heap_pos || !gp->res) {
+        grid_planner_deinit(gp);
+        return -1;
+    }
+
+    for (int i = 0; i < params->max_dynamic_obstacles; i++) {
+        gp->dynamic_rects[i].x2 = -1;
+        gp->dynamic_rects[i].y2 = -1;
+    }
+
+    grid_planner_update_distances(gp);
+
+    return 0;
+}
+
+void grid_planner_deinit(struct grid_planner* gp)
+{
+    free(gp->static_occupancy);
+    free(gp->dynamic_occupancy);
+    free(gp->distance);
+    free(gp->dynamic_rects);
+    free(gp->dynamic_points);
+    free(gp->dynamic_len);
+    free(gp->scratch);
+    free(gp->dt_f);
+    free(gp->dt_d);
+    free(gp->dt_z);
+    free(gp->dt_v);
+    free(gp->g);
+    free(gp->parent);
+    free(gp->heap);
+    free(gp->heap_pos);
+    free(gp->res);
+    memset(gp, 0, sizeof(struct grid_planner));
+}
+
+int grid_planner_copy(struct grid_planner* dst, const struct grid_planner* src)
+{
+    const int cells = src->size_x * src->size_y;
+    const int obstacles = src->params.max_dynamic_obstacles;
+
+    if (dst->size_x != src->size_x || dst->size_y != src->size_y
+        || dst->max_distance != src->max_distance
+        || dst->params.max_dynamic_obstacles != obstacles) {
+        return -1;
+    }
+
+    memcpy(dst->static_occupancy, src->static_occupancy, cells * sizeof(uint8_t));
+    memcpy(dst->dynamic_occupancy, src->dynamic_occupancy, cells * sizeof(uint8_t));
+    memcpy(dst->distance, src->distance, cells * sizeof(float));
+    memcpy(dst->dynamic_rects, src->dynamic_rects, obstacles * sizeof(struct grid_planner_rect));
+    memcpy(dst->dynamic_points, src->dynamic_points, obstacles * GRID_PLANNER_MAX_POLY_PTS * sizeof(point_t));
+    memcpy(dst->dynamic_len, src->dynamic_len, obstacles * sizeof(int));
+    dst->res_len = 0;
+
+    return 0;
+}
+
+void grid_planner_add_static_poly(struct grid_planner* gp, const poly_t* poly)
+{
+    grid_rasterize(gp, gp->static_occupancy, poly, 1);
+}
+
+void grid_planner_update_distances(struct grid_planner* gp)
+{
+    struct grid_planner_rect all = {0, 0, gp->size_x - 1, gp->size_y - 1};
+    grid_update_distances_in(gp, all);
+}
+
+int grid_planner_set_dynamic_poly(struct grid_planner* gp, int index, const poly_t* poly)
+{
+    struct grid_planner_rect* rect;
+    struct grid_planner_rect old, dirty;
+    point_t* points;
+    poly_t old_poly;
+
+    if (index < 0 || index >= gp->params.max_dynamic_obstacles) {
+        return -1;
+    }
+    if (poly && poly->l > GRID_PLANNER_MAX_POLY_PTS) {
+        return -1;
+    }
+
+    rect = &gp->dynamic_rects[index];
+    points = &gp->dynamic_points[index * GRID_PLANNER_MAX_POLY_PTS];
+
+    /* Remove the obstacle from its previous position */
+    old = *rect;
+    old_poly.pts = points;
+    old_poly.l = gp->dynamic_len[index];
+    grid_rasterize(gp, gp->dynamic_occupancy, &old_poly, -1);
+
+    gp->dynamic_len[index] = 0;
+    rect->x1 = rect->y1 = 0;
+    rect->x2 = rect->y2 = -1;
+
+    if (poly) {
+        memcpy(points, poly->pts, poly->l * sizeof(point_t));
+        gp->dynamic_len[index] = poly->l;
+        *rect = grid_rasterize(gp, gp->dynamic_occupancy, poly, 1);
+    }
+
+    /* Only the cells around the old and new position can change */
+    if (grid_rect_is_empty(&old)) {
+        dirty = *rect;
+    } else if (grid_rect_is_empty(rect)) {
+        dirty = old;
+    } else {
+        dirty.x1 = old.x1 < rect->x1 ? old.x1 : rect->x1;
+        dirty.y1 = old.y1 < rect->y1 ? old.y1 : rect->y1;
+        dirty.x2 = old.x2 > rect->x2 ? old.x2 : rect->x2;
+        dirty.y2 = old.y2 > rect->y2 ? old.y2 : rect->y2;
+    }
+
+    if (!grid_rect_is_empty(&dirty)) {
+        dirty.x1 = grid_clamp(dirty.x1 - gp->max_distance, 0, gp->size_x - 1);
+        dirty.x2 = grid_clamp(dirty.x2 + gp->max_distance, 0, gp->size_x - 1);
+        dirty.y1 = grid_clamp(dirty.y1 - gp->max_distance, 0, gp->size_y - 1);
+        dirty.y2 = grid_clamp(dirty.y2 + gp->max_distance, 0, gp->size_y - 1);
+        grid_update_distances_in(gp, dirty);
+    }
+
+    return 0;
+}
+
+float grid_planner_clearance(const struct grid_planner* gp, point_t p)
+{
+    int x = grid_cell_x(gp, p.x);
+    int y = grid_cell_y(gp, p.y);
+
+    if (x < 0 || x >= gp->size_x || y < 0 || y >= gp->size_y) {
+        return 0.f;
+    }
+
+    return gp->distance[grid_idx(gp, x, y)] * gp->params.resolution_mm;
+}
+
+/* Binary min-heap of cells, keyed by scratch (the A* f score) */
+static void grid_heap_swap(struct grid_planner* gp, int a, int b)
+{
+    int32_t tmp = gp->heap[a];
+    gp->heap[a] = gp->heap[b];
+    gp->heap[b] = tmp;
+    gp->heap_pos[gp->heap[a]] = a;
+    gp->heap_pos[gp->heap[b]] = b;
+}
+
+static void grid_heap_up(struct grid_planner* gp, int i)
+{
+    while (i > 0 && gp->scratch[gp->heap[(i - 1) / 2]] > gp->scratch[gp->heap[i]]) {
+        grid_heap_swap(gp, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static void grid_heap_down(struct grid_planner* gp, int i)
+{
+    while (1) {
+        int smallest = i;
+        int l = 2 * i + 1;
+        int r = 2 * i + 2;
+
+        if (l < gp->heap_len && gp->scratch[gp->heap[l]] < gp->scratch[gp->heap[smallest]]) {
+            smallest = l;
+        }
+        if (r < gp->heap_len && gp->scratch[gp->heap[r]] < gp->scratch[gp->heap[smallest]]) {
+            smallest = r;
+        }
+        if (smallest == i) {
+            return;
+        }
+        grid_heap_swap(gp, i, smallest);
+        i = smallest;
+    }
+}
+
+static void grid_heap_push_or_decrease(struct grid_planner* gp, int32_t cell, float f)
+{
+    gp->scratch[cell] = f;
+    if (gp->heap_pos[cell] < 0) {
+        gp->heap[gp->heap_len] = cell;
+        gp->heap_pos[cell] = gp->heap_len;
+        gp->heap_len++;
+    }
+    grid_heap_up(gp, gp->heap_pos[cell]);
+}
+
+static int32_t grid_heap_pop(struct grid_planner* gp)
+{
+    int32_t cell = gp->heap[0];
+
+    gp->heap_len--;
+    if (gp->heap_len > 0) {
+        grid_heap_swap(gp, 0, gp->heap_len);
+        grid_heap_down(gp, 0);
+    }
+    gp->heap_pos[cell] = GRID_CLOSED;
+
+    return cell;
+}
+
+struct grid_search {
+    float margin; /* in cells */
+    int goal_x, goal_y;
+};
+
+static int grid_is_blocked(const struct grid_planner* gp, const struct grid_search* search, int idx)
+{
+    return grid_is_occupied(gp, idx) || gp->distance[idx] < search->margin;
+}
+
+/* Cost factor of crossing the given cell, 1 when far from obstacles */
+static float grid_cell_cost(const struct grid_planner* gp, int idx)
+{
+    float clearance = gp->params.clearance_mm / gp->params.resolution_mm;
+
+    if (clearance <= 0.f || gp->distance[idx] >= clearance) {
+        return 1.f;
+    }
+
+    return 1.f + gp->params.clearance_weight * (clearance - gp->distance[idx]) / clearance;
+}
+
+static float grid_heuristic(const struct grid_search* search, int x, int y)
+{
+    return hypotf(x - search->goal_x, y - search->goal_y);
+}
+
+/* Cost of the straight line between two cells, or a negative value if it
+ * crosses a blocked cell. */
+static float grid_line_cost(const struct grid_planner* gp, const struct grid_search* search,
+                            int x0, int y0, int x1, int y1)
+{
+    int dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+    int steps = 0;
+    float cost = 0.f;
+
+    /* Bresenham, skipping the first cell */
+    while (x0 != x1 || y0 != y1) {
+        int e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0 += sy;
+        }
+
+        int idx = grid_idx(gp, x0, y0);
+        if (grid_is_blocked(gp, search, idx)) {
+            return -1.f;
+        }
+        cost += grid_cell_cost(gp, idx);
+        steps++;
+    }
+
+    if (steps == 0) {
+        return 0.f;
+    }
+
+    return cost * hypotf(dx, dy) / steps;
+}
+
+/* Any-angle Theta* search. Each reached cell either comes from its neighbour,
+ * or directly from the parent of that neighbour if the straight line is
+ * cheaper. */
+static int grid_search(struct grid_planner* gp, const struct grid_search* search, int start, int goal)
+{
+    static const int dxs[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+    static const int dys[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+    const int cells = gp->size_x * gp->size_y;
+    int i;
+
+    for (i = 0; i < cells; i++) {
+        gp->g[i] = GRID_INF;
+        gp->parent[i] = -1;
+        gp->heap_pos[i] = -1;
+    }
+    gp->heap_len = 0;
+
+    gp->g[start] = 0.f;
+    gp->parent[start] = start;
+    grid_heap_push_or_decrease(gp, start, grid_heuristic(search, start % gp->size_x, start / gp->size_x));
+
+    while (gp->heap_len > 0) {
+        int32_t s = grid_heap_pop(gp);
+        int sx = s % gp->size_x, sy = s / gp->size_x;
+        int32_t p = gp->parent[s];
+        int px = p % gp->size_x, py = p / gp->size_x;
+
+        if (s == goal) {
+            return 0;
+        }
+
+        for (i = 0; i < 8; i++) {
+            int nx = sx + dxs[i], ny = sy + dys[i];
+            int32_t n;
+            float cost, line;
+            int32_t parent;
+
+            if (nx < 0 || nx >= gp->size_x || ny < 0 || ny >= gp->size_y) {
+                continue;
+            }
+
+            n = grid_idx(gp, nx, ny);
+            if (gp->heap_pos[n] == GRID_CLOSED || grid_is_blocked(gp, search, n)) {
+                continue;
+            }
+
+            cost = gp->g[s] + hypotf(dxs[i], dys[i]) * grid_cell_cost(gp, n);
+            parent = s;
+
+            if (p != s) {
+                line = grid_line_cost(gp, search, px, py, nx, ny);
+                if (line >= 0.f && gp->g[p] + line <= cost) {
+                    cost = gp->g[p] + line;
+                    parent = p;
+                }
+            }
+
+            if (cost < gp->g[n]) {
+                gp->g[n] = cost;
+                gp->parent[n] = parent;
+                grid_heap_push_or_decrease(gp, n, cost + grid_heuristic(search, nx, ny));
+            }
+        }
+    }
+
+    return -1;
+}
+
+int grid_planner_process(struct grid_planner* gp, point_t start, point_t end)
+{
+    struct grid_search search;
+    int sx = grid_cell_x(gp, start.x), sy = grid_cell_y(gp, start.y);
+    int ex = grid_cell_x(gp, end.x), ey = grid_cell_y(gp, end.y);
+    int start_idx, goal_idx, cell, len, i;
+
+    gp->res_len = -2;
+
+    if (sx < 0 || sx >= gp->size_x || sy < 0 || sy >= gp->size_y
+        || ex < 0 || ex >= gp->size_x || ey < 0 || ey >= gp->size_y) {
+        return gp->res_len;
+    }
+
+    start_idx = grid_idx(gp, sx, sy);
+    goal_idx = grid_idx(gp, ex, ey);
+
+    if (grid_is_occupied(gp, goal_idx)) {
+        return gp->res_len;
+    }
+
+    /* If we start or end inside the safety margin, shrink it so that we can
+     * still get out or in. */
+    search.margin = gp->params.safety_margin_mm / gp->params.resolution_mm;
+    search.margin = fminf(search.margin, gp->distance[start_idx]);
+    search.margin = fminf(search.margin, gp->distance[goal_idx]);
+    search.goal_x = ex;
+    search.goal_y = ey;
+
+    if (grid_search(gp, &search, start_idx, goal_idx) < 0) {
+        return gp->res_len;
+    }
+
+    /* Count the waypoints, excluding the start */
+    len = 0;
+    for (cell = goal_idx; cell != start_idx; cell = gp->parent[cell]) {
+        len++;
+    }
+
+    if (len > gp->params.max_checkpoints) {
+        gp->res_len = -1;
+        return gp->res_len;
+    }
+
+    /* Backtrack the solution path, replacing the cell centers of the ends by
+     * the exact points */
+    i = len - 1;
+    for (cell = goal_idx; cell != start_idx; cell = gp->parent[cell]) {
+        gp->res[i].x = gp->playground.x1 + (cell % gp->size_x + 0.5f) * gp->params.resolution_mm;
+        gp->res[i].y = gp->playground.y1 + (cell / gp->size_x + 0.5f) * gp->params.resolution_mm;
+        i--;
+    }
+
+    if (len == 0) {
+        len = 1;
+    }
+    gp->res[len - 1] = end;
+
+    gp->res_len = len;
+    return gp->res_len;
+}
+
+int grid_planner_get_path(struct grid_planner* gp, point_t** path)
+{
+    *path = gp->res;
+    return gp->res_len;
+}
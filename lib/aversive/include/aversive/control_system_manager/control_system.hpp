@@ -0,0 +1,104 @@
+/** \file control_system.hpp
+ * \brief Control system whose filters are chosen at compile time.
+ *
+ * cs_do_process() calls each stage through a function pointer, checked for
+ * NULL, with a void* parameter. Here each stage is a type instead, so the
+ * compiler sees the whole chain and can inline it (across translation units
+ * with link time optimization).
+ *
+ * The processing state is kept in a regular struct cs, so the C accessors
+ * (cs_set_consign(), cs_get_error()...) and the modules using them, such as
+ * the trajectory manager, work unchanged.
+ */
+
+#ifndef CONTROL_SYSTEM_HPP
+#define CONTROL_SYSTEM_HPP
+
+#include <stdint.h>
+#include <aversive/control_system_manager/control_system_manager.h>
+
+namespace control_system {
+
+/** Stage which is not used, as a NULL filter in the C API */
+struct Identity {
+    int32_t operator()(int32_t value) const
+    {
+        return value;
+    }
+};
+
+/** Filter implemented by a C callback, eg quadramp_do_filter() */
+template <int32_t (*F)(void*, int32_t)>
+struct Filter {
+    void* params;
+
+    int32_t operator()(int32_t value) const
+    {
+        return F(params, value);
+    }
+};
+
+/** Reads the process output with a C callback, eg rs_get_ext_angle() */
+template <int32_t (*F)(void*)>
+struct ProcessOut {
+    void* params;
+
+    int32_t operator()() const
+    {
+        return F(params);
+    }
+};
+
+/** Sets the process input with a C callback, eg rs_set_angle() */
+template <void (*F)(void*, int32_t)>
+struct ProcessIn {
+    void* params;
+
+    void operator()(int32_t value) const
+    {
+        F(params, value);
+    }
+};
+
+/** Control pipeline with the same stages and semantics as cs_do_process() */
+template <typename ConsignFilter,
+          typename FeedbackFilter,
+          typename CorrectFilter,
+          typename OutputFilter,
+          typename ProcessOutput,
+          typename ProcessInput>
+struct Pipeline {
+    ConsignFilter consign_filter;
+    FeedbackFilter feedback_filter;
+    CorrectFilter correct_filter;
+    OutputFilter output_filter;
+    ProcessOutput process_out;
+    ProcessInput process_in;
+
+    /** Same as cs_do_process(), the state is read from and saved in cs */
+    int32_t do_process(struct cs* cs, int32_t consign) const
+    {
+        if (cs->enabled) {
+            cs->consign_value = consign;
+            cs->filtered_consign_value = consign_filter(consign);
+            cs->filtered_feedback_value = feedback_filter(process_out());
+            cs->error_value = cs->filtered_consign_value - cs->filtered_feedback_value;
+            cs->out_value = output_filter(correct_filter(cs->error_value));
+        } else {
+            cs->out_value = 0; /* disables the cs */
+        }
+
+        process_in(cs->out_value);
+        return cs->out_value;
+    }
+
+    /** Same as cs_manage() */
+    void manage(struct cs* cs) const
+    {
+        do_process(cs, cs->consign_value);
+    }
+};
+
+} // namespace control_system
+
+#endif /* CONTROL_SYSTEM_HPP */
@@ -0,0 +1,139 @@
+/* @file grid_planner.h
+ *
+ * @brief Grid based path planner, alternative to obstacle_avoidance.
+ *
+ * The playground is rasterized into an occupancy grid. Each cell stores its
+ * distance to the closest obstacle (a Euclidean distance transform), which is
+ * updated incrementally when a dynamic obstacle (ally, opponent) moves: only
+ * the cells around the old and new position of the obstacle are recomputed.
+ *
+ * Paths are searched with Theta*, an any-angle variant of A*, where the cost
+ * of crossing a cell grows when getting closer to an obstacle. Cells closer
+ * than a safety margin to an obstacle are never crossed. Unlike the
+ * visibility graph of obstacle_avoidance, the query cost only depends on the
+ * grid size, not on the number of polygons, and paths keep some clearance
+ * instead of grazing the obstacle corners.
+ *
+ * Obstacles are the same (already inflated) polygons as the ones given to
+ * obstacle_avoidance.
+ */
+
+#ifndef GRID_PLANNER_H
+#define GRID_PLANNER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include <aversive/math/geometry/polygon.h>
+#include <aversive/math/geometry/vect_base.h>
+
+/** Tuning of the planner. */
+struct grid_planner_params {
+    float resolution_mm; /**< Size of a cell. */
+    float safety_margin_mm; /**< Cells closer than this to an obstacle are forbidden. */
+    float clearance_mm; /**< Cells closer than this to an obstacle are more expensive to cross. */
+    float clearance_weight; /**< Extra cost factor of a cell touching an obstacle, 0 disables it. */
+    int max_dynamic_obstacles; /**< Number of obstacles which can be moved after init. */
+    int max_checkpoints; /**< Maximal length of the path. */
+};
+
+/** Bounding box of a dynamic obstacle, in cells, empty if x1 > x2. */
+struct grid_planner_rect {
+    int x1, y1, x2, y2;
+};
+
+/** Instance of the grid planner */
+struct grid_planner {
+    struct grid_planner_params params;
+    bbox_t playground; /**< Area covered by the grid, in mm. */
+    int size_x, size_y; /**< Grid size, in cells. */
+    int max_distance; /**< Cap of the distance transform, in cells. */
+
+    uint8_t* static_occupancy; /**< Non zero if the cell is in a static obstacle. */
+    uint8_t* dynamic_occupancy; /**< Number of dynamic obstacles covering the cell. */
+    float* distance; /**< Distance to the closest obstacle, in cells, capped at max_distance. */
+
+    struct grid_planner_rect* dynamic_rects; /**< Current cells of each dynamic obstacle. */
+    point_t* dynamic_points; /**< Copy of the dynamic obstacle polygons, GRID_PLANNER_MAX_POLY_PTS per obstacle. */
+    int* dynamic_len; /**< Number of points of each dynamic obstacle. */
+
+    /* Scratch memory for the distance transform and the search */
+    float* scratch;
+    float* dt_f;
+    float* dt_d;
+    float* dt_z;
+    int* dt_v;
+    float* g;
+    int32_t* parent;
+    int32_t* heap;
+    int32_t* heap_pos;
+    int heap_len;
+
+    point_t* res; /**< Resulting path. */
+    int res_len; /**< Path length */
+};
+
+/** Maximal number of points of a dynamic obstacle */
+#define GRID_PLANNER_MAX_POLY_PTS 16
+
+/** Creates a planner covering the given playground (in mm).
+ * @returns 0 on success, -1 if the memory could not be allocated.
+ * @note The memory must be released with grid_planner_deinit().
+ */
+int grid_planner_init(struct grid_planner* gp, const struct grid_planner_params* params, bbox_t playground);
+
+/** Releases the memory used by the planner. */
+void grid_planner_deinit(struct grid_planner* gp);
+
+/** Copies the obstacles and distances of src into dst.
+ *
+ * dst must have been created with the same parameters and playground, its
+ * search buffers are left untouched. This allows one thread to update a grid
+ * while others plan on copies of it.
+ * @returns 0 on success, -1 if dst has a different size.
+ */
+int grid_planner_copy(struct grid_planner* dst, const struct grid_planner* src);
+
+/** Rasterizes a static obstacle into the grid.
+ *
+ * Static obstacles cannot be removed. Call grid_planner_update_distances()
+ * once all of them were added.
+ */
+void grid_planner_add_static_poly(struct grid_planner* gp, const poly_t* poly);
+
+/** Recomputes the whole distance transform. */
+void grid_planner_update_distances(struct grid_planner* gp);
+
+/** Moves the given dynamic obstacle, updating the distance transform around
+ * its old and new position only.
+ *
+ * @param [in] index Index of the obstacle, below max_dynamic_obstacles.
+ * @param [in] poly New shape of the obstacle, or NULL to remove it.
+ * @returns 0 on success, -1 if the index or polygon is invalid.
+ */
+int grid_planner_set_dynamic_poly(struct grid_planner* gp, int index, const poly_t* poly);
+
+/** Distance from the given point to the closest obstacle, in mm, capped at
+ * the clearance or safety margin, whichever is bigger. Returns 0 outside of
+ * the playground. */
+float grid_planner_clearance(const struct grid_planner* gp, point_t p);
+
+/** Computes a path from start to end.
+ *
+ * @returns The number of points in the path on success, the last point being
+ * end and the start point being excluded.
+ * @returns -1 if the path is longer than max_checkpoints.
+ * @returns -2 if there is no path.
+ */
+int grid_planner_process(struct grid_planner* gp, point_t start, point_t end);
+
+/** Gets the path computed by grid_planner_process(). */
+int grid_planner_get_path(struct grid_planner* gp, point_t** path);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* GRID_PLANNER_H */
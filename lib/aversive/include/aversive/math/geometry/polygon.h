@@ -42,6 +42,14 @@ typedef struct _poly {
     int l; /**< Length of the array of points */
 } poly_t;
 
+/** @brief An axis aligned bounding box. */
+typedef struct _bbox {
+    int32_t x1; /**< x-coordinate bottom-left corner */
+    int32_t y1; /**< y-coordinate bottom-left corner */
+    int32_t x2; /**< x-coordinate top-right corner */
+    int32_t y2; /**< y-coordinate top-right corner */
+} bbox_t;
+
 /** Checks if a point belongs to a polygon
  * @param [in] *p Point to check
  * @param [in] *pol Polygon to check
@@ -68,7 +76,10 @@ int is_point_in_poly(poly_t* pol, int16_t x, int16_t y);
  *  and the second segment boundary is out of the polygon) */
 int is_crossing_poly(point_t p1, point_t p2, point_t* intersect_pt, poly_t* pol);
 
-/** Set coordinates of bounding box.
+/** Set coordinates of the global bounding box.
+ * @warning The global bounding box is shared by all the callers of
+ * is_in_boundingbox() and calc_rays(). Use the bbox_t variants when several
+ * threads need different bounding boxes.
  * @param [in] x1 x-coordinate bottom-left corner
  * @param [in] y1 y-coordiante bottom-left corner
  * @param [in] x2 x-coordinate top-right corner
@@ -81,6 +92,12 @@ void polygon_set_boundingbox(int32_t x1, int32_t y1, int32_t x2, int32_t y2);
  * @return 1 if p is in the bounding box. */
 int is_in_boundingbox(const point_t* p);
 
+/** Checks if a point is in the given bounding box.
+ * @param [in] *bbox Bounding box
+ * @param [in] *p Point to check
+ * @return 1 if p is in the bounding box. */
+int is_in_bbox(const bbox_t* bbox, const point_t* p);
+
 /** @brief Constructs the visibility ray graph.
  *
  *  Giving the list of poygons, compute the graph of "visibility rays".
@@ -100,11 +117,17 @@ int is_in_boundingbox(const point_t* p);
  *
  * @param [in] *polys List of polygons
  * @param [in] npolys Number of polygons in the list
- * @param [out] *rays Rays (WTFBBQ?)
- * @return Number of rays
+ * @param [out] *rays Rays (WTFBBQ?), must hold 2 * max_rays indices
+ * @param [in] max_rays Size of rays, in ray ends (2 indices each, 2 per ray)
+ * @return Number of indices written to rays (4 per ray)
+ * @return -1 if there are more than max_rays / 2 rays
  */
 
-int calc_rays(poly_t* polys, int npolys, int* rays);
+int calc_rays(poly_t* polys, int npolys, int* rays, int max_rays);
+
+/** Same as calc_rays(), but only considers vertices inside the given bounding
+ * box instead of the global one. */
+int calc_rays_in_bbox(const bbox_t* bbox, poly_t* polys, int npolys, int* rays, int max_rays);
 
 /** Compute the weight of every rays: the length of the rays is used
  * here.
@@ -41,14 +41,23 @@
  *
  * The algorithm executes Dijkstra to find the shortest path to go
  * from A to B.
+ *
+ * All the state of the algorithm lives in the struct obstacle_avoidance
+ * passed to every oa_* function, so different instances can be used from
+ * different threads at the same time. A single instance must still be
+ * protected by its user if it is shared between threads.
  */
 
 /*
- * As we run on 4Ko ram uC, we have static structures arrays to store:
- *  - MAX_POLY => represent the maximum polygons to avoid in the area.
- *  - MAX_PTS => maximize the sum of every polygons vertices.
- *  - MAX_RAYS => maximum number of rays.
- *  - MAX_CHKPOINTS => maximum accepted checkpoints in the resulting path.
+ * The storage used by the algorithm is sized at runtime, using a struct
+ * oa_limits, and allocated once when the instance is initialized:
+ *  - max_polys => represent the maximum polygons to avoid in the area.
+ *  - max_pts => maximize the sum of every polygons vertices.
+ *  - max_rays => size of the ray storage, in ray ends: as with the former
+ *    MAX_RAYS sized arrays, at most max_rays / 2 rays fit.
+ *  - max_checkpoints => maximum accepted checkpoints in the resulting path.
+ *
+ * The MAX_* constants below are the default limits, used by oa_init().
  */
 
 #ifndef _OBSTACLE_AVOIDANCE_H_
@@ -58,15 +67,28 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
+
 #include <aversive/math/geometry/polygon.h>
 #include <aversive/math/geometry/vect_base.h>
 #include <aversive/math/geometry/lines.h>
 #include <aversive/math/geometry/circles.h>
 
-#define MAX_POLY 20 /**< The maximal number of obstacles in the area. */
-#define MAX_PTS 200 /**< The maximal number of polygon vertices. */
-#define MAX_RAYS 1000 /**< The maximal number of rays. */
-#define MAX_CHKPOINTS 100 /**< Maximal length of the path. */
+#define MAX_POLY 20 /**< Default maximal number of obstacles in the area. */
+#define MAX_PTS 200 /**< Default maximal number of polygon vertices. */
+#define MAX_RAYS 1000 /**< Default ray storage size, in ray ends. */
+#define MAX_CHKPOINTS 100 /**< Default maximal length of the path. */
+
+/** Size limits of an obstacle avoidance instance. */
+struct oa_limits {
+    int max_polys; /**< Maximal number of polygons, including the start/end one. */
+    int max_pts; /**< Maximal number of polygon vertices. */
+    int max_rays; /**< Ray storage size, in ray ends (2 per ray). */
+    int max_checkpoints; /**< Maximal length of the path. */
+};
+
+/** Limits used by oa_init() */
+#define OA_DEFAULT_LIMITS {MAX_POLY, MAX_PTS, MAX_RAYS, MAX_CHKPOINTS}
 
 /** @struct obstacle_avoidance
  * @brief Instance of the obstacle avoidance system.
@@ -74,6 +96,10 @@ extern "C" {
  * This structure holds everything needed by the obstacle avoidance module,
  * like obstacles position, etc...
  *
+ * All the arrays point into a single arena, sized from the limits given at
+ * init time. Several instances can therefore coexist, each with its own
+ * limits.
+ *
  * To save memory space here is the memory representation of
  *   polygons/points:
  *\verbatim
@@ -95,28 +121,76 @@ extern "C" {
  * (in the oa_poly_t structure)
  */
 struct obstacle_avoidance {
-    poly_t polys[MAX_POLY]; /**< Array of polygons (obstacles). */
-    point_t points[MAX_PTS]; /**< Array of points, referenced by polys */
-    int valid[MAX_PTS]; /**< Used by the Dijkstra algorithm to say if a point was visited. */
-    int32_t pweight[MAX_PTS]; /**< Weight of a point in Dijkstra. */
-    int p[MAX_PTS]; /**< @todo Dafuq ? */
-    int pt[MAX_PTS]; /**< Stores all the points. */
+    struct oa_limits limits; /**< Capacity of the arrays below. */
+
+    poly_t* polys; /**< Array of polygons (obstacles), max_polys long. */
+    point_t* points; /**< Array of points, referenced by polys, max_pts long */
+    int* valid; /**< Used by the Dijkstra algorithm to say if a point was visited. */
+    int32_t* pweight; /**< Weight of a point in Dijkstra. */
+    int* p; /**< Polygon index of the parent of each point in the shortest path. */
+    int* pt; /**< Vertex index of the parent of each point in the shortest path. */
 
     int ray_n; /**< Number of computed rays. */
     int cur_poly_idx; /**< Index of the current polygon (for adding polygons). */
     int cur_pt_idx; /**< Index of the current point in the current polygon. */
 
-    int weight[MAX_RAYS]; /**< Length of each ray. */
-    int rays[MAX_RAYS * 2]; /**< All valid rays given by Dijkstra. */
-    point_t res[MAX_CHKPOINTS]; /**< Resulting path. */
+    int* weight; /**< Length of each ray, max_rays long. */
+    int* rays; /**< All valid rays given by Dijkstra, 4 indices per ray, 2 * max_rays long. */
+    point_t* res; /**< Resulting path, max_checkpoints long. */
     int res_len; /** Path length */
+
+    bbox_t bbox; /**< Playground of this instance, see oa_set_boundingbox(). */
+    int has_bbox; /**< If false, the global bounding box of polygon.h is used. */
+
+    void* arena; /**< Storage backing all the arrays above. */
+    int arena_is_owned; /**< True if the arena was allocated by oa_init_with_limits(). */
 };
 
-/** Init the obstacle avoidance structure. */
-void oa_init(struct obstacle_avoidance* oa);
+/** Returns the size in bytes of the arena needed for the given limits. */
+size_t oa_arena_size(const struct oa_limits* limits);
+
+/** Init the obstacle avoidance structure on a caller provided arena.
+ *
+ * @param [in] limits Size of the problems this instance can solve.
+ * @param [in] arena Storage of at least oa_arena_size(limits) bytes, suitably
+ * aligned for any type. It must outlive the obstacle avoidance instance.
+ */
+void oa_init_arena(struct obstacle_avoidance* oa, const struct oa_limits* limits, void* arena);
+
+/** Init the obstacle avoidance structure, allocating its arena on the heap.
+ *
+ * @returns 0 on success, -1 if the arena could not be allocated.
+ * @note The arena must be released with oa_deinit().
+ */
+int oa_init_with_limits(struct obstacle_avoidance* oa, const struct oa_limits* limits);
+
+/** Init the obstacle avoidance structure, with the default limits.
+ *
+ * @returns 0 on success, -1 if the arena could not be allocated.
+ * @note The arena must be released with oa_deinit().
+ */
+int oa_init(struct obstacle_avoidance* oa);
+
+/** Releases the arena allocated by oa_init() or oa_init_with_limits(). */
+void oa_deinit(struct obstacle_avoidance* oa);
 
-/** Copies the obstacle avoidance state */
-void oa_copy(struct obstacle_avoidance* dst, const struct obstacle_avoidance* oa);
+/** Copies the obstacle avoidance state.
+ *
+ * dst must already be initialized, with limits large enough to hold the
+ * polygons and points of oa.
+ * @returns 0 on success, -1 if dst is too small.
+ */
+int oa_copy(struct obstacle_avoidance* dst, const struct obstacle_avoidance* oa);
+
+/** Set the playground of this instance.
+ *
+ * Only the polygon vertices inside it are used for paths. If this is never
+ * called, the global bounding box set by polygon_set_boundingbox() is used,
+ * which is shared with the other instances.
+ * @param [in] x1,y1 Bottom-left corner, in mm.
+ * @param [in] x2,y2 Top-right corner, in mm.
+ */
+void oa_set_boundingbox(struct obstacle_avoidance* oa, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
 
 /** Set the start and destination point. */
 void oa_start_end_points(struct obstacle_avoidance* oa, int32_t st_x, int32_t st_y, int32_t en_x, int32_t en_y);
@@ -143,9 +217,28 @@ void oa_poly_set_point(struct obstacle_avoidance* oa, poly_t* pol, int32_t x, in
 
 /** Processes the path.
  * @returns The number of points in the path on sucess
- * @returns An error code < 0 in case of failure.
+ * @returns An error code < 0 in case of failure:
+ *  -1 if the path is longer than max_checkpoints,
+ *  -2 if there is no path,
+ *  -3 if the visibility graph has more than max_rays / 2 rays.
+ */
+int oa_process(struct obstacle_avoidance* oa);
+
+/** First stage of oa_process(): computes the visibility graph and its
+ * weights.
+ * @returns The number of ray indices (4 per ray) on success
+ * @returns -3 if the visibility graph has more than max_rays / 2 rays.
+ */
+int oa_process_rays(struct obstacle_avoidance* oa);
+
+/** Second stage of oa_process(): runs Dijkstra on the visibility graph
+ * computed by oa_process_rays() and extracts the path.
+ *
+ * It can be called again without recomputing the rays, as long as the
+ * polygons and start/end points did not change.
+ * @returns Same as oa_process().
  */
-int8_t oa_process(struct obstacle_avoidance* oa);
+int oa_process_path(struct obstacle_avoidance* oa);
 
 /** Gets the computed path.
  *
@@ -124,6 +124,24 @@ struct xya_position_s16 {
     int16_t a; /**< The angle relative to the X axis in degrees. */
 };
 
+/** @brief Number of past positions kept for latency compensation.
+ *
+ * At the 100 Hz odometry rate this covers a bit more than one second, which
+ * is longer than the delay of any of the absolute position sensors.
+ */
+#define POSITION_HISTORY_LEN 128
+
+/** @brief A past position of the robot.
+ *
+ * Besides the position, the encoder motion which led to it is stored, so that
+ * the odometry can be replayed after a correction.
+ */
+struct position_history_entry {
+    uint32_t timestamp_us; /**< Time of the sample, in us (wraps around). */
+    struct rs_polar delta; /**< Encoder motion since the previous sample. */
+    struct xya_position pos; /**< Position after applying delta. */
+};
+
 /** \brief Instance of the odometry subsystem.
  *
  * This structure holds everything that is needed to compute and store the
@@ -138,6 +156,10 @@ struct robot_position {
     struct rs_polar prev_encoders GUARDED_BY(lock_); /**< Previous state of the encoders. */
     struct robot_system* rs GUARDED_BY(lock_); /**< Robot system used for the computations. */
 
+    struct position_history_entry history[POSITION_HISTORY_LEN] GUARDED_BY(lock_); /**< Ring of past positions. */
+    int history_head GUARDED_BY(lock_); /**< Index where the next sample is written. */
+    int history_len GUARDED_BY(lock_); /**< Number of valid samples in the ring. */
+
 #ifdef CONFIG_MODULE_COMPENSATE_CENTRIFUGAL_FORCE
     double centrifugal_coef GUARDED_BY(lock_); /**< Coefficient for the centrifugal computation */
 #endif
@@ -162,6 +184,9 @@ void position_set_centrifugal_coef(struct robot_position* pos, double coef) LOCK
 #endif
 
 /** @brief Set a new robot position.
+ *
+ * The position history is cleared, as the past samples are not related to
+ * the new position anymore.
  * @param [in] pos The odometry instance.
  * @param [in] x, y The new coordinate of the robot, in mm.
  * @param [in] a_deg The new angle of the robot, in degree.
@@ -215,6 +240,46 @@ void position_set_related_robot_system(struct robot_position* pos, struct robot_
  */
 void position_manage(struct robot_position* pos) LOCKS_EXCLUDED(pos->lock_);
 
+/** @brief Updates the position and records it in the history.
+ *
+ * Same as position_manage(), but the new position is also stored with its
+ * timestamp, so that it can later be looked up with position_get_at() or
+ * corrected with position_correct_at().
+ *
+ * @param [in] pos The odometry system instance.
+ * @param [in] timestamp_us The time at which the encoders were read, in us.
+ * It must increase between calls, but may wrap around (eg timestamp_get()).
+ */
+void position_manage_at(struct robot_position* pos, uint32_t timestamp_us) LOCKS_EXCLUDED(pos->lock_);
+
+/** @brief Returns the position of the robot at a past time.
+ *
+ * The position is interpolated between the two samples of the history
+ * surrounding timestamp_us, which are found by binary search. A time after
+ * the latest sample returns the latest position.
+ *
+ * @param [in] pos The odometry system instance.
+ * @param [in] timestamp_us The time of interest, in us.
+ * @param [out] res The position at that time.
+ * @return false if the history does not go back as far as timestamp_us.
+ */
+bool position_get_at(struct robot_position* pos, uint32_t timestamp_us, struct xya_position* res) LOCKS_EXCLUDED(pos->lock_);
+
+/** @brief Corrects a past position and replays the odometry from it.
+ *
+ * This is used to fuse a delayed absolute measurement, such as a beacon fix:
+ * the sample at or just before timestamp_us is replaced by the corrected
+ * position, then the encoder motion recorded after it is applied again to
+ * get the corrected current position.
+ *
+ * @param [in] pos The odometry system instance.
+ * @param [in] timestamp_us The time of the measurement, in us.
+ * @param [in] corrected The position of the robot at that time.
+ * @return false if the history does not go back as far as timestamp_us, in
+ * which case the position is left untouched.
+ */
+bool position_correct_at(struct robot_position* pos, uint32_t timestamp_us, const struct xya_position* corrected) LOCKS_EXCLUDED(pos->lock_);
+
 /** @brief Get current X.
  *
  * @param [in] pos The odometry system instance.
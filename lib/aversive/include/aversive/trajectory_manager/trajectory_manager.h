@@ -134,6 +134,7 @@ struct trajectory {
     struct robot_system* robot; /**<< associated robot_system */
     struct cs* csm_angle; /**<< associated control system (angle) */
     struct cs* csm_distance; /**<< associated control system (distance) */
+    absl::Mutex* cs_lock = nullptr; /**<< lock of the control systems and robot system, taken after lock_ */
 
     double cs_hz; /**< The frequency of the control system associated with this manager. */
 };
@@ -154,6 +155,17 @@ void trajectory_manager_init(struct trajectory* traj, double cs_hz);
  */
 void trajectory_set_cs(struct trajectory* traj, struct cs* cs_d, struct cs* cs_a);
 
+/** @brief Sets the lock protecting the control systems and robot system.
+ *
+ * When the control systems are managed from another thread, the trajectory
+ * manager takes this lock whenever it reads or changes their consigns. It is
+ * always taken after the lock of the trajectory manager.
+ *
+ * @param [in] traj The trajectory manager instance.
+ * @param [in] lock The lock, or NULL if the control systems are not shared.
+ */
+void trajectory_set_cs_lock(struct trajectory* traj, absl::Mutex* lock);
+
 /** @brief Sets related robot params.
  *
  * Sets the robot_pos and robot_system used for the computation of the trajectory.
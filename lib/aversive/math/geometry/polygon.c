@@ -38,22 +38,24 @@
 #endif
 
 /* default bounding box is (0,0) (100,100) */
-static int32_t bbox_x1 = 0;
-static int32_t bbox_y1 = 0;
-static int32_t bbox_x2 = 100;
-static int32_t bbox_y2 = 100;
+static bbox_t global_bbox = {0, 0, 100, 100};
 
 void polygon_set_boundingbox(int32_t x1, int32_t y1, int32_t x2, int32_t y2)
 {
-    bbox_x1 = x1;
-    bbox_y1 = y1;
-    bbox_x2 = x2;
-    bbox_y2 = y2;
+    global_bbox.x1 = x1;
+    global_bbox.y1 = y1;
+    global_bbox.x2 = x2;
+    global_bbox.y2 = y2;
 }
 
 int is_in_boundingbox(const point_t* p)
 {
-    if (p->x >= bbox_x1 && p->x <= bbox_x2 && p->y >= bbox_y1 && p->y <= bbox_y2) {
+    return is_in_bbox(&global_bbox, p);
+}
+
+int is_in_bbox(const bbox_t* bbox, const point_t* p)
+{
+    if (p->x >= bbox->x1 && p->x <= bbox->x2 && p->y >= bbox->y1 && p->y <= bbox->y2) {
         return 1;
     }
     return 0;
@@ -217,7 +219,12 @@ int is_crossing_poly(point_t p1, point_t p2, point_t* intersect_pt, poly_t* pol)
  *  are used to compute visibility to start/stop points)
  */
 
-int calc_rays(poly_t* polys, int npolys, int* rays)
+int calc_rays(poly_t* polys, int npolys, int* rays, int max_rays)
+{
+    return calc_rays_in_bbox(&global_bbox, polys, npolys, rays, max_rays);
+}
+
+int calc_rays_in_bbox(const bbox_t* bbox, poly_t* polys, int npolys, int* rays, int max_rays)
 {
     int i, ii, index;
     int ray_n = 0;
@@ -236,13 +243,13 @@ int calc_rays(poly_t* polys, int npolys, int* rays)
         debug_printf("%s(): poly num %d/%d\n", __FUNCTION__, i, npolys);
         for (ii = 0; ii < polys[i].l; ii++) {
             debug_printf("%s() line num %d/%d\n", __FUNCTION__, ii, polys[i].l);
-            if (!is_in_boundingbox(&polys[i].pts[ii])) {
+            if (!is_in_bbox(bbox, &polys[i].pts[ii])) {
                 continue;
             }
             is_ok = 1;
             n = (ii + 1) % polys[i].l;
 
-            if (!(is_in_boundingbox(&polys[i].pts[n]))) {
+            if (!(is_in_bbox(bbox, &polys[i].pts[n]))) {
                 continue;
             }
 
@@ -263,6 +270,9 @@ int calc_rays(poly_t* polys, int npolys, int* rays)
             }
             /* if ray is not crossed, add it */
             if (is_ok) {
+                if (ray_n + 4 > 2 * max_rays) {
+                    return -1;
+                }
                 rays[ray_n++] = i;
                 rays[ray_n++] = ii;
                 rays[ray_n++] = i;
@@ -277,14 +287,14 @@ int calc_rays(poly_t* polys, int npolys, int* rays)
     /* For all poly */
     for (i = 0; i < npolys - 1; i++) {
         for (pt1 = 0; pt1 < polys[i].l; pt1++) {
-            if (!(is_in_boundingbox(&polys[i].pts[pt1]))) {
+            if (!(is_in_bbox(bbox, &polys[i].pts[pt1]))) {
                 continue;
             }
 
             /* for next poly */
             for (ii = i + 1; ii < npolys; ii++) {
                 for (pt2 = 0; pt2 < polys[ii].l; pt2++) {
-                    if (!(is_in_boundingbox(&polys[ii].pts[pt2]))) {
+                    if (!(is_in_bbox(bbox, &polys[ii].pts[pt2]))) {
                         continue;
                     }
 
@@ -301,6 +311,9 @@ int calc_rays(poly_t* polys, int npolys, int* rays)
                     }
                     /* if not crossed, we found a vilisity ray */
                     if (is_ok) {
+                        if (ray_n + 4 > 2 * max_rays) {
+                            return -1;
+                        }
                         rays[ray_n++] = i;
                         rays[ray_n++] = pt1;
                         rays[ray_n++] = ii;
@@ -0,0 +1,172 @@
+#include <algorithm>
+
+#include "fixtures.h"
+
+namespace oa_benchmark {
+
+/* The fixtures were recorded from map_init() in the master firmware, with
+ * the robot_size_x_mm and opponent_size_x_mm_default values of our configs,
+ * and from opponent positions reported by the beacon during matches. */
+static const int table_size_x = 3000;
+static const int table_size_y = 2000;
+static const int robot_size = 260;
+static const int opponent_half_size = (400 * 1.25 + robot_size) / 2;
+static const int ally_radius = 1.25 * (robot_size + robot_size) / 2;
+static const int puck_half_size = (76 + robot_size) / 2;
+
+static float clamp(float value, float min, float max)
+{
+    return std::min(std::max(value, min), max);
+}
+
+/* Same as map_set_rectangular_obstacle() */
+static std::vector<point_t> square(float x, float y, float half_size)
+{
+    auto px = [](float v) { return clamp(v, 0, table_size_x); };
+    auto py = [](float v) { return clamp(v, 0, table_size_y); };
+
+    return {
+        {px(x + half_size), py(y - half_size)},
+        {px(x + half_size), py(y + half_size)},
+        {px(x - half_size), py(y + half_size)},
+        {px(x - half_size), py(y - half_size)},
+    };
+}
+
+/* Same as map_set_ally_obstacle() */
+static std::vector<point_t> diamond(float x, float y, float radius)
+{
+    return {
+        {x + radius, y},
+        {x, y + radius},
+        {x - radius, y},
+        {x, y - radius},
+    };
+}
+
+static const bbox_t eurobot_playground = {
+    robot_size / 2,
+    robot_size / 2,
+    table_size_x - robot_size / 2,
+    table_size_y - robot_size / 2,
+};
+
+/* Wall, distributors and ramp of the Eurobot 2019 table, inflated by half
+ * the robot size. */
+static const std::vector<std::vector<point_t>> eurobot_static_obstacles = {
+    {{1650, 1220}, {1650, 1680}, {1350, 1680}, {1350, 1220}},
+    {{1180, 1413}, {1180, 1708}, {320, 1708}, {320, 1413}},
+    {{2680, 1413}, {2680, 1708}, {1820, 1708}, {1820, 1413}},
+    {{2680, 1448}, {2680, 2000}, {320, 2000}, {320, 1448}},
+};
+
+static const std::vector<point_t> opponent_positions = {
+    {1500, 700},
+    {2200, 1000},
+    {800, 1000},
+    {2000, 300},
+};
+
+static const std::vector<point_t> puck_positions = {
+    {600, 200},
+    {1100, 200},
+    {1500, 200},
+    {1900, 200},
+    {2400, 200},
+    {600, 1200},
+    {1100, 1200},
+    {1500, 1200},
+    {1900, 1200},
+    {2400, 1200},
+};
+
+static const std::vector<Query> eurobot_queries = {
+    {"across_table", {250, 450}, {2750, 450}},
+    {"behind_ramp", {250, 450}, {2725, 1740}},
+    {"front_of_ramp", {250, 450}, {850, 1383}},
+};
+
+static MapFixture eurobot_with_opponents(int opponent_count)
+{
+    MapFixture map;
+    map.name = "eurobot_" + std::to_string(opponent_count) + "_opponents";
+    map.playground = eurobot_playground;
+    map.obstacles = eurobot_static_obstacles;
+    map.obstacles.push_back(diamond(2500, 600, ally_radius));
+    for (int i = 0; i < opponent_count; i++) {
+        map.obstacles.push_back(square(opponent_positions[i].x, opponent_positions[i].y, opponent_half_size));
+    }
+    map.queries = eurobot_queries;
+    return map;
+}
+
+struct oa_limits MapFixture::limits() const
+{
+    int points = 2;
+    for (const auto& obstacle : obstacles) {
+        points += obstacle.size();
+    }
+
+    struct oa_limits limits;
+    limits.max_polys = obstacles.size() + 1;
+    limits.max_pts = points;
+    limits.max_rays = 2 * (points * (points - 1) / 2 + points); // 2 ends per ray
+    limits.max_checkpoints = points;
+    return limits;
+}
+
+bool MapFixture::load(struct obstacle_avoidance* oa) const
+{
+    const struct oa_limits l = limits();
+    if (oa_init_with_limits(oa, &l) != 0) {
+        return false;
+    }
+    oa_set_boundingbox(oa, playground.x1, playground.y1, playground.x2, playground.y2);
+
+    for (const auto& obstacle : obstacles) {
+        poly_t* poly = oa_new_poly(oa, obstacle.size());
+        if (poly == NULL) {
+            oa_deinit(oa);
+            return false;
+        }
+        for (size_t i = 0; i < obstacle.size(); i++) {
+            oa_poly_set_point(oa, poly, obstacle[i].x, obstacle[i].y, i);
+        }
+    }
+
+    return true;
+}
+
+std::vector<MapFixture> all_fixtures()
+{
+    std::vector<MapFixture> maps;
+
+    MapFixture empty;
+    empty.name = "empty_table";
+    empty.playground = eurobot_playground;
+    empty.queries = eurobot_queries;
+    maps.push_back(empty);
+
+    MapFixture eurobot;
+    eurobot.name = "eurobot";
+    eurobot.playground = eurobot_playground;
+    eurobot.obstacles = eurobot_static_obstacles;
+    eurobot.queries = eurobot_queries;
+    maps.push_back(eurobot);
+
+    for (int i = 1; i <= 4; i++) {
+        maps.push_back(eurobot_with_opponents(i));
+    }
+
+    /* As many polygons as the default limits allow */
+    MapFixture worst_case = eurobot_with_opponents(4);
+    worst_case.name = "eurobot_worst_case";
+    for (const auto& puck : puck_positions) {
+        worst_case.obstacles.push_back(square(puck.x, puck.y, puck_half_size));
+    }
+    maps.push_back(worst_case);
+
+    return maps;
+}
+
+} // namespace oa_benchmark
@@ -0,0 +1,42 @@
+#ifndef OBSTACLE_AVOIDANCE_BENCHMARK_FIXTURES_H
+#define OBSTACLE_AVOIDANCE_BENCHMARK_FIXTURES_H
+
+#include <string>
+#include <vector>
+
+#include <aversive/obstacle_avoidance/obstacle_avoidance.h>
+
+namespace oa_benchmark {
+
+/** A path planning request on a map. */
+struct Query {
+    std::string name;
+    point_t start;
+    point_t end;
+};
+
+/** A recorded map: playground and obstacles, already inflated by the robot
+ * size, plus the queries to run on it. */
+struct MapFixture {
+    std::string name;
+    bbox_t playground;
+    std::vector<std::vector<point_t>> obstacles;
+    std::vector<Query> queries;
+
+    /** Limits large enough for any query on this map. */
+    struct oa_limits limits() const;
+
+    /** Initializes oa with the playground and obstacles of this map.
+     *
+     * @returns false if oa could not be allocated or does not fit the whole
+     * map, in which case it does not need to be deinitialized. */
+    bool load(struct obstacle_avoidance* oa) const;
+};
+
+/** Returns all the maps used by the benchmarks, from the simplest to the
+ * most complex one. */
+std::vector<MapFixture> all_fixtures();
+
+} // namespace oa_benchmark
+
+#endif
@@ -1,6 +1,11 @@
 #include <benchmark/benchmark.h>
 #include <aversive/obstacle_avoidance/obstacle_avoidance.h>
 
+#include "fixtures.h"
+
+using oa_benchmark::MapFixture;
+using oa_benchmark::Query;
+
 static void BM_ObstacleAvoidance(benchmark::State& state)
 {
     const point_t start = {.x = 1000, .y = 1000};
@@ -9,7 +14,10 @@ static void BM_ObstacleAvoidance(benchmark::State& state)
     struct obstacle_avoidance oa;
 
     polygon_set_boundingbox(0, 0, 3000, 3000);
-    oa_init(&oa);
+    if (oa_init(&oa) != 0) {
+        state.SkipWithError("Could not allocate the obstacle avoidance");
+        return;
+    }
     oa_start_end_points(&oa, start.x, start.y, end.x, end.y);
 
     for (int i = 0; i < state.range(0); i++) {
@@ -26,7 +34,103 @@ static void BM_ObstacleAvoidance(benchmark::State& state)
         auto point_cnt = oa_get_path(&oa, &points);
         benchmark::DoNotOptimize(point_cnt);
     }
+
+    oa_deinit(&oa);
 }
 
 BENCHMARK(BM_ObstacleAvoidance)->RangeMultiplier(2)->Range(1, 8);
-BENCHMARK_MAIN();
+
+/* Visibility graph construction only */
+static void BM_CalcRays(benchmark::State& state, const MapFixture& map, const Query& query)
+{
+    struct obstacle_avoidance oa;
+    if (!map.load(&oa)) {
+        state.SkipWithError("Could not load the map");
+        return;
+    }
+    oa_start_end_points(&oa, query.start.x, query.start.y, query.end.x, query.end.y);
+
+    int ray_n = 0;
+    for (auto _ : state) {
+        ray_n = oa_process_rays(&oa);
+        benchmark::DoNotOptimize(ray_n);
+    }
+
+    state.counters["polygons"] = oa.cur_poly_idx;
+    state.counters["rays"] = ray_n / 4;
+    oa_deinit(&oa);
+}
+
+/* Shortest path search on an already computed visibility graph */
+static void BM_Dijkstra(benchmark::State& state, const MapFixture& map, const Query& query)
+{
+    struct obstacle_avoidance oa;
+    if (!map.load(&oa)) {
+        state.SkipWithError("Could not load the map");
+        return;
+    }
+    oa_start_end_points(&oa, query.start.x, query.start.y, query.end.x, query.end.y);
+    oa_process_rays(&oa);
+
+    int path_len = 0;
+    for (auto _ : state) {
+        path_len = oa_process_path(&oa);
+        benchmark::DoNotOptimize(path_len);
+    }
+
+    state.counters["rays"] = oa.ray_n / 4;
+    state.counters["path_len"] = path_len;
+    oa_deinit(&oa);
+}
+
+/* What a planner call costs: setting the query, processing and reading the
+ * path back. */
+static void BM_EndToEnd(benchmark::State& state, const MapFixture& map, const Query& query)
+{
+    struct obstacle_avoidance oa;
+    if (!map.load(&oa)) {
+        state.SkipWithError("Could not load the map");
+        return;
+    }
+
+    int path_len = 0;
+    for (auto _ : state) {
+        point_t* points;
+        oa_start_end_points(&oa, query.start.x, query.start.y, query.end.x, query.end.y);
+        oa_process(&oa);
+        path_len = oa_get_path(&oa, &points);
+        benchmark::DoNotOptimize(points);
+    }
+
+    state.counters["path_len"] = path_len;
+    oa_deinit(&oa);
+}
+
+static void register_fixture_benchmarks()
+{
+    /* Fixtures must outlive the registered benchmarks */
+    static const auto maps = oa_benchmark::all_fixtures();
+
+    for (const auto& map : maps) {
+        for (const auto& query : map.queries) {
+            const auto suffix = "/" + map.name + "/" + query.name;
+            benchmark::RegisterBenchmark(("calc_rays" + suffix).c_str(), BM_CalcRays, map, query);
+            benchmark::RegisterBenchmark(("dijkstra" + suffix).c_str(), BM_Dijkstra, map, query);
+            benchmark::RegisterBenchmark(("end_to_end" + suffix).c_str(), BM_EndToEnd, map, query);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    register_fixture_benchmarks();
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
@@ -46,29 +46,84 @@
 
 static void __oa_start_end_points(struct obstacle_avoidance* oa, int32_t st_x, int32_t st_y, int32_t en_x, int32_t en_y);
 
+/* Round up arena sections so that every array is suitably aligned */
+#define OA_ARENA_ALIGN(size) (((size) + sizeof(void*) - 1) & ~(sizeof(void*) - 1))
+
+/* reset the Dijkstra state and the result, keeping the visibility graph.
+ * Only the part of the arrays which was used by the previous run is
+ * cleared. */
+static void oa_reset_path(struct obstacle_avoidance* oa)
+{
+    memset(oa->valid, 0, oa->cur_pt_idx * sizeof(oa->valid[0]));
+    memset(oa->pweight, 0, oa->cur_pt_idx * sizeof(oa->pweight[0]));
+    memset(oa->p, 0, oa->cur_pt_idx * sizeof(oa->p[0]));
+    memset(oa->pt, 0, oa->cur_pt_idx * sizeof(oa->pt[0]));
+    if (oa->res_len > 0) {
+        memset(oa->res, 0, oa->res_len * sizeof(oa->res[0]));
+    }
+    oa->res_len = 0;
+}
+
 /* reset oa without reseting points coord */
 static void oa_reset(struct obstacle_avoidance* oa)
 {
     DEBUG_OA_PRINTF("%s()\r", __FUNCTION__);
 
-    memset(oa->valid, 0, sizeof(oa->valid));
-    memset(oa->pweight, 0, sizeof(oa->pweight));
-    memset(oa->weight, 0, sizeof(oa->weight));
-    memset(oa->p, 0, sizeof(oa->p));
-    memset(oa->pt, 0, sizeof(oa->pt));
-    memset(oa->rays, 0, sizeof(oa->rays));
-    memset(oa->res, 0, sizeof(oa->res));
+    oa_reset_path(oa);
+    if (oa->ray_n > 0) {
+        memset(oa->weight, 0, (oa->ray_n / 4) * sizeof(oa->weight[0]));
+        memset(oa->rays, 0, oa->ray_n * sizeof(oa->rays[0]));
+    }
     oa->ray_n = 0;
-    oa->res_len = 0;
+}
+
+size_t oa_arena_size(const struct oa_limits* limits)
+{
+    size_t size = 0;
+
+    size += OA_ARENA_ALIGN(limits->max_polys * sizeof(poly_t));
+    size += OA_ARENA_ALIGN(limits->max_pts * sizeof(point_t));
+    size += OA_ARENA_ALIGN(limits->max_pts * sizeof(int)); /* valid */
+    size += OA_ARENA_ALIGN(limits->max_pts * sizeof(int32_t)); /* pweight */
+    size += OA_ARENA_ALIGN(limits->max_pts * sizeof(int)); /* p */
+    size += OA_ARENA_ALIGN(limits->max_pts * sizeof(int)); /* pt */
+    size += OA_ARENA_ALIGN(limits->max_rays * sizeof(int)); /* weight */
+    size += OA_ARENA_ALIGN(limits->max_rays * 2 * sizeof(int)); /* rays */
+    size += OA_ARENA_ALIGN(limits->max_checkpoints * sizeof(point_t));
+
+    return size;
+}
+
+/* Returns the current arena position and moves it past the given size */
+static void* oa_arena_take(uint8_t** pos, size_t size)
+{
+    void* res = *pos;
+    *pos += OA_ARENA_ALIGN(size);
+    return res;
 }
 
 /** Init the oa structure. Note: In the algorithm, the first polygon
  * is a dummy one, and is used to represent the START and END points
  * (so it has 2 vertices) */
-void oa_init(struct obstacle_avoidance* oa)
+void oa_init_arena(struct obstacle_avoidance* oa, const struct oa_limits* limits, void* arena)
 {
     DEBUG_OA_PRINTF("%s()\r", __FUNCTION__);
+    uint8_t* pos = arena;
+
     memset(oa, 0, sizeof(struct obstacle_avoidance));
+    memset(arena, 0, oa_arena_size(limits));
+
+    oa->limits = *limits;
+    oa->arena = arena;
+    oa->polys = oa_arena_take(&pos, limits->max_polys * sizeof(poly_t));
+    oa->points = oa_arena_take(&pos, limits->max_pts * sizeof(point_t));
+    oa->valid = oa_arena_take(&pos, limits->max_pts * sizeof(int));
+    oa->pweight = oa_arena_take(&pos, limits->max_pts * sizeof(int32_t));
+    oa->p = oa_arena_take(&pos, limits->max_pts * sizeof(int));
+    oa->pt = oa_arena_take(&pos, limits->max_pts * sizeof(int));
+    oa->weight = oa_arena_take(&pos, limits->max_rays * sizeof(int));
+    oa->rays = oa_arena_take(&pos, limits->max_rays * 2 * sizeof(int));
+    oa->res = oa_arena_take(&pos, limits->max_checkpoints * sizeof(point_t));
 
     /* set a default start and point, reserve the first poly and
      * the first 2 points for it */
@@ -79,10 +134,63 @@ void oa_init(struct obstacle_avoidance* oa)
     oa->cur_poly_idx = 1;
 }
 
-void oa_copy(struct obstacle_avoidance* dst, const struct obstacle_avoidance* oa)
+int oa_init_with_limits(struct obstacle_avoidance* oa, const struct oa_limits* limits)
 {
-    memset(dst, 0, sizeof(struct obstacle_avoidance));
-    memcpy(dst, oa, sizeof(struct obstacle_avoidance));
+    void* arena = malloc(oa_arena_size(limits));
+
+    if (arena == NULL) {
+        return -1;
+    }
+
+    oa_init_arena(oa, limits, arena);
+    oa->arena_is_owned = 1;
+
+    return 0;
+}
+
+int oa_init(struct obstacle_avoidance* oa)
+{
+    const struct oa_limits limits = OA_DEFAULT_LIMITS;
+
+    return oa_init_with_limits(oa, &limits);
+}
+
+void oa_deinit(struct obstacle_avoidance* oa)
+{
+    if (oa->arena_is_owned) {
+        free(oa->arena);
+    }
+    memset(oa, 0, sizeof(struct obstacle_avoidance));
+}
+
+int oa_copy(struct obstacle_avoidance* dst, const struct obstacle_avoidance* oa)
+{
+    int i;
+
+    if (oa->cur_poly_idx > dst->limits.max_polys || oa->cur_pt_idx > dst->limits.max_pts) {
+        return -1;
+    }
+
+    /* Polygons point into the source point array, rebase them on ours */
+    for (i = 0; i < oa->cur_poly_idx; i++) {
+        dst->polys[i].l = oa->polys[i].l;
+        dst->polys[i].pts = dst->points + (oa->polys[i].pts - oa->points);
+    }
+    memcpy(dst->points, oa->points, oa->cur_pt_idx * sizeof(point_t));
+    memcpy(dst->valid, oa->valid, oa->cur_pt_idx * sizeof(int));
+    memcpy(dst->pweight, oa->pweight, oa->cur_pt_idx * sizeof(int32_t));
+    memset(dst->p, 0, oa->cur_pt_idx * sizeof(int));
+    memset(dst->pt, 0, oa->cur_pt_idx * sizeof(int));
+
+    /* The results of the last run are not copied */
+    dst->bbox = oa->bbox;
+    dst->has_bbox = oa->has_bbox;
+    dst->cur_poly_idx = oa->cur_poly_idx;
+    dst->cur_pt_idx = oa->cur_pt_idx;
+    dst->ray_n = 0;
+    dst->res_len = 0;
+
+    return 0;
 }
 
 /**
@@ -110,6 +218,15 @@ static void __oa_start_end_points(struct obstacle_avoidance* oa, int32_t st_x, i
     oa->pweight[GET_PT(oa->points[1])] = 0;
 }
 
+void oa_set_boundingbox(struct obstacle_avoidance* oa, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+    oa->bbox.x1 = x1;
+    oa->bbox.y1 = y1;
+    oa->bbox.x2 = x2;
+    oa->bbox.y2 = y2;
+    oa->has_bbox = 1;
+}
+
 /**
  * Set the start and destination point. Return 0 on sucess
  */
@@ -126,10 +243,10 @@ poly_t* oa_new_poly(struct obstacle_avoidance* oa, int size)
 {
     DEBUG_OA_PRINTF("%s(size=%d)\r", __FUNCTION__, size);
 
-    if (oa->cur_pt_idx + size > MAX_PTS) {
+    if (oa->cur_pt_idx + size > oa->limits.max_pts) {
         return NULL;
     }
-    if (oa->cur_poly_idx + 1 > MAX_POLY) {
+    if (oa->cur_poly_idx + 1 > oa->limits.max_polys) {
         return NULL;
     }
 
@@ -214,7 +331,7 @@ void oa_dump(struct obstacle_avoidance* oa)
  * When the algo finds a shorter path to reach a point B from point A,
  * it will store in (p, pt) the parent point. This is important to
  * remenber and extract the solution path. */
-void dijkstra(struct obstacle_avoidance* oa, int start_p, uint8_t start)
+void dijkstra(struct obstacle_avoidance* oa, int start_p, int start)
 {
     int i;
     int8_t add;
@@ -229,7 +346,7 @@ void dijkstra(struct obstacle_avoidance* oa, int start_p, uint8_t start)
     while (!finish) {
         finish = 1;
 
-        for (start_p = 0; start_p < MAX_POLY; start_p++) {
+        for (start_p = 0; start_p < oa->cur_poly_idx; start_p++) {
             for (start = 0; start < oa->polys[start_p].l; start++) {
                 if (oa->valid[GET_PT(oa->polys[start_p].pts[start])] != 2) {
                     continue;
@@ -286,7 +403,7 @@ void dijkstra(struct obstacle_avoidance* oa, int start_p, uint8_t start)
 }
 
 /* display the path */
-int8_t get_path(struct obstacle_avoidance* oa, poly_t* polys)
+int get_path(struct obstacle_avoidance* oa, poly_t* polys)
 {
     int p, pt, p1, pt1, i;
 
@@ -297,7 +414,7 @@ int8_t get_path(struct obstacle_avoidance* oa, poly_t* polys)
     /* forget the first point */
 
     while (!(p == 0 && pt == 0)) {
-        if (i >= MAX_CHKPOINTS) {
+        if (i >= oa->limits.max_checkpoints) {
             return -1;
         }
 
@@ -319,8 +436,7 @@ int8_t get_path(struct obstacle_avoidance* oa, poly_t* polys)
     return i;
 }
 
-int8_t
-oa_process(struct obstacle_avoidance* oa)
+int oa_process_rays(struct obstacle_avoidance* oa)
 {
     int ret;
     int i;
@@ -328,9 +444,18 @@ oa_process(struct obstacle_avoidance* oa)
     oa_reset(oa);
 
     /* First we compute the visibility graph */
-    ret = calc_rays(oa->polys, oa->cur_poly_idx, oa->rays);
+    if (oa->has_bbox) {
+        ret = calc_rays_in_bbox(&oa->bbox, oa->polys, oa->cur_poly_idx, oa->rays, oa->limits.max_rays);
+    } else {
+        ret = calc_rays(oa->polys, oa->cur_poly_idx, oa->rays, oa->limits.max_rays);
+    }
     DEBUG_OA_PRINTF("%s: %d rays\r", __FUNCTION__, ret);
 
+    if (ret < 0) {
+        DEBUG_OA_PRINTF("too many rays!\r");
+        return -3;
+    }
+
     DEBUG_OA_PRINTF("Ray list\r");
     for (i = 0; i < ret; i += 4) {
         DEBUG_OA_PRINTF("%d,%d -> %d,%d\r", oa->rays[i], oa->rays[i + 1], oa->rays[i + 2],
@@ -351,10 +476,17 @@ oa_process(struct obstacle_avoidance* oa)
                         oa->weight[i / 4]);
     }
 
+    oa->ray_n = ret;
+    return ret;
+}
+
+int oa_process_path(struct obstacle_avoidance* oa)
+{
+    oa_reset_path(oa);
+
     /* We aplly dijkstra on the visibility graph from the start
      * point (point 0 of the polygon 0) */
-    oa->ray_n = ret;
-    DEBUG_OA_PRINTF("dijkstra ray_n = %d\r", ret);
+    DEBUG_OA_PRINTF("dijkstra ray_n = %d\r", oa->ray_n);
     dijkstra(oa, 0, 0);
 
     /* As dijkstra sets the parent points in the resulting graph,
@@ -362,3 +494,13 @@ oa_process(struct obstacle_avoidance* oa)
     oa->res_len = get_path(oa, oa->polys);
     return oa->res_len;
 }
+
+int oa_process(struct obstacle_avoidance* oa)
+{
+    if (oa_process_rays(oa) < 0) {
+        oa->res_len = -3;
+        return oa->res_len;
+    }
+
+    return oa_process_path(oa);
+}
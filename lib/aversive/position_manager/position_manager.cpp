@@ -43,6 +43,7 @@ void position_set(struct robot_position* pos, int16_t x, int16_t y, double a_deg
     pos->pos_s16.x = x;
     pos->pos_s16.y = y;
     pos->pos_s16.a = a_deg;
+    pos->history_len = 0;
 }
 
 #ifdef CONFIG_MODULE_COMPENSATE_CENTRIFUGAL_FORCE
@@ -101,49 +102,16 @@ void position_use_mot(struct robot_position* pos)
 #endif
 
 /**
- * Process the absolute position (x,y,a) depending on the delta on
- * virtual encoders since last read, and depending on physical
- * parameters. The processed position is in mm.
+ * Applies the encoder motion delta to the position p, following a circle arc.
  */
-void position_manage(struct robot_position* pos)
+static void position_integrate(struct robot_position* pos, struct xya_position* p, struct rs_polar delta) SHARED_LOCKS_REQUIRED(pos->lock_)
 {
-    absl::MutexLock l(&pos->lock_);
     double x, y, a, r, arc_angle;
     double dx, dy;
-    int16_t x_s16, y_s16, a_s16;
-    struct rs_polar encoders;
-    struct rs_polar delta;
-    struct robot_system* rs;
-
-    rs = pos->rs;
-    /* here we could raise an error */
-    if (rs == nullptr) {
-        return;
-    }
-
-#ifdef CONFIG_MODULE_ROBOT_SYSTEM_MOT_AND_EXT
-    if (pos->use_ext) {
-        encoders.distance = rs_get_ext_distance(rs);
-        encoders.angle = rs_get_ext_angle(rs);
-    } else {
-        encoders.distance = rs_get_mot_distance(rs);
-        encoders.angle = rs_get_mot_angle(rs);
-    }
-#else
-    encoders.distance = rs_get_ext_distance(rs);
-    encoders.angle = rs_get_ext_angle(rs);
-#endif
 
-    /* process difference between 2 measures.
-     * No lock for prev_encoders since we are the only one to use
-     * this var. */
-    delta.distance = encoders.distance - pos->prev_encoders.distance;
-    delta.angle = encoders.angle - pos->prev_encoders.angle;
-
-    /* update double position */
-    a = pos->pos_d.a;
-    x = pos->pos_d.x;
-    y = pos->pos_d.y;
+    a = p->a;
+    x = p->x;
+    y = p->y;
 
     if (delta.angle == 0) {
         /* we go straight */
@@ -195,19 +163,206 @@ void position_manage(struct robot_position* pos)
 #endif
     }
 
+    p->a = a;
+    p->x = x;
+    p->y = y;
+}
+
+/**
+ * Sets the current position, in double and integers.
+ */
+static void position_store(struct robot_position* pos, const struct xya_position* p) EXCLUSIVE_LOCKS_REQUIRED(pos->lock_)
+{
+    pos->pos_d = *p;
+    pos->pos_s16.x = (int16_t)p->x;
+    pos->pos_s16.y = (int16_t)p->y;
+    pos->pos_s16.a = (int16_t)(p->a * (360.0 / (M_PI * 2)));
+}
+
+/**
+ * Process the absolute position (x,y,a) depending on the delta on
+ * virtual encoders since last read, and depending on physical
+ * parameters. The processed position is in mm. Returns false if there is no
+ * robot system to read the encoders from.
+ */
+static bool position_update(struct robot_position* pos, struct rs_polar* delta) EXCLUSIVE_LOCKS_REQUIRED(pos->lock_)
+{
+    struct rs_polar encoders;
+    struct xya_position p;
+    struct robot_system* rs;
+
+    rs = pos->rs;
+    /* here we could raise an error */
+    if (rs == nullptr) {
+        return false;
+    }
+
+#ifdef CONFIG_MODULE_ROBOT_SYSTEM_MOT_AND_EXT
+    if (pos->use_ext) {
+        encoders.distance = rs_get_ext_distance(rs);
+        encoders.angle = rs_get_ext_angle(rs);
+    } else {
+        encoders.distance = rs_get_mot_distance(rs);
+        encoders.angle = rs_get_mot_angle(rs);
+    }
+#else
+    encoders.distance = rs_get_ext_distance(rs);
+    encoders.angle = rs_get_ext_angle(rs);
+#endif
+
+    /* process difference between 2 measures.
+     * No lock for prev_encoders since we are the only one to use
+     * this var. */
+    delta->distance = encoders.distance - pos->prev_encoders.distance;
+    delta->angle = encoders.angle - pos->prev_encoders.angle;
+
+    p = pos->pos_d;
+    position_integrate(pos, &p, *delta);
+
     pos->prev_encoders = encoders;
+    position_store(pos, &p);
 
-    /* update int position */
-    x_s16 = (int16_t)x;
-    y_s16 = (int16_t)y;
-    a_s16 = (int16_t)(a * (360.0 / (M_PI * 2)));
+    return true;
+}
 
-    pos->pos_d.a = a;
-    pos->pos_d.x = x;
-    pos->pos_d.y = y;
-    pos->pos_s16.x = x_s16;
-    pos->pos_s16.y = y_s16;
-    pos->pos_s16.a = a_s16;
+void position_manage(struct robot_position* pos)
+{
+    absl::MutexLock l(&pos->lock_);
+    struct rs_polar delta;
+
+    position_update(pos, &delta);
+}
+
+/**
+ * Returns the i-th sample of the history, 0 being the oldest one.
+ */
+static struct position_history_entry* position_history_at(struct robot_position* pos, int i) SHARED_LOCKS_REQUIRED(pos->lock_)
+{
+    int index = pos->history_head - pos->history_len + i;
+    if (index < 0) {
+        index += POSITION_HISTORY_LEN;
+    }
+    return &pos->history[index];
+}
+
+/**
+ * Returns the index of the latest sample taken at or before timestamp_us, or
+ * -1 if the history does not go back that far. Timestamps wrap around, so
+ * they are compared by their age relative to the newest sample, which
+ * decreases monotonically along the history.
+ */
+static int position_history_find(struct robot_position* pos, uint32_t timestamp_us) SHARED_LOCKS_REQUIRED(pos->lock_)
+{
+    if (pos->history_len == 0) {
+        return -1;
+    }
+
+    const int newest = pos->history_len - 1;
+    const uint32_t newest_us = position_history_at(pos, newest)->timestamp_us;
+
+    if ((int32_t)(timestamp_us - newest_us) >= 0) {
+        return newest;
+    }
+
+    const uint32_t age = newest_us - timestamp_us;
+    if (newest_us - position_history_at(pos, 0)->timestamp_us < age) {
+        return -1;
+    }
+
+    /* Last sample which is at least as old as the requested time */
+    int lo = 0, hi = newest;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (newest_us - position_history_at(pos, mid)->timestamp_us >= age) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    return lo;
+}
+
+void position_manage_at(struct robot_position* pos, uint32_t timestamp_us)
+{
+    absl::MutexLock l(&pos->lock_);
+    struct position_history_entry* entry;
+    struct rs_polar delta;
+
+    if (!position_update(pos, &delta)) {
+        return;
+    }
+
+    entry = &pos->history[pos->history_head];
+    entry->timestamp_us = timestamp_us;
+    entry->delta = delta;
+    entry->pos = pos->pos_d;
+
+    pos->history_head = (pos->history_head + 1) % POSITION_HISTORY_LEN;
+    if (pos->history_len < POSITION_HISTORY_LEN) {
+        pos->history_len++;
+    }
+}
+
+bool position_get_at(struct robot_position* pos, uint32_t timestamp_us, struct xya_position* res)
+{
+    absl::ReaderMutexLock l(&pos->lock_);
+    int i = position_history_find(pos, timestamp_us);
+
+    if (i < 0) {
+        return false;
+    }
+
+    const struct position_history_entry* before = position_history_at(pos, i);
+    *res = before->pos;
+
+    if (i == pos->history_len - 1) {
+        return true;
+    }
+
+    const struct position_history_entry* after = position_history_at(pos, i + 1);
+    double t = (double)(timestamp_us - before->timestamp_us) / (double)(after->timestamp_us - before->timestamp_us);
+
+    double da = after->pos.a - before->pos.a;
+    if (da < -M_PI) {
+        da += (M_PI * 2);
+    } else if (da > M_PI) {
+        da -= (M_PI * 2);
+    }
+
+    res->x += t * (after->pos.x - before->pos.x);
+    res->y += t * (after->pos.y - before->pos.y);
+    res->a += t * da;
+
+    if (res->a < -M_PI) {
+        res->a += (M_PI * 2);
+    } else if (res->a > M_PI) {
+        res->a -= (M_PI * 2);
+    }
+
+    return true;
+}
+
+bool position_correct_at(struct robot_position* pos, uint32_t timestamp_us, const struct xya_position* corrected)
+{
+    absl::MutexLock l(&pos->lock_);
+    int i = position_history_find(pos, timestamp_us);
+
+    if (i < 0) {
+        return false;
+    }
+
+    struct xya_position p = *corrected;
+    position_history_at(pos, i)->pos = p;
+
+    for (i++; i < pos->history_len; i++) {
+        struct position_history_entry* entry = position_history_at(pos, i);
+        position_integrate(pos, &p, entry->delta);
+        entry->pos = p;
+    }
+
+    position_store(pos, &p);
+    return true;
 }
 
 /**
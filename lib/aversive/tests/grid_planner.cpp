@@ -0,0 +1,223 @@
+#include <CppUTest/TestHarness.h>
+#include <math.h>
+#include <string.h>
+
+extern "C" {
+#include <aversive/grid_planner/grid_planner.h>
+}
+
+static poly_t square(point_t* pts, float x, float y, float half_size)
+{
+    pts[0] = {x - half_size, y - half_size};
+    pts[1] = {x + half_size, y - half_size};
+    pts[2] = {x + half_size, y + half_size};
+    pts[3] = {x - half_size, y + half_size};
+
+    poly_t poly;
+    poly.pts = pts;
+    poly.l = 4;
+    return poly;
+}
+
+TEST_GROUP (GridPlanner) {
+    struct grid_planner gp;
+    struct grid_planner_params params;
+    const bbox_t playground = {0, 0, 3000, 2000};
+
+    void setup(void)
+    {
+        params.resolution_mm = 20;
+        params.safety_margin_mm = 40;
+        params.clearance_mm = 200;
+        params.clearance_weight = 2;
+        params.max_dynamic_obstacles = 2;
+        params.max_checkpoints = 100;
+        CHECK_EQUAL(0, grid_planner_init(&gp, &params, playground));
+    }
+
+    void teardown(void)
+    {
+        grid_planner_deinit(&gp);
+    }
+
+    float min_clearance_along(point_t start, point_t* path, int len)
+    {
+        float min = INFINITY;
+        point_t prev = start;
+        for (int i = 0; i < len; i++) {
+            for (int j = 0; j <= 20; j++) {
+                point_t p;
+                p.x = prev.x + (path[i].x - prev.x) * j / 20.f;
+                p.y = prev.y + (path[i].y - prev.y) * j / 20.f;
+                min = fminf(min, grid_planner_clearance(&gp, p));
+            }
+            prev = path[i];
+        }
+        return min;
+    }
+};
+
+TEST(GridPlanner, FindsStraightPathWhenNoObstacle)
+{
+    point_t start = {500, 1000};
+    point_t end = {2500, 1000};
+    point_t* path;
+
+    CHECK_EQUAL(1, grid_planner_process(&gp, start, end));
+    CHECK_EQUAL(1, grid_planner_get_path(&gp, &path));
+    DOUBLES_EQUAL(end.x, path[0].x, 1e-3);
+    DOUBLES_EQUAL(end.y, path[0].y, 1e-3);
+}
+
+TEST(GridPlanner, AvoidsObstacleWithClearance)
+{
+    point_t pts[4];
+    poly_t obstacle = square(pts, 1500, 1000, 200);
+    point_t start = {500, 1000};
+    point_t end = {2500, 1000};
+    point_t* path;
+
+    grid_planner_add_static_poly(&gp, &obstacle);
+    grid_planner_update_distances(&gp);
+
+    int len = grid_planner_process(&gp, start, end);
+    CHECK_TRUE(len > 1);
+    grid_planner_get_path(&gp, &path);
+    DOUBLES_EQUAL(end.x, path[len - 1].x, 1e-3);
+    DOUBLES_EQUAL(end.y, path[len - 1].y, 1e-3);
+
+    /* Keeps more than the safety margin to the obstacle */
+    CHECK_TRUE(min_clearance_along(start, path, len) >= params.safety_margin_mm);
+}
+
+TEST(GridPlanner, IncrementalUpdateMatchesFullRecompute)
+{
+    point_t pts[4];
+    poly_t opponent;
+    int cells = gp.size_x * gp.size_y;
+
+    opponent = square(pts, 1000, 1000, 150);
+    grid_planner_set_dynamic_poly(&gp, 0, &opponent);
+    opponent = square(pts, 1100, 800, 150);
+    grid_planner_set_dynamic_poly(&gp, 0, &opponent);
+    opponent = square(pts, 2000, 500, 150);
+    grid_planner_set_dynamic_poly(&gp, 1, &opponent);
+    grid_planner_set_dynamic_poly(&gp, 1, NULL);
+
+    float* incremental = new float[cells];
+    memcpy(incremental, gp.distance, cells * sizeof(float));
+
+    grid_planner_update_distances(&gp);
+
+    for (int i = 0; i < cells; i++) {
+        DOUBLES_EQUAL(gp.distance[i], incremental[i], 1e-3);
+    }
+
+    delete[] incremental;
+}
+
+TEST(GridPlanner, RemovedObstacleFreesThePath)
+{
+    point_t pts[4];
+    poly_t wall = square(pts, 1500, 1000, 1200);
+    point_t start = {200, 1000};
+    point_t end = {2800, 1000};
+
+    grid_planner_set_dynamic_poly(&gp, 0, &wall);
+    CHECK_EQUAL(-2, grid_planner_process(&gp, start, end));
+
+    grid_planner_set_dynamic_poly(&gp, 0, NULL);
+    CHECK_EQUAL(1, grid_planner_process(&gp, start, end));
+}
+
+TEST(GridPlanner, SafetyMarginBlocksNarrowGaps)
+{
+    point_t pts_a[4], pts_b[4];
+    /* Two obstacles leaving a 60 mm gap, narrower than twice the margin */
+    poly_t a = square(pts_a, 1500, 600, 370);
+    poly_t b = square(pts_b, 1500, 1400, 370);
+    point_t start = {500, 1000};
+    point_t end = {2500, 1000};
+    point_t* path;
+
+    grid_planner_add_static_poly(&gp, &a);
+    grid_planner_add_static_poly(&gp, &b);
+    grid_planner_update_distances(&gp);
+
+    int len = grid_planner_process(&gp, start, end);
+    CHECK_TRUE(len > 0);
+    grid_planner_get_path(&gp, &path);
+
+    /* The path goes around the obstacles instead of through the gap */
+    bool goes_around = false;
+    for (int i = 0; i < len; i++) {
+        if (path[i].y < 230 || path[i].y > 1770) {
+            goes_around = true;
+        }
+    }
+    CHECK_TRUE(goes_around);
+    CHECK_TRUE(min_clearance_along(start, path, len) >= params.safety_margin_mm);
+}
+
+TEST(GridPlanner, CannotReachGoalInsideObstacle)
+{
+    point_t pts[4];
+    poly_t obstacle = square(pts, 1500, 1000, 200);
+
+    grid_planner_add_static_poly(&gp, &obstacle);
+    grid_planner_update_distances(&gp);
+
+    CHECK_EQUAL(-2, grid_planner_process(&gp, {500, 1000}, {1500, 1000}));
+}
+
+TEST(GridPlanner, FailsWhenPathIsTooLong)
+{
+    point_t pts[4];
+    poly_t obstacle = square(pts, 1500, 1000, 200);
+
+    grid_planner_deinit(&gp);
+    params.max_checkpoints = 1;
+    grid_planner_init(&gp, &params, playground);
+    grid_planner_add_static_poly(&gp, &obstacle);
+    grid_planner_update_distances(&gp);
+
+    CHECK_EQUAL(-1, grid_planner_process(&gp, {500, 1000}, {2500, 1000}));
+}
+
+TEST(GridPlanner, CopyPlansLikeTheOriginal)
+{
+    point_t pts[4];
+    poly_t opponent = square(pts, 1500, 1000, 200);
+    point_t start = {500, 1000};
+    point_t end = {2500, 1000};
+    struct grid_planner copy;
+    point_t *path, *copy_path;
+
+    grid_planner_set_dynamic_poly(&gp, 0, &opponent);
+
+    CHECK_EQUAL(0, grid_planner_init(&copy, &params, playground));
+    CHECK_EQUAL(0, grid_planner_copy(&copy, &gp));
+
+    int len = grid_planner_process(&gp, start, end);
+    CHECK_EQUAL(len, grid_planner_process(&copy, start, end));
+    grid_planner_get_path(&gp, &path);
+    grid_planner_get_path(&copy, &copy_path);
+    MEMCMP_EQUAL(path, copy_path, len * sizeof(point_t));
+
+    /* The copy is independent from the original */
+    grid_planner_set_dynamic_poly(&gp, 0, NULL);
+    CHECK_EQUAL(len, grid_planner_process(&copy, start, end));
+
+    grid_planner_deinit(&copy);
+}
+
+TEST(GridPlanner, CannotCopyToGridOfDifferentSize)
+{
+    struct grid_planner copy;
+    const bbox_t small = {0, 0, 1000, 1000};
+
+    CHECK_EQUAL(0, grid_planner_init(&copy, &params, small));
+    CHECK_EQUAL(-1, grid_planner_copy(&copy, &gp));
+
+    grid_planner_deinit(&copy);
+}
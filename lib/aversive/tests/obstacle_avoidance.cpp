@@ -12,9 +12,14 @@ TEST_GROUP (ObstacleAvoidance) {
     void setup(void)
     {
         polygon_set_boundingbox(0, 0, 3000, 3000);
-        oa_init(&oa);
+        CHECK_EQUAL(0, oa_init(&oa));
         oa_start_end_points(&oa, start.x, start.y, end.x, end.y);
     }
+
+    void teardown(void)
+    {
+        oa_deinit(&oa);
+    }
 };
 
 TEST(ObstacleAvoidance, FindsStraightPathWhenNoObstacle)
@@ -103,3 +108,168 @@ TEST(ObstacleAvoidance, FindsPathWithTwoOverlappingObstacles)
     CHECK_EQUAL(end.x, points[2].x);
     CHECK_EQUAL(end.y, points[2].y);
 }
+
+TEST_GROUP (ObstacleAvoidanceLimits) {
+    const point_t start = {.x = 1000, .y = 1000};
+    const point_t end = {.x = 2000, .y = 1000};
+    const struct oa_limits limits = {.max_polys = 2, .max_pts = 6, .max_rays = 50, .max_checkpoints = 10};
+    struct obstacle_avoidance oa;
+    void setup(void)
+    {
+        polygon_set_boundingbox(0, 0, 3000, 3000);
+        CHECK_EQUAL(0, oa_init_with_limits(&oa, &limits));
+        oa_start_end_points(&oa, start.x, start.y, end.x, end.y);
+    }
+
+    void teardown(void)
+    {
+        oa_deinit(&oa);
+    }
+
+    void add_obstacle(struct obstacle_avoidance* instance, poly_t* obstacle)
+    {
+        oa_poly_set_point(instance, obstacle, 1400, 900, 3);
+        oa_poly_set_point(instance, obstacle, 1400, 1300, 2);
+        oa_poly_set_point(instance, obstacle, 1600, 1300, 1);
+        oa_poly_set_point(instance, obstacle, 1600, 900, 0);
+    }
+};
+
+TEST(ObstacleAvoidanceLimits, CannotAddMorePolygonsThanLimit)
+{
+    CHECK_TRUE(oa_new_poly(&oa, 4) != NULL);
+    POINTERS_EQUAL(NULL, oa_new_poly(&oa, 1));
+}
+
+TEST(ObstacleAvoidanceLimits, CannotAddMorePointsThanLimit)
+{
+    POINTERS_EQUAL(NULL, oa_new_poly(&oa, 5));
+}
+
+TEST(ObstacleAvoidanceLimits, FailsWhenTooManyRays)
+{
+    struct obstacle_avoidance small;
+    const struct oa_limits small_limits = {.max_polys = 2, .max_pts = 6, .max_rays = 4, .max_checkpoints = 10};
+    oa_init_with_limits(&small, &small_limits);
+    oa_start_end_points(&small, start.x, start.y, end.x, end.y);
+    add_obstacle(&small, oa_new_poly(&small, 4));
+
+    CHECK_EQUAL(-3, oa_process(&small));
+
+    oa_deinit(&small);
+}
+
+TEST(ObstacleAvoidanceLimits, FailsWhenPathIsTooLong)
+{
+    struct obstacle_avoidance small;
+    const struct oa_limits small_limits = {.max_polys = 2, .max_pts = 6, .max_rays = 50, .max_checkpoints = 2};
+    oa_init_with_limits(&small, &small_limits);
+    oa_start_end_points(&small, start.x, start.y, end.x, end.y);
+    add_obstacle(&small, oa_new_poly(&small, 4));
+
+    CHECK_EQUAL(-1, oa_process(&small));
+
+    oa_deinit(&small);
+}
+
+TEST(ObstacleAvoidanceLimits, CanUseCallerProvidedArena)
+{
+    struct obstacle_avoidance other;
+    static uint64_t arena[1024];
+    CHECK_TRUE(oa_arena_size(&limits) <= sizeof(arena));
+    oa_init_arena(&other, &limits, arena);
+    oa_start_end_points(&other, start.x, start.y, end.x, end.y);
+
+    add_obstacle(&other, oa_new_poly(&other, 4));
+    oa_process(&other);
+    oa_process(&oa);
+
+    point_t* points;
+    CHECK_EQUAL(3, oa_get_path(&other, &points));
+    CHECK_EQUAL(1, oa_get_path(&oa, &points));
+
+    oa_deinit(&other);
+}
+
+TEST(ObstacleAvoidanceLimits, CopyRebasesPolygonsOnDestination)
+{
+    struct obstacle_avoidance copy;
+    CHECK_EQUAL(0, oa_init(&copy));
+    add_obstacle(&oa, oa_new_poly(&oa, 4));
+
+    CHECK_EQUAL(0, oa_copy(&copy, &oa));
+    oa_deinit(&oa);
+    oa_init_with_limits(&oa, &limits);
+
+    point_t* points;
+    oa_process(&copy);
+    CHECK_EQUAL(3, oa_get_path(&copy, &points));
+    CHECK_EQUAL(end.x, points[2].x);
+
+    oa_deinit(&copy);
+}
+
+TEST(ObstacleAvoidanceLimits, CopyFailsIfDestinationIsTooSmall)
+{
+    struct obstacle_avoidance small;
+    const struct oa_limits small_limits = {.max_polys = 1, .max_pts = 2, .max_rays = 10, .max_checkpoints = 10};
+    oa_init_with_limits(&small, &small_limits);
+    add_obstacle(&oa, oa_new_poly(&oa, 4));
+
+    CHECK_EQUAL(-1, oa_copy(&small, &oa));
+
+    oa_deinit(&small);
+}
+
+TEST_GROUP (ObstacleAvoidanceInstances) {
+    const point_t start = {.x = 1000, .y = 1000};
+    const point_t end = {.x = 2000, .y = 1000};
+    struct obstacle_avoidance a, b;
+
+    void setup(void)
+    {
+        /* The global bounding box excludes everything */
+        polygon_set_boundingbox(0, 0, 10, 10);
+        CHECK_EQUAL(0, oa_init(&a));
+        CHECK_EQUAL(0, oa_init(&b));
+        oa_set_boundingbox(&a, 0, 0, 3000, 3000);
+        oa_set_boundingbox(&b, 0, 0, 3000, 3000);
+        oa_start_end_points(&a, start.x, start.y, end.x, end.y);
+        oa_start_end_points(&b, start.x, start.y, end.x, end.y);
+    }
+
+    void teardown(void)
+    {
+        oa_deinit(&a);
+        oa_deinit(&b);
+    }
+};
+
+TEST(ObstacleAvoidanceInstances, UsesItsOwnBoundingBox)
+{
+    point_t* points;
+
+    oa_process(&a);
+
+    CHECK_EQUAL(1, oa_get_path(&a, &points));
+    CHECK_EQUAL(end.x, points[0].x);
+}
+
+TEST(ObstacleAvoidanceInstances, InstancesAreIndependent)
+{
+    point_t* points;
+    auto obstacle = oa_new_poly(&a, 4);
+    oa_poly_set_point(&a, obstacle, 1400, 900, 3);
+    oa_poly_set_point(&a, obstacle, 1400, 1300, 2);
+    oa_poly_set_point(&a, obstacle, 1600, 1300, 1);
+    oa_poly_set_point(&a, obstacle, 1600, 900, 0);
+
+    /* Restrict b's playground so that its goal is unreachable */
+    oa_set_boundingbox(&b, 0, 0, 1500, 3000);
+
+    oa_process(&a);
+    oa_process(&b);
+
+    CHECK_EQUAL(3, oa_get_path(&a, &points));
+    CHECK_TRUE(oa_get_path(&b, &points) < 0);
+}
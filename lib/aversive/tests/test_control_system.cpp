@@ -0,0 +1,128 @@
+#include <CppUTest/TestHarness.h>
+
+#include <aversive/control_system_manager/control_system.hpp>
+
+namespace {
+int32_t process_output;
+int32_t process_input;
+
+int32_t ramp(void* params, int32_t value)
+{
+    return value / *(int32_t*)params;
+}
+
+int32_t gain(void* params, int32_t value)
+{
+    return value * *(int32_t*)params;
+}
+
+int32_t offset(void* params, int32_t value)
+{
+    return value + *(int32_t*)params;
+}
+
+int32_t read_process(void* params)
+{
+    (void)params;
+    return process_output;
+}
+
+void write_process(void* params, int32_t value)
+{
+    (void)params;
+    process_input = value;
+}
+} // namespace
+
+TEST_GROUP (AControlSystemPipeline) {
+    int32_t ramp_divider = 2, pid_gain = 3, feedback_offset = 5, output_offset = -1;
+
+    struct cs c_cs, pipeline_cs;
+
+    using Pipeline = control_system::Pipeline<control_system::Filter<ramp>,
+                                              control_system::Filter<offset>,
+                                              control_system::Filter<gain>,
+                                              control_system::Filter<offset>,
+                                              control_system::ProcessOut<read_process>,
+                                              control_system::ProcessIn<write_process>>;
+
+    Pipeline pipeline{{&ramp_divider}, {&feedback_offset}, {&pid_gain}, {&output_offset}, {nullptr}, {nullptr}};
+
+    void setup() override
+    {
+        cs_init(&c_cs);
+        cs_set_consign_filter(&c_cs, ramp, &ramp_divider);
+        cs_set_feedback_filter(&c_cs, offset, &feedback_offset);
+        cs_set_correct_filter(&c_cs, gain, &pid_gain);
+        cs_set_output_filter(&c_cs, offset, &output_offset);
+        cs_set_process_out(&c_cs, read_process, nullptr);
+        cs_set_process_in(&c_cs, write_process, nullptr);
+
+        cs_init(&pipeline_cs);
+
+        process_output = 10;
+        process_input = 0;
+    }
+
+    void check_same_state()
+    {
+        CHECK_EQUAL(cs_get_consign(&c_cs), cs_get_consign(&pipeline_cs));
+        CHECK_EQUAL(cs_get_filtered_consign(&c_cs), cs_get_filtered_consign(&pipeline_cs));
+        CHECK_EQUAL(cs_get_filtered_feedback(&c_cs), cs_get_filtered_feedback(&pipeline_cs));
+        CHECK_EQUAL(cs_get_error(&c_cs), cs_get_error(&pipeline_cs));
+        CHECK_EQUAL(cs_get_out(&c_cs), cs_get_out(&pipeline_cs));
+    }
+};
+
+TEST(AControlSystemPipeline, computesSameValuesAsCApi)
+{
+    int32_t c_out = cs_do_process(&c_cs, 100);
+    int32_t c_input = process_input;
+
+    int32_t pipeline_out = pipeline.do_process(&pipeline_cs, 100);
+
+    /* (100 / 2 - (10 + 5)) * 3 - 1 */
+    CHECK_EQUAL(104, pipeline_out);
+    CHECK_EQUAL(c_out, pipeline_out);
+    CHECK_EQUAL(c_input, process_input);
+    check_same_state();
+}
+
+TEST(AControlSystemPipeline, manageUsesConsignSetThroughCApi)
+{
+    cs_set_consign(&c_cs, 40);
+    cs_set_consign(&pipeline_cs, 40);
+
+    cs_manage(&c_cs);
+    pipeline.manage(&pipeline_cs);
+
+    check_same_state();
+}
+
+TEST(AControlSystemPipeline, outputsZeroWhenDisabled)
+{
+    cs_disable(&pipeline_cs);
+    process_input = 42;
+
+    CHECK_EQUAL(0, pipeline.do_process(&pipeline_cs, 100));
+    CHECK_EQUAL(0, process_input);
+}
+
+TEST(AControlSystemPipeline, identityStagesBehaveAsUnsetCallbacks)
+{
+    control_system::Pipeline<control_system::Identity,
+                             control_system::Identity,
+                             control_system::Identity,
+                             control_system::Identity,
+                             control_system::ProcessOut<read_process>,
+                             control_system::ProcessIn<write_process>>
+        bare{{}, {}, {}, {}, {nullptr}, {nullptr}};
+
+    struct cs c_bare;
+    cs_init(&c_bare);
+    cs_set_process_out(&c_bare, read_process, nullptr);
+    cs_set_process_in(&c_bare, write_process, nullptr);
+
+    CHECK_EQUAL(cs_do_process(&c_bare, 25), bare.do_process(&pipeline_cs, 25));
+    CHECK_EQUAL(15, process_input);
+}
@@ -130,8 +130,24 @@ TEST(RayCastingTestGroup, CanCastRays)
     startstop[0] = {-10, 0};
     startstop[1] = {10, 0};
 
-    int rays[128];
-    auto ray_count = calc_rays(polygons, 2, rays);
+    int rays[64];
+    auto ray_count = calc_rays(polygons, 2, rays, 32);
 
     CHECK_EQUAL(8 * 4, ray_count);
 }
+
+TEST(RayCastingTestGroup, FailsWhenTooManyRays)
+{
+    obstacle[0] = {-5, -5};
+    obstacle[1] = {5, -5};
+    obstacle[2] = {5, 5};
+    obstacle[3] = {-5, 5};
+
+    startstop[0] = {-10, 0};
+    startstop[1] = {10, 0};
+
+    int rays[14 * 2]; // room for 7 of the 8 rays
+    auto ray_count = calc_rays(polygons, 2, rays, 14);
+
+    CHECK_EQUAL(-1, ray_count);
+}
@@ -0,0 +1,214 @@
+#include <CppUTest/TestHarness.h>
+#include <math.h>
+
+#include <aversive/position_manager/position_manager.h>
+
+extern "C" {
+#include <aversive/robot_system/robot_system.h>
+}
+
+namespace {
+int32_t left_encoder, right_encoder;
+
+int32_t get_left_encoder(void* params)
+{
+    (void)params;
+    return left_encoder;
+}
+
+int32_t get_right_encoder(void* params)
+{
+    (void)params;
+    return right_encoder;
+}
+} // namespace
+
+TEST_GROUP (APositionHistory) {
+    struct robot_system rs;
+    struct robot_position pos{};
+    const uint32_t period_us = 10000;
+
+    void setup() override
+    {
+        left_encoder = 0;
+        right_encoder = 0;
+
+        rs_init(&rs);
+        rs_set_ratio(&rs, 1.);
+        rs_set_flags(&rs, RS_USE_EXT);
+        rs_set_left_ext_encoder(&rs, get_left_encoder, nullptr, 1.);
+        rs_set_right_ext_encoder(&rs, get_right_encoder, nullptr, 1.);
+
+        position_init(&pos);
+        position_set_related_robot_system(&pos, &rs);
+        position_set_physical_params(&pos, 100., 1.);
+        position_use_ext(&pos);
+    }
+
+    /* Moves the wheels by the given number of mm, then runs the odometry */
+    void step(uint32_t timestamp_us, int32_t left_mm, int32_t right_mm)
+    {
+        left_encoder += left_mm;
+        right_encoder += right_mm;
+        rs_update(&rs);
+        position_manage_at(&pos, timestamp_us);
+    }
+
+    void drive_straight(uint32_t start_us, int n)
+    {
+        for (int i = 0; i < n; i++) {
+            step(start_us + i * period_us, 10, 10);
+        }
+    }
+};
+
+TEST(APositionHistory, interpolatesBetweenSamples)
+{
+    drive_straight(0, 10);
+
+    struct xya_position p;
+    CHECK_TRUE(position_get_at(&pos, 25000, &p));
+
+    DOUBLES_EQUAL(35, p.x, 1e-9);
+    DOUBLES_EQUAL(0, p.y, 1e-9);
+}
+
+TEST(APositionHistory, returnsExactSamples)
+{
+    drive_straight(0, 10);
+
+    struct xya_position p;
+    CHECK_TRUE(position_get_at(&pos, 0, &p));
+    DOUBLES_EQUAL(10, p.x, 1e-9);
+
+    CHECK_TRUE(position_get_at(&pos, 90000, &p));
+    DOUBLES_EQUAL(100, p.x, 1e-9);
+}
+
+TEST(APositionHistory, returnsLatestPositionForFutureTime)
+{
+    drive_straight(0, 10);
+
+    struct xya_position p;
+    CHECK_TRUE(position_get_at(&pos, 200000, &p));
+
+    DOUBLES_EQUAL(100, p.x, 1e-9);
+}
+
+TEST(APositionHistory, forgetsOldestSamples)
+{
+    drive_straight(0, POSITION_HISTORY_LEN + 10);
+
+    struct xya_position p;
+    CHECK_FALSE(position_get_at(&pos, 5 * period_us, &p));
+    CHECK_TRUE(position_get_at(&pos, 10 * period_us, &p));
+
+    DOUBLES_EQUAL(110, p.x, 1e-9);
+}
+
+TEST(APositionHistory, isEmptyAtStart)
+{
+    struct xya_position p;
+    CHECK_FALSE(position_get_at(&pos, 0, &p));
+}
+
+TEST(APositionHistory, handlesTimestampWrapAround)
+{
+    drive_straight(0u - 2 * period_us, 5);
+
+    struct xya_position p;
+    CHECK_TRUE(position_get_at(&pos, 0u - period_us - period_us / 2, &p));
+    DOUBLES_EQUAL(15, p.x, 1e-9);
+
+    CHECK_TRUE(position_get_at(&pos, period_us / 2, &p));
+    DOUBLES_EQUAL(35, p.x, 1e-9);
+}
+
+TEST(APositionHistory, interpolatesAngleAcrossPi)
+{
+    const double step_angle = 2. / 100.;
+    position_set(&pos, 0, 0, 178.5);
+
+    step(0, -1, 1);
+    step(period_us, -1, 1);
+
+    struct xya_position p;
+    CHECK_TRUE(position_get_at(&pos, period_us / 2, &p));
+
+    DOUBLES_EQUAL(178.5 * M_PI / 180 + 1.5 * step_angle - 2 * M_PI, p.a, 1e-9);
+}
+
+TEST(APositionHistory, setPositionClearsHistory)
+{
+    drive_straight(0, 10);
+    position_set(&pos, 0, 0, 0);
+
+    struct xya_position p;
+    CHECK_FALSE(position_get_at(&pos, 50000, &p));
+}
+
+TEST(APositionHistory, correctionIsReplayedToCurrentPosition)
+{
+    drive_straight(0, 10);
+
+    /* At 30 ms we were at x = 40, but 50 mm off on y */
+    struct xya_position corrected = {40, 50, 0};
+    CHECK_TRUE(position_correct_at(&pos, 30000, &corrected));
+
+    DOUBLES_EQUAL(100, position_get_x_double(&pos), 1e-9);
+    DOUBLES_EQUAL(50, position_get_y_double(&pos), 1e-9);
+    CHECK_EQUAL(50, position_get_y_s16(&pos));
+
+    /* The samples in between are corrected as well */
+    struct xya_position p;
+    CHECK_TRUE(position_get_at(&pos, 60000, &p));
+    DOUBLES_EQUAL(70, p.x, 1e-9);
+    DOUBLES_EQUAL(50, p.y, 1e-9);
+}
+
+TEST(APositionHistory, correctedHeadingChangesReplayedMotion)
+{
+    drive_straight(0, 10);
+
+    /* We were actually heading along y since 30 ms */
+    struct xya_position corrected = {40, 0, M_PI / 2};
+    CHECK_TRUE(position_correct_at(&pos, 30000, &corrected));
+
+    DOUBLES_EQUAL(40, position_get_x_double(&pos), 1e-9);
+    DOUBLES_EQUAL(60, position_get_y_double(&pos), 1e-9);
+    DOUBLES_EQUAL(M_PI / 2, position_get_a_rad_double(&pos), 1e-9);
+}
+
+TEST(APositionHistory, correctionUsesSampleBeforeMeasurement)
+{
+    drive_straight(0, 10);
+
+    struct xya_position corrected = {40, 50, 0};
+    CHECK_TRUE(position_correct_at(&pos, 35000, &corrected));
+
+    DOUBLES_EQUAL(100, position_get_x_double(&pos), 1e-9);
+    DOUBLES_EQUAL(50, position_get_y_double(&pos), 1e-9);
+}
+
+TEST(APositionHistory, tooOldCorrectionIsIgnored)
+{
+    drive_straight(period_us, 10);
+
+    struct xya_position corrected = {0, 50, 0};
+    CHECK_FALSE(position_correct_at(&pos, 0, &corrected));
+
+    DOUBLES_EQUAL(100, position_get_x_double(&pos), 1e-9);
+    DOUBLES_EQUAL(0, position_get_y_double(&pos), 1e-9);
+}
+
+TEST(APositionHistory, odometryContinuesFromCorrectedPosition)
+{
+    drive_straight(0, 10);
+
+    struct xya_position corrected = {40, 50, 0};
+    position_correct_at(&pos, 30000, &corrected);
+    step(10 * period_us, 10, 10);
+
+    DOUBLES_EQUAL(110, position_get_x_double(&pos), 1e-9);
+    DOUBLES_EQUAL(50, position_get_y_double(&pos), 1e-9);
+}
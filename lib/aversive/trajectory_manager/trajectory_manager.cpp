@@ -51,6 +51,12 @@ void trajectory_set_cs(struct trajectory* traj, struct cs* cs_d, struct cs* cs_a
     traj->csm_angle = cs_a;
 }
 
+/** structure initialization */
+void trajectory_set_cs_lock(struct trajectory* traj, absl::Mutex* lock)
+{
+    traj->cs_lock = lock;
+}
+
 /** structure initialization */
 void trajectory_set_robot_params(struct trajectory* traj,
                                  struct robot_system* rs,
@@ -63,6 +69,7 @@ void trajectory_set_robot_params(struct trajectory* traj,
 /** set speed consign */
 void trajectory_set_speed(struct trajectory* traj, double d_speed, double a_speed)
 {
+    absl::MutexLock l(&traj->lock_);
     traj->d_speed = d_speed;
     traj->a_speed = a_speed;
 }
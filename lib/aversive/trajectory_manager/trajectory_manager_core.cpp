@@ -101,6 +101,7 @@ void __trajectory_goto_d_a_rel(struct trajectory* traj, double d_mm, double a_ra
 void trajectory_d_rel(struct trajectory* traj, double d_mm)
 {
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     absl::MutexLock lp(&traj->position->lock_);
     __trajectory_goto_d_a_rel(traj, d_mm, 0, RUNNING_D,
                               UPDATE_D | UPDATE_A | RESET_A);
@@ -109,6 +110,7 @@ void trajectory_d_rel(struct trajectory* traj, double d_mm)
 void trajectory_only_d_rel(struct trajectory* traj, double d_mm)
 {
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     absl::MutexLock lp(&traj->position->lock_);
     __trajectory_goto_d_a_rel(traj, d_mm, 0, RUNNING_D, UPDATE_D);
 }
@@ -116,6 +118,7 @@ void trajectory_only_d_rel(struct trajectory* traj, double d_mm)
 void trajectory_a_rel(struct trajectory* traj, double a_deg_rel)
 {
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     absl::MutexLock lp(&traj->position->lock_);
     __trajectory_goto_d_a_rel(traj, 0, RAD(a_deg_rel), RUNNING_A,
                               UPDATE_A | UPDATE_D | RESET_D);
@@ -124,6 +127,7 @@ void trajectory_a_rel(struct trajectory* traj, double a_deg_rel)
 void trajectory_a_abs(struct trajectory* traj, double a_deg_abs)
 {
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     absl::MutexLock lp(&traj->position->lock_);
     double posa = position_get_a_rad_double_unsafe(traj->position);
     double a;
@@ -137,6 +141,7 @@ void trajectory_a_abs(struct trajectory* traj, double a_deg_abs)
 void trajectory_turnto_xy(struct trajectory* traj, double x_abs_mm, double y_abs_mm)
 {
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     absl::MutexLock lp(&traj->position->lock_);
     double posx = position_get_x_double_unsafe(traj->position);
     double posy = position_get_y_double_unsafe(traj->position);
@@ -152,6 +157,7 @@ void trajectory_turnto_xy(struct trajectory* traj, double x_abs_mm, double y_abs
 void trajectory_turnto_xy_behind(struct trajectory* traj, double x_abs_mm, double y_abs_mm)
 {
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     absl::MutexLock lp(&traj->position->lock_);
     double posx = position_get_x_double_unsafe(traj->position);
     double posy = position_get_y_double_unsafe(traj->position);
@@ -167,6 +173,7 @@ void trajectory_turnto_xy_behind(struct trajectory* traj, double x_abs_mm, doubl
 void trajectory_only_a_rel(struct trajectory* traj, double a_deg)
 {
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     absl::MutexLock lp(&traj->position->lock_);
     __trajectory_goto_d_a_rel(traj, 0, RAD(a_deg), RUNNING_A,
                               UPDATE_A);
@@ -175,6 +182,7 @@ void trajectory_only_a_rel(struct trajectory* traj, double a_deg)
 void trajectory_only_a_abs(struct trajectory* traj, double a_deg_abs)
 {
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     absl::MutexLock lp(&traj->position->lock_);
     double posa = position_get_a_rad_double_unsafe(traj->position);
     double a;
@@ -187,6 +195,7 @@ void trajectory_only_a_abs(struct trajectory* traj, double a_deg_abs)
 void trajectory_d_a_rel(struct trajectory* traj, double d_mm, double a_deg)
 {
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     absl::MutexLock lp(&traj->position->lock_);
     __trajectory_goto_d_a_rel(traj, d_mm, RAD(a_deg),
                               RUNNING_AD, UPDATE_A | UPDATE_D);
@@ -196,6 +205,7 @@ void trajectory_stop(struct trajectory* traj)
 {
     DEBUG("stop");
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     absl::MutexLock lp(&traj->position->lock_);
     __trajectory_goto_d_a_rel(traj, 0, 0, READY,
                               UPDATE_A | UPDATE_D | RESET_D | RESET_A);
@@ -208,6 +218,7 @@ void trajectory_hardstop(struct trajectory* traj)
     DEBUG("hardstop");
 
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     absl::MutexLock lp(&traj->position->lock_);
 
     q_d = reinterpret_cast<struct quadramp_filter*>(traj->csm_distance->consign_filter_params);
@@ -225,6 +236,7 @@ void trajectory_goto_xy_abs(struct trajectory* traj, double x, double y)
 {
     DEBUG("Goto XY");
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     delete_event(traj);
     traj->target.cart.x = x;
     traj->target.cart.y = y;
@@ -237,6 +249,7 @@ void trajectory_goto_forward_xy_abs(struct trajectory* traj, double x, double y)
     DEBUG("Goto XY_F");
 
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     delete_event(traj);
     traj->target.cart.x = x;
     traj->target.cart.y = y;
@@ -248,6 +261,7 @@ void trajectory_goto_backward_xy_abs(struct trajectory* traj, double x, double y
 {
     DEBUG("Goto XY_B");
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     delete_event(traj);
     traj->target.cart.x = x;
     traj->target.cart.y = y;
@@ -260,6 +274,7 @@ void trajectory_goto_d_a_rel(struct trajectory* traj, double d, double a)
     DEBUG("Goto DA rel");
 
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     vect2_pol p;
     double x = position_get_x_double(traj->position);
     double y = position_get_y_double(traj->position);
@@ -278,6 +293,7 @@ void trajectory_goto_d_a_rel(struct trajectory* traj, double d, double a)
 void trajectory_goto_xy_rel(struct trajectory* traj, double x_rel_mm, double y_rel_mm)
 {
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     vect2_cart c;
     vect2_pol p;
     double x = position_get_x_double(traj->position);
@@ -308,6 +324,7 @@ uint8_t trajectory_angle_finished(struct trajectory* traj)
 uint8_t trajectory_distance_finished(struct trajectory* traj)
 {
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     if (traj->state == RUNNING_CLITOID_CURVE) {
         return 1;
     }
@@ -332,6 +349,7 @@ uint8_t trajectory_nearly_finished(struct trajectory* traj)
 uint8_t trajectory_in_window(struct trajectory* traj, double d_win, double a_win_rad)
 {
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     absl::MutexLock lp(&traj->position->lock_);
     switch (traj->state) {
         case RUNNING_XY_ANGLE_OK:
@@ -652,6 +670,7 @@ static void trajectory_manager_line_event(struct trajectory* traj) EXCLUSIVE_LOC
 void trajectory_manager_manage(struct trajectory* traj)
 {
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     absl::ReaderMutexLock lp(&traj->position->lock_);
     if (traj->scheduled) {
         switch (traj->state) {
@@ -695,6 +714,7 @@ void trajectory_circle_rel(struct trajectory* traj,
                            uint8_t flags)
 {
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     absl::ReaderMutexLock lp(&traj->position->lock_);
     double dst_angle,
         dst_distance;
@@ -771,6 +791,7 @@ void trajectory_line_abs(struct trajectory* traj,
                          double advance)
 {
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     delete_event(traj);
     __trajectory_line_abs(traj, x1, y1, x2, y2, advance);
     traj->state = RUNNING_LINE;
@@ -1008,6 +1029,7 @@ int8_t trajectory_clitoid(struct trajectory* traj,
                           double d_inter_mm)
 {
     absl::MutexLock l(&traj->lock_);
+    absl::MutexLockMaybe cs_l(traj->cs_lock);
     double remain = 0, Aa = 0, Va = 0, Vd;
     double turnx, turny;
     double a_rad = RAD(a_deg);
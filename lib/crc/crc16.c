@@ -4,20 +4,33 @@
 
 #define CRC16_POLYNOMIAL 0xA001 // bit reversed 0x8005
 
+/* See crc32.c, the tables take 4 kB here, 512 bytes with CRC_SMALL_TABLES. */
+#ifdef CRC_SMALL_TABLES
+#define CRC_TABLES 1
+#else
+#define CRC_TABLES 8
+#endif
+
+#include "crc16_table.h"
+
 uint16_t crc16(uint16_t init, const void* data, size_t length)
 {
-    uint8_t* p = (uint8_t*)data;
+    const uint8_t* p = (const uint8_t*)data;
     uint16_t crc = init;
+
+#if CRC_TABLES == 8
+    while (length >= 8) {
+        crc = crc16_table[7][(crc ^ p[0]) & 0xff] ^ crc16_table[6][(crc >> 8) ^ p[1]]
+            ^ crc16_table[5][p[2]] ^ crc16_table[4][p[3]]
+            ^ crc16_table[3][p[4]] ^ crc16_table[2][p[5]]
+            ^ crc16_table[1][p[6]] ^ crc16_table[0][p[7]];
+        p += 8;
+        length -= 8;
+    }
+#endif
+
     while (length--) {
-        int i;
-        crc ^= *p++;
-        for (i = 0; i < 8; i++) {
-            if (crc & 1) {
-                crc = (crc >> 1) ^ CRC16_POLYNOMIAL;
-            } else {
-                crc = crc >> 1;
-            }
-        }
+        crc = crc16_table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
     }
     return crc;
 }
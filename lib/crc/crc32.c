@@ -4,20 +4,184 @@
 
 #define CRC32_POLYNOMIAL 0xEDB88320 // bit reversed 0x04C11DB7
 
+/* Slicing-by-8 processes 8 bytes per step using 8 tables, which take 8 kB.
+ * Define CRC_SMALL_TABLES to only keep the first one (1 kB) and process a
+ * byte per step instead. */
+#ifdef CRC_SMALL_TABLES
+#define CRC_TABLES 1
+#else
+#define CRC_TABLES 8
+#endif
+
+#include "crc32_table.h"
+
+/* Carry-less multiplication (PCLMULQDQ) on x86, CRC32 instructions on ARMv8.
+ * Both are checked at runtime, the tables are used otherwise. */
+#if defined(__x86_64__) && defined(__GNUC__)
+#define CRC32_HW_X86
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__linux__) && defined(__GNUC__)
+#define CRC32_HW_ARM
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+/* Each function below works on the CRC register, not inverted. */
+
+static uint32_t crc32_bytes(uint32_t crc, const uint8_t* p, size_t length)
+{
+    while (length--) {
+        crc = crc32_table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+static uint32_t crc32_tables(uint32_t crc, const uint8_t* p, size_t length)
+{
+#if CRC_TABLES == 8
+    while (length >= 8) {
+        uint32_t lo = crc ^ (p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24);
+        uint32_t hi = p[4] | p[5] << 8 | p[6] << 16 | (uint32_t)p[7] << 24;
+
+        crc = crc32_table[7][lo & 0xff] ^ crc32_table[6][(lo >> 8) & 0xff]
+            ^ crc32_table[5][(lo >> 16) & 0xff] ^ crc32_table[4][lo >> 24]
+            ^ crc32_table[3][hi & 0xff] ^ crc32_table[2][(hi >> 8) & 0xff]
+            ^ crc32_table[1][(hi >> 16) & 0xff] ^ crc32_table[0][hi >> 24];
+
+        p += 8;
+        length -= 8;
+    }
+#endif
+    return crc32_bytes(crc, p, length);
+}
+
+#ifdef CRC32_HW_X86
+/* Folds 64 bytes at a time with carry-less multiplications, then reduces the
+ * result with a Barrett reduction, as described in "Fast CRC Computation for
+ * Generic Polynomials Using PCLMULQDQ Instruction" (Intel, 2009). The
+ * constants are those of the paper for the bit reflected polynomial.
+ * length must be a multiple of 16, and at least 64. */
+__attribute__((target("pclmul,sse4.1"))) static uint32_t crc32_pclmul(uint32_t crc, const uint8_t* p, size_t length)
+{
+    const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+    const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+    const __m128i k5k0 = _mm_set_epi64x(0, 0x0163cd6124);
+    const __m128i poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+    __m128i x1, x2, x3, x4, x5, x6, x7, x8;
+
+    x1 = _mm_loadu_si128((const __m128i*)(p + 0x00));
+    x2 = _mm_loadu_si128((const __m128i*)(p + 0x10));
+    x3 = _mm_loadu_si128((const __m128i*)(p + 0x20));
+    x4 = _mm_loadu_si128((const __m128i*)(p + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(crc));
+    p += 64;
+    length -= 64;
+
+    /* Fold four blocks of 16 bytes in parallel. */
+    while (length >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+
+        x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i*)(p + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i*)(p + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i*)(p + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i*)(p + 0x30)));
+
+        p += 64;
+        length -= 64;
+    }
+
+    /* Fold them into a single one, then fold the remaining blocks. */
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    while (length >= 16) {
+        x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128((const __m128i*)p)), x5);
+        p += 16;
+        length -= 16;
+    }
+
+    /* Fold 128 bits to 64 bits. */
+    x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, mask32);
+    x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    /* Barrett reduction to 32 bits. */
+    x2 = _mm_and_si128(x1, mask32);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+    x2 = _mm_and_si128(x2, mask32);
+    x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return _mm_extract_epi32(x1, 1);
+}
+
+static uint32_t crc32_hw(uint32_t crc, const uint8_t* p, size_t length)
+{
+    if (length >= 64 && __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1")) {
+        size_t blocks = length & ~(size_t)15;
+        crc = crc32_pclmul(crc, p, blocks);
+        p += blocks;
+        length -= blocks;
+    }
+    return crc32_tables(crc, p, length);
+}
+#endif
+
+#ifdef CRC32_HW_ARM
+__attribute__((target("+crc"))) static uint32_t crc32_armv8(uint32_t crc, const uint8_t* p, size_t length)
+{
+    while (length >= 8) {
+        uint64_t data;
+        __builtin_memcpy(&data, p, sizeof(data));
+        crc = __crc32d(crc, data);
+        p += 8;
+        length -= 8;
+    }
+    while (length--) {
+        crc = __crc32b(crc, *p++);
+    }
+    return crc;
+}
+
+static uint32_t crc32_hw(uint32_t crc, const uint8_t* p, size_t length)
+{
+    if (getauxval(AT_HWCAP) & HWCAP_CRC32) {
+        return crc32_armv8(crc, p, length);
+    }
+    return crc32_tables(crc, p, length);
+}
+#endif
+
 uint32_t crc32(uint32_t init, const void* data, size_t length)
 {
-    uint8_t* p = (uint8_t*)data;
-    uint32_t crc = ~init;
-    size_t i;
-    for (i = 0; i < length; i++) {
-        int bit;
-        for (bit = 0; bit < 8; bit++) {
-            if ((crc & 1) != ((p[i] >> bit) & 1)) {
-                crc = (crc >> 1) ^ CRC32_POLYNOMIAL;
-            } else {
-                crc = crc >> 1;
-            }
-        }
-    }
-    return ~crc;
+#if defined(CRC32_HW_X86) || defined(CRC32_HW_ARM)
+    return ~crc32_hw(~init, (const uint8_t*)data, length);
+#else
+    return ~crc32_tables(~init, (const uint8_t*)data, length);
+#endif
 }
@@ -29,3 +29,35 @@ TEST(CRC16TestGroup, TestZero)
     crc = crc16(crc, crc_buf, sizeof(crc_buf));
     CHECK_EQUAL(0, crc);
 }
+
+/* Previous implementation, processing a bit at a time */
+static uint16_t crc16_bitwise(uint16_t init, const void* data, size_t length)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    uint16_t crc = init;
+    while (length--) {
+        crc ^= *p++;
+        for (int i = 0; i < 8; i++) {
+            if (crc & 1) {
+                crc = (crc >> 1) ^ 0xA001;
+            } else {
+                crc = crc >> 1;
+            }
+        }
+    }
+    return crc;
+}
+
+TEST(CRC16TestGroup, SameAsBitwiseImplementation)
+{
+    uint8_t data[100];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (i * 7919) >> 3;
+    }
+
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t len = 0; len < sizeof(data) - offset; len++) {
+            CHECK_EQUAL(crc16_bitwise(0xbeef, &data[offset], len), crc16(0xbeef, &data[offset], len));
+        }
+    }
+}
@@ -34,3 +34,38 @@ TEST(CRC32TestGroup, TestZero)
     crc = crc32(crc, crc_buf, sizeof(crc_buf));
     CHECK_EQUAL(0, ~crc);
 }
+
+/* Previous implementation, processing a bit at a time */
+static uint32_t crc32_bitwise(uint32_t init, const void* data, size_t length)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    uint32_t crc = ~init;
+    for (size_t i = 0; i < length; i++) {
+        for (int bit = 0; bit < 8; bit++) {
+            if ((crc & 1) != ((p[i] >> bit) & 1)) {
+                crc = (crc >> 1) ^ 0xEDB88320;
+            } else {
+                crc = crc >> 1;
+            }
+        }
+    }
+    return ~crc;
+}
+
+TEST(CRC32TestGroup, SameAsBitwiseImplementation)
+{
+    uint8_t data[600];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (i * 7919) >> 3;
+    }
+
+    // Lengths and alignments covering the 8 bytes steps, the 64 bytes blocks
+    // of the hardware implementation and their remainders.
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t len = 0; len < sizeof(data) - offset; len += (len < 160) ? 1 : 37) {
+            CHECK_EQUAL(crc32_bitwise(0, &data[offset], len), crc32(0, &data[offset], len));
+            CHECK_EQUAL(crc32_bitwise(0xdeadbeef, &data[offset], len),
+                        crc32(0xdeadbeef, &data[offset], len));
+        }
+    }
+}
@@ -0,0 +1,162 @@
+#include <string.h>
+
+#include <filter/iir_bank.h>
+
+/* Same transposed direct form II as filter_iir_apply(), for each channel:
+ *
+ * y[k] = b0*x[k] + d0
+ * d(i) = b(i+1)*x[k] - a(i)*y[k] + d(i+1)
+ *
+ * Groups of VEC_WIDTH consecutive channels are filtered together, the
+ * remaining ones one by one. */
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#define VEC_WIDTH 4
+typedef __m128 vec_t;
+#define vec_load(p) _mm_loadu_ps(p)
+#define vec_store(p, v) _mm_storeu_ps(p, v)
+#define vec_set1(x) _mm_set1_ps(x)
+#define vec_add(x, y) _mm_add_ps(x, y)
+#define vec_sub(x, y) _mm_sub_ps(x, y)
+#define vec_mul(x, y) _mm_mul_ps(x, y)
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define VEC_WIDTH 4
+typedef float32x4_t vec_t;
+#define vec_load(p) vld1q_f32(p)
+#define vec_store(p, v) vst1q_f32(p, v)
+#define vec_set1(x) vdupq_n_f32(x)
+#define vec_add(x, y) vaddq_f32(x, y)
+#define vec_sub(x, y) vsubq_f32(x, y)
+#define vec_mul(x, y) vmulq_f32(x, y)
+#else
+#define VEC_WIDTH 1
+#endif
+
+static void init(filter_iir_bank_t* f, const float* b, const float* a, int n, int channels, float* d)
+{
+    f->b = b;
+    f->a = a;
+    f->n = n;
+    f->channels = channels;
+    f->d = d;
+    memset(f->d, 0, sizeof(float) * n * channels);
+}
+
+void filter_iir_bank_init(filter_iir_bank_t* f, const float* b, const float* a, int n, int channels, float* d)
+{
+    init(f, b, a, n, channels, d);
+    f->per_channel = false;
+}
+
+void filter_iir_bank_init_per_channel(filter_iir_bank_t* f,
+                                      const float* b,
+                                      const float* a,
+                                      int n,
+                                      int channels,
+                                      float* d)
+{
+    init(f, b, a, n, channels, d);
+    f->per_channel = true;
+}
+
+/* Filters len samples of channel c, with the same equations as
+ * filter_iir_apply(). The terms are not summed in the same order, so the
+ * results can differ by rounding. */
+static void apply_channel(const filter_iir_bank_t* f, int c, const float* in, float* out, int len)
+{
+    const int n = f->n;
+    const int channels = f->channels;
+    const int stride = f->per_channel ? channels : 1;
+    const float* b = f->per_channel ? &f->b[c] : f->b;
+    const float* a = (f->per_channel && f->a != NULL) ? &f->a[c] : f->a;
+    float* d = &f->d[c];
+    int i, k;
+
+    for (k = 0; k < len; k++) {
+        float x = in[k * channels + c];
+        float y = b[0] * x + d[0];
+        for (i = 0; i < n - 1; i++) {
+            float di = b[(i + 1) * stride] * x + d[(i + 1) * channels];
+            if (a != NULL) {
+                di -= a[i * stride] * y;
+            }
+            d[i * channels] = di;
+        }
+        d[(n - 1) * channels] = b[n * stride] * x - ((a != NULL) ? a[(n - 1) * stride] * y : 0.f);
+        out[k * channels + c] = y;
+    }
+}
+
+#if VEC_WIDTH > 1
+/* Same as apply_channel() for groups of VEC_WIDTH channels, returns the
+ * number of channels filtered. Always inlined and called with constant flags,
+ * so that each case is compiled without branches. */
+__attribute__((always_inline)) static inline int
+apply_vec(const filter_iir_bank_t* f, const float* in, float* out, int len, const bool per_channel, const bool fir)
+{
+    const int n = f->n;
+    const int channels = f->channels;
+    const int stride = per_channel ? channels : 1;
+    const int vec_channels = channels - channels % VEC_WIDTH;
+    const float* coef_b = f->b;
+    const float* coef_a = f->a;
+    float* delays = f->d;
+    int c, i, k;
+
+#define COEF(p, i) (per_channel ? vec_load(&(p)[(i)*stride]) : vec_set1((p)[i]))
+
+    for (k = 0; k < len; k++) {
+        for (c = 0; c < vec_channels; c += VEC_WIDTH) {
+            const float* b = per_channel ? &coef_b[c] : coef_b;
+            const float* a = (per_channel && !fir) ? &coef_a[c] : coef_a;
+            float* d = &delays[c];
+            vec_t x = vec_load(&in[c]);
+            vec_t y = vec_add(vec_mul(COEF(b, 0), x), vec_load(d));
+            vec_t di;
+            for (i = 0; i < n - 1; i++) {
+                di = vec_mul(COEF(b, i + 1), x);
+                if (!fir) {
+                    di = vec_sub(di, vec_mul(COEF(a, i), y));
+                }
+                vec_store(&d[i * channels], vec_add(di, vec_load(&d[(i + 1) * channels])));
+            }
+            di = vec_mul(COEF(b, n), x);
+            if (!fir) {
+                di = vec_sub(di, vec_mul(COEF(a, n - 1), y));
+            }
+            vec_store(&d[(n - 1) * channels], di);
+            vec_store(&out[c], y);
+        }
+        in += channels;
+        out += channels;
+    }
+
+#undef COEF
+
+    return vec_channels;
+}
+#endif
+
+void filter_iir_bank_apply_block(filter_iir_bank_t* f, const float* in, float* out, int len)
+{
+    int c = 0;
+
+#if VEC_WIDTH > 1
+    if (f->per_channel) {
+        c = (f->a == NULL) ? apply_vec(f, in, out, len, true, true) : apply_vec(f, in, out, len, true, false);
+    } else {
+        c = (f->a == NULL) ? apply_vec(f, in, out, len, false, true) : apply_vec(f, in, out, len, false, false);
+    }
+#endif
+
+    for (; c < f->channels; c++) {
+        apply_channel(f, c, in, out, len);
+    }
+}
+
+void filter_iir_bank_apply(filter_iir_bank_t* f, const float* in, float* out)
+{
+    filter_iir_bank_apply_block(f, in, out, 1);
+}
@@ -0,0 +1,55 @@
+#ifndef FILTER_IIR_BANK_H
+#define FILTER_IIR_BANK_H
+
+#include <stdbool.h>
+
+/* Bank of IIR filters of the same degree, one per channel, computing the
+ * same output as one filter_iir_t per channel, up to rounding.
+ *
+ * The delays are stored as a structure of arrays, delay i of channel c at
+ * d[i * channels + c], so that consecutive channels are filtered together
+ * with SIMD instructions (SSE or NEON) when available. */
+typedef struct {
+    const float* b; // coefficients b0 to bn, size n+1, or (n+1) * channels
+    const float* a; // coefficients a1 to an, size n, or n * channels
+    int n;
+    int channels;
+    bool per_channel; // if coefficient i of channel c is at [i * channels + c]
+    float* d; // delays (buffer), size n * channels
+} filter_iir_bank_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Initializes a bank of channels filters, all with the coefficients b and a
+ * as in filter_iir_init(). */
+void filter_iir_bank_init(filter_iir_bank_t* f,
+                          const float* b,
+                          const float* a,
+                          int n,
+                          int channels,
+                          float* d);
+
+/* Same as filter_iir_bank_init() with different coefficients per channel,
+ * coefficient i of channel c being b[i * channels + c] (and a[...]). */
+void filter_iir_bank_init_per_channel(filter_iir_bank_t* f,
+                                      const float* b,
+                                      const float* a,
+                                      int n,
+                                      int channels,
+                                      float* d);
+
+/* Filters one sample of each channel. in and out hold one value per channel
+ * and can be the same array. */
+void filter_iir_bank_apply(filter_iir_bank_t* f, const float* in, float* out);
+
+/* Filters len samples of each channel, sample k of channel c being at
+ * [k * channels + c] in both in and out, which can be the same array. */
+void filter_iir_bank_apply_block(filter_iir_bank_t* f, const float* in, float* out, int len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,137 @@
+#include "CppUTest/TestHarness.h"
+#include <filter/iir.h>
+#include <filter/iir_bank.h>
+
+#define CHANNELS 7 // a group of SIMD channels and a few more
+#define N 3
+
+static float input(int channel, int k)
+{
+    return (k % (channel + 2)) - 0.3f * channel;
+}
+
+TEST_GROUP (IIRFilterBank) {
+    const float b[N + 1] = {0.1, 0.2, 0.3, 0.4};
+    const float a[N] = {0.1, 0.1, 0.1};
+    float buffer[N * CHANNELS];
+    filter_iir_bank_t bank;
+
+    filter_iir_t filters[CHANNELS];
+    float filter_buffers[CHANNELS][N];
+
+    void init_filters(const float* num, const float* den)
+    {
+        for (int c = 0; c < CHANNELS; c++) {
+            filter_iir_init(&filters[c], num, den, N, filter_buffers[c]);
+        }
+    }
+
+    void check_same_as_filters()
+    {
+        float x[CHANNELS], y[CHANNELS];
+        for (int k = 0; k < 30; k++) {
+            for (int c = 0; c < CHANNELS; c++) {
+                x[c] = input(c, k);
+            }
+            filter_iir_bank_apply(&bank, x, y);
+            for (int c = 0; c < CHANNELS; c++) {
+                DOUBLES_EQUAL(filter_iir_apply(&filters[c], x[c]), y[c], 1.0e-6);
+            }
+        }
+    }
+};
+
+TEST(IIRFilterBank, InitClearsDelays)
+{
+    for (int i = 0; i < N * CHANNELS; i++) {
+        buffer[i] = 1;
+    }
+
+    filter_iir_bank_init(&bank, b, a, N, CHANNELS, buffer);
+
+    for (int i = 0; i < N * CHANNELS; i++) {
+        DOUBLES_EQUAL(0, buffer[i], 1.0e-9);
+    }
+}
+
+TEST(IIRFilterBank, StepResponse)
+{
+    float x[CHANNELS], y[CHANNELS];
+    filter_iir_bank_init(&bank, b, a, N, CHANNELS, buffer);
+    for (int c = 0; c < CHANNELS; c++) {
+        x[c] = 1;
+    }
+
+    // See IIRFilter.StepResponse
+    filter_iir_bank_apply(&bank, x, y);
+    filter_iir_bank_apply(&bank, x, y);
+    filter_iir_bank_apply(&bank, x, y);
+    for (int c = 0; c < CHANNELS; c++) {
+        DOUBLES_EQUAL(0.561, y[c], 1.0e-7);
+    }
+}
+
+TEST(IIRFilterBank, SameAsOneFilterPerChannel)
+{
+    filter_iir_bank_init(&bank, b, a, N, CHANNELS, buffer);
+    init_filters(b, a);
+
+    check_same_as_filters();
+}
+
+TEST(IIRFilterBank, FIRFilter)
+{
+    filter_iir_bank_init(&bank, b, nullptr, N, CHANNELS, buffer);
+    init_filters(b, nullptr);
+
+    check_same_as_filters();
+}
+
+TEST(IIRFilterBank, PerChannelCoefficients)
+{
+    float bank_b[(N + 1) * CHANNELS], bank_a[N * CHANNELS];
+    float channel_b[CHANNELS][N + 1], channel_a[CHANNELS][N];
+
+    for (int c = 0; c < CHANNELS; c++) {
+        for (int i = 0; i <= N; i++) {
+            channel_b[c][i] = bank_b[i * CHANNELS + c] = b[i] * (c + 1) / CHANNELS;
+        }
+        for (int i = 0; i < N; i++) {
+            channel_a[c][i] = bank_a[i * CHANNELS + c] = a[i] * (CHANNELS - c) / CHANNELS;
+        }
+        filter_iir_init(&filters[c], channel_b[c], channel_a[c], N, filter_buffers[c]);
+    }
+    filter_iir_bank_init_per_channel(&bank, bank_b, bank_a, N, CHANNELS, buffer);
+
+    check_same_as_filters();
+}
+
+TEST(IIRFilterBank, BlockIsSameAsSampleBySample)
+{
+    const int len = 20;
+    float block[len * CHANNELS];
+    float x[CHANNELS], y[CHANNELS];
+    float other_buffer[N * CHANNELS];
+    filter_iir_bank_t other;
+
+    filter_iir_bank_init(&bank, b, a, N, CHANNELS, buffer);
+    filter_iir_bank_init(&other, b, a, N, CHANNELS, other_buffer);
+    for (int k = 0; k < len; k++) {
+        for (int c = 0; c < CHANNELS; c++) {
+            block[k * CHANNELS + c] = input(c, k);
+        }
+    }
+
+    // In place
+    filter_iir_bank_apply_block(&bank, block, block, len);
+
+    for (int k = 0; k < len; k++) {
+        for (int c = 0; c < CHANNELS; c++) {
+            x[c] = input(c, k);
+        }
+        filter_iir_bank_apply(&other, x, y);
+        for (int c = 0; c < CHANNELS; c++) {
+            DOUBLES_EQUAL(y[c], block[k * CHANNELS + c], 1.0e-6);
+        }
+    }
+}
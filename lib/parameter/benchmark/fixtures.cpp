@@ -0,0 +1,144 @@
+#include <cstdlib>
+
+#include <cmp_mem_access/cmp_mem_access.h>
+#include <parameter/parameter_msgpack.h>
+
+#include "fixtures.h"
+
+namespace parameter_benchmark {
+
+uint8_t flash_sector[flash_sector_size];
+
+Tree::Tree()
+{
+    parameter_namespace_declare(&root, nullptr, nullptr);
+}
+
+const char* Tree::keep(const std::string& id)
+{
+    ids_.push_back(id);
+    return ids_.back().c_str();
+}
+
+parameter_namespace_t* Tree::add_namespace(parameter_namespace_t* parent, const std::string& id)
+{
+    namespaces_.emplace_back();
+    parameter_namespace_t* ns = &namespaces_.back();
+    parameter_namespace_declare(ns, parent, keep(id));
+    return ns;
+}
+
+static std::string path_of(const parameter_namespace_t* ns, const parameter_namespace_t* root)
+{
+    if (ns == root) {
+        return "";
+    }
+    return path_of(ns->parent, root) + ns->id + "/";
+}
+
+parameter_t* Tree::add_parameter(parameter_namespace_t* ns, const std::string& id)
+{
+    parameters_.emplace_back();
+    parameter_t* p = &parameters_.back();
+    const int n = parameters.size();
+
+    // Each value is read once, which clears its changed flag as after
+    // loading the config.
+    switch (n % 3) {
+        case 0:
+            parameter_scalar_declare(p, ns, keep(id));
+            parameter_scalar_set(p, 0.5f * n);
+            parameter_scalar_get(p);
+            break;
+        case 1:
+            parameter_integer_declare(p, ns, keep(id));
+            parameter_integer_set(p, 100 * n);
+            parameter_integer_get(p);
+            break;
+        default:
+            parameter_boolean_declare(p, ns, keep(id));
+            parameter_boolean_set(p, n % 2);
+            parameter_boolean_get(p);
+            break;
+    }
+
+    parameters.push_back(p);
+    paths.push_back(path_of(ns, &root) + id);
+    return p;
+}
+
+void Tree::index()
+{
+    uint32_t size = 1;
+    while (size < 2 * (namespaces_.size() + parameters_.size())) {
+        size *= 2;
+    }
+    index_entries_.resize(size);
+    parameter_namespace_index(&root, &index_, index_entries_.data(), size);
+
+    // The index is built on the first lookup
+    parameter_find(&root, paths[0].c_str());
+}
+
+std::vector<char> Tree::dump() const
+{
+    std::vector<char> buf(64 * (parameters_.size() + namespaces_.size()));
+    cmp_ctx_t cmp;
+    cmp_mem_access_t mem;
+
+    cmp_mem_access_init(&cmp, &mem, buf.data(), buf.size());
+    parameter_msgpack_write_cmp(&root, &cmp, [](void*, const char*, const char*) { abort(); }, nullptr);
+    buf.resize(cmp_mem_access_get_pos(&mem));
+
+    return buf;
+}
+
+std::unique_ptr<Tree> config_tree(int scale)
+{
+    auto tree = std::make_unique<Tree>();
+    std::vector<parameter_namespace_t*> namespaces;
+
+    // With two children per namespace, the parameters of the config sized
+    // tree are as deep as in the config.
+    const int children = 2;
+    for (int i = 0; i < scale * config_namespaces; i++) {
+        parameter_namespace_t* parent = (i < children) ? &tree->root : namespaces[i / children - 1];
+        namespaces.push_back(tree->add_namespace(parent, "ns" + std::to_string(i)));
+    }
+
+    for (int i = 0; i < scale * config_parameters; i++) {
+        tree->add_parameter(namespaces[i % namespaces.size()], "param" + std::to_string(i));
+    }
+
+    return tree;
+}
+
+std::unique_ptr<Tree> deep_tree(int depth)
+{
+    auto tree = std::make_unique<Tree>();
+    parameter_namespace_t* ns = &tree->root;
+
+    for (int i = 0; i < depth; i++) {
+        ns = tree->add_namespace(ns, "level" + std::to_string(i));
+    }
+    tree->add_parameter(ns, "param");
+
+    return tree;
+}
+
+std::unique_ptr<Tree> wide_tree(int breadth)
+{
+    auto tree = std::make_unique<Tree>();
+    parameter_namespace_t* first = tree->add_namespace(&tree->root, "ns0");
+
+    for (int i = 1; i < breadth; i++) {
+        tree->add_namespace(&tree->root, "ns" + std::to_string(i));
+    }
+    for (int i = 0; i < breadth; i++) {
+        tree->add_parameter(first, "param" + std::to_string(i));
+    }
+
+    return tree;
+}
+
+} // namespace parameter_benchmark
@@ -0,0 +1,74 @@
+#ifndef PARAMETER_BENCHMARK_FIXTURES_H
+#define PARAMETER_BENCHMARK_FIXTURES_H
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <parameter/parameter.h>
+
+namespace parameter_benchmark {
+
+/* Shape of the master firmware config (config_order.yaml at the root of the
+ * repository), which the benchmarks also run at 10 times that size. */
+const int config_namespaces = 34;
+const int config_parameters = 81;
+const int config_depth = 6;
+const int config_breadth = 11;
+
+/** A parameter tree owning its namespaces, parameters and ids. */
+class Tree {
+public:
+    Tree();
+    Tree(const Tree&) = delete;
+    Tree& operator=(const Tree&) = delete;
+
+    parameter_namespace_t root;
+
+    /** Every parameter, and its path relative to root, in declaration order */
+    std::vector<parameter_t*> parameters;
+    std::vector<std::string> paths;
+
+    parameter_namespace_t* add_namespace(parameter_namespace_t* parent, const std::string& id);
+
+    /** Declares a scalar, integer or boolean parameter, depending on the
+     * number of parameters already declared, and gives it a value. */
+    parameter_t* add_parameter(parameter_namespace_t* ns, const std::string& id);
+
+    /** Builds an index of the whole tree, see parameter_namespace_index(). */
+    void index();
+
+    /** Returns the tree saved as MessagePack. */
+    std::vector<char> dump() const;
+
+private:
+    std::deque<parameter_namespace_t> namespaces_;
+    std::deque<parameter_t> parameters_;
+    std::deque<std::string> ids_;
+    parameter_index_t index_;
+    std::vector<parameter_index_entry_t> index_entries_;
+
+    const char* keep(const std::string& id);
+};
+
+/** Same number of namespaces and parameters as scale times the config. The
+ * namespaces are declared breadth first, with two children each, and the
+ * parameters are spread evenly over them. */
+std::unique_ptr<Tree> config_tree(int scale);
+
+/** A single parameter below depth nested namespaces. */
+std::unique_ptr<Tree> deep_tree(int depth);
+
+/** breadth namespaces, the first of which holds breadth parameters. The
+ * first parameter is the last one found when searching through the tree. */
+std::unique_ptr<Tree> wide_tree(int breadth);
+
+/* Flash sector emulated in RAM by the flash_* functions of the benchmark,
+ * as large as the last sectors of an STM32F4. */
+const size_t flash_sector_size = 128 * 1024;
+extern uint8_t flash_sector[flash_sector_size];
+
+} // namespace parameter_benchmark
+
+#endif
@@ -0,0 +1,242 @@
+#include <cstdlib>
+#include <cstring>
+
+#include <benchmark/benchmark.h>
+#include <parameter/parameter.h>
+#include <parameter/parameter_msgpack.h>
+#include <parameter_flash_storage/parameter_flash_storage.h>
+
+#include "fixtures.h"
+
+using namespace parameter_benchmark;
+
+/* The second argument of the lookup benchmarks selects whether the tree is
+ * indexed (see parameter_namespace_index()). */
+static void BM_FindByDepth(benchmark::State& state)
+{
+    auto tree = deep_tree(state.range(0));
+    if (state.range(1)) {
+        tree->index();
+    }
+    const char* path = tree->paths[0].c_str();
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parameter_find(&tree->root, path));
+    }
+}
+
+BENCHMARK(BM_FindByDepth)->ArgNames({"depth", "indexed"})->ArgsProduct({{1, config_depth, 10 * config_depth}, {0, 1}});
+
+static void BM_FindByBreadth(benchmark::State& state)
+{
+    auto tree = wide_tree(state.range(0));
+    if (state.range(1)) {
+        tree->index();
+    }
+    const char* path = tree->paths[0].c_str();
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(parameter_find(&tree->root, path));
+    }
+}
+
+BENCHMARK(BM_FindByBreadth)->ArgNames({"breadth", "indexed"})->ArgsProduct({{config_breadth, 10 * config_breadth}, {0, 1}});
+
+/* Looks up every parameter of the tree, as done when declaring the config */
+static void BM_FindAll(benchmark::State& state)
+{
+    auto tree = config_tree(state.range(0));
+    if (state.range(1)) {
+        tree->index();
+    }
+
+    for (auto _ : state) {
+        for (const auto& path : tree->paths) {
+            benchmark::DoNotOptimize(parameter_find(&tree->root, path.c_str()));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * tree->paths.size());
+}
+
+BENCHMARK(BM_FindAll)->ArgNames({"scale", "indexed"})->ArgsProduct({{1, 10}, {0, 1}});
+
+/* Returns the deepest boolean parameter, whose changes update the most
+ * counters. */
+static parameter_t* last_boolean(const Tree& tree)
+{
+    for (auto it = tree.parameters.rbegin(); it != tree.parameters.rend(); it++) {
+        if ((*it)->type == _PARAM_TYPE_BOOLEAN) {
+            return *it;
+        }
+    }
+    abort();
+}
+
+/* Polling loop of a module: is anything new, and if so read the parameter
+ * which was set. */
+static void BM_ContainsChanged(benchmark::State& state)
+{
+    auto tree = config_tree(state.range(0));
+    parameter_t* p = last_boolean(*tree);
+    int32_t value = 0;
+
+    for (auto _ : state) {
+        parameter_boolean_set(p, value++ % 2);
+        benchmark::DoNotOptimize(parameter_namespace_contains_changed(&tree->root));
+        parameter_boolean_get(p);
+        benchmark::DoNotOptimize(parameter_namespace_contains_changed(&tree->root));
+    }
+}
+
+BENCHMARK(BM_ContainsChanged)->ArgName("scale")->Arg(1)->Arg(10);
+
+static void err_cb(void* arg, const char* id, const char* err)
+{
+    (void)arg;
+    (void)id;
+    (void)err;
+    abort();
+}
+
+static void BM_MsgpackWrite(benchmark::State& state)
+{
+    auto tree = config_tree(state.range(0));
+    auto doc = tree->dump();
+    std::vector<char> buf(doc.size());
+
+    for (auto _ : state) {
+        parameter_msgpack_write(&tree->root, buf.data(), buf.size(), err_cb, nullptr);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(state.iterations() * doc.size());
+    state.counters["parameters"] = tree->parameters.size();
+}
+
+BENCHMARK(BM_MsgpackWrite)->ArgName("scale")->Arg(1)->Arg(10);
+
+static void BM_MsgpackRead(benchmark::State& state)
+{
+    auto tree = config_tree(state.range(0));
+    auto doc = tree->dump();
+
+    for (auto _ : state) {
+        if (parameter_msgpack_read(&tree->root, doc.data(), doc.size(), err_cb, nullptr) != 0) {
+            state.SkipWithError("read failed");
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+
+BENCHMARK(BM_MsgpackRead)->ArgName("scale")->Arg(1)->Arg(10);
+
+static void BM_MsgpackLoad(benchmark::State& state)
+{
+    auto tree = config_tree(state.range(0));
+    if (state.range(1)) {
+        tree->index();
+    }
+    auto doc = tree->dump();
+
+    for (auto _ : state) {
+        if (parameter_msgpack_load(&tree->root, doc.data(), doc.size(), err_cb, err_cb, nullptr) != 0) {
+            state.SkipWithError("load failed");
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * doc.size());
+}
+
+BENCHMARK(BM_MsgpackLoad)->ArgNames({"scale", "indexed"})->ArgsProduct({{1, 10}, {0, 1}});
+
+/* Saves the whole tree each time, which includes looking for the free space
+ * in the sector and erasing it when it is full. */
+static void BM_FlashStorageSave(benchmark::State& state)
+{
+    auto tree = config_tree(state.range(0));
+    memset(flash_sector, 0xff, flash_sector_size);
+
+    for (auto _ : state) {
+        parameter_flash_storage_save(flash_sector, flash_sector_size, &tree->root);
+    }
+
+    state.SetBytesProcessed(state.iterations() * tree->dump().size());
+}
+
+BENCHMARK(BM_FlashStorageSave)->ArgName("scale")->Arg(1)->Arg(10);
+
+static void BM_FlashStorageLoad(benchmark::State& state)
+{
+    auto tree = config_tree(state.range(0));
+    memset(flash_sector, 0xff, flash_sector_size);
+    parameter_flash_storage_save(flash_sector, flash_sector_size, &tree->root);
+
+    for (auto _ : state) {
+        if (!parameter_flash_storage_load(&tree->root, flash_sector)) {
+            state.SkipWithError("load failed");
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * tree->dump().size());
+}
+
+BENCHMARK(BM_FlashStorageLoad)->ArgName("scale")->Arg(1)->Arg(10);
+
+/* Sets one parameter and saves it, compacting the log when it is full */
+static void BM_FlashLogSave(benchmark::State& state)
+{
+    auto tree = config_tree(state.range(0));
+    std::vector<parameter_flash_log_entry_t> entries(tree->parameters.size());
+    parameter_flash_log_t log;
+    memset(flash_sector, 0xff, flash_sector_size);
+    parameter_flash_log_init(&log, &tree->root, flash_sector, flash_sector_size,
+                             entries.data(), entries.size());
+    parameter_flash_log_save(&log);
+
+    parameter_t* p = last_boolean(*tree);
+    int32_t value = 0;
+    for (auto _ : state) {
+        parameter_boolean_set(p, value++ % 2);
+        if (!parameter_flash_log_save(&log)) {
+            state.SkipWithError("save failed");
+        }
+    }
+}
+
+BENCHMARK(BM_FlashLogSave)->ArgName("scale")->Arg(1)->Arg(10);
+
+/* Replays a log holding the whole tree followed by one block per boolean
+ * parameter, each changing it once. */
+static void BM_FlashLogLoad(benchmark::State& state)
+{
+    auto tree = config_tree(state.range(0));
+    std::vector<parameter_flash_log_entry_t> entries(tree->parameters.size());
+    parameter_flash_log_t log;
+    memset(flash_sector, 0xff, flash_sector_size);
+    parameter_flash_log_init(&log, &tree->root, flash_sector, flash_sector_size,
+                             entries.data(), entries.size());
+    parameter_flash_log_save(&log);
+
+    for (auto* p : tree->parameters) {
+        if (p->type == _PARAM_TYPE_BOOLEAN) {
+            parameter_boolean_set(p, !parameter_boolean_read(p));
+            parameter_flash_log_save(&log);
+        }
+    }
+
+    for (auto _ : state) {
+        parameter_flash_log_init(&log, &tree->root, flash_sector, flash_sector_size,
+                                 entries.data(), entries.size());
+        if (!parameter_flash_log_load(&log)) {
+            state.SkipWithError("load failed");
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * log.end);
+}
+
+BENCHMARK(BM_FlashLogLoad)->ArgName("scale")->Arg(1)->Arg(10);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,59 @@
+#include <cstdlib>
+#include <cstring>
+
+#include <parameter/parameter_port.h>
+#include <parameter_flash_storage/flash.h>
+
+#include "fixtures.h"
+
+using parameter_benchmark::flash_sector;
+using parameter_benchmark::flash_sector_size;
+
+extern "C" {
+
+void parameter_port_lock(void)
+{
+}
+
+void parameter_port_unlock(void)
+{
+}
+
+void parameter_port_assert(int condition)
+{
+    if (!condition) {
+        abort();
+    }
+}
+
+void* parameter_port_buffer_alloc(size_t size)
+{
+    return malloc(size);
+}
+
+void parameter_port_buffer_free(void* buffer)
+{
+    free(buffer);
+}
+
+void flash_lock(void)
+{
+}
+
+void flash_unlock(void)
+{
+}
+
+void flash_write(void* addr, const void* data, size_t len)
+{
+    memcpy(addr, data, len);
+}
+
+void flash_sector_erase(void* addr)
+{
+    if (addr != flash_sector) {
+        abort();
+    }
+    memset(flash_sector, 0xff, flash_sector_size);
+}
+}
@@ -7,6 +7,35 @@
 
 typedef struct parameter_namespace_s parameter_namespace_t;
 typedef struct parameter_s parameter_t;
+typedef struct parameter_subscription_s parameter_subscription_t;
+
+typedef void (*parameter_subscription_cb)(void* arg);
+
+/* A callback registered with parameter_subscribe() or
+ * parameter_namespace_subscribe() */
+struct parameter_subscription_s {
+    parameter_subscription_cb cb;
+    void* arg;
+    parameter_subscription_t* next;
+    parameter_subscription_t* pending_next; // in the list of the current batch
+    bool pending;
+};
+
+/* An indexed parameter or namespace, see parameter_namespace_index() */
+typedef struct {
+    const char* id;
+    void* node; // parameter_t or parameter_namespace_t, NULL if the slot is free
+    uint32_t hash; // of the path relative to the indexed namespace
+    int32_t parent; // entry of the containing namespace, -1 for the indexed one
+    bool is_namespace;
+} parameter_index_entry_t;
+
+typedef struct {
+    parameter_index_entry_t* entries;
+    uint32_t size;
+    uint32_t generation; // of the parameter tree when the index was built
+    bool valid; // false if the entries were too few for the tree
+} parameter_index_t;
 
 struct parameter_namespace_s {
     const char* id;
@@ -15,6 +44,8 @@ struct parameter_namespace_s {
     parameter_namespace_t* subspaces;
     parameter_namespace_t* next;
     parameter_t* parameter_list;
+    parameter_index_t* index;
+    parameter_subscription_t* subscriptions;
 };
 
 struct _param_val_str_s {
@@ -47,6 +78,8 @@ struct parameter_s {
     const char* id;
     parameter_namespace_t* ns;
     parameter_t* next;
+    parameter_subscription_t* subscriptions;
+    uint32_t generation; // incremented each time the parameter is set
     bool changed;
     bool defined;
     uint8_t type;
@@ -79,6 +112,61 @@ parameter_namespace_t* _parameter_namespace_find_w_id_len(parameter_namespace_t*
 
 bool parameter_namespace_contains_changed(const parameter_namespace_t* ns);
 
+/*
+ * Index the paths relative to ns in a hash table, so that parameter_find() and
+ * parameter_namespace_find() from ns take a time proportional to the path
+ * length instead of searching through the tree.
+ * The index is built on the first lookup, and built again on the next lookup
+ * after a parameter or namespace was declared anywhere.
+ * size must be a power of two. If it is smaller than 4/3 of the number of
+ * parameters and namespaces below ns, lookups search through the tree instead.
+ */
+void parameter_namespace_index(parameter_namespace_t* ns,
+                               parameter_index_t* index,
+                               parameter_index_entry_t* entries,
+                               uint32_t size);
+
+/*
+ * Call cb(arg) each time the parameter is set, after its value was updated.
+ * The callback runs in the thread setting the parameter, without the lock
+ * held, so it may read parameters but should return quickly, for example by
+ * waking up the thread using the value.
+ * The subscription s must stay valid as long as the parameter does.
+ */
+void parameter_subscribe(parameter_subscription_t* s,
+                         parameter_t* p,
+                         parameter_subscription_cb cb,
+                         void* arg);
+
+/*
+ * Same as parameter_subscribe(), for any parameter in the namespace or its
+ * sub-namespaces.
+ */
+void parameter_namespace_subscribe(parameter_subscription_t* s,
+                                   parameter_namespace_t* ns,
+                                   parameter_subscription_cb cb,
+                                   void* arg);
+
+/*
+ * Between parameter_batch_begin() and parameter_batch_end(), subscription
+ * callbacks are deferred to parameter_batch_end(), which calls each of them
+ * once, no matter how many of the parameters they watch were set.
+ * Batches can be nested, callbacks are called at the end of the outermost.
+ * The MessagePack loader does a batch for each load.
+ *
+ * The batch is global, not per thread: while one is in progress, the
+ * callbacks (and snapshot updates) for parameters set by any thread are
+ * deferred to its end as well.
+ */
+void parameter_batch_begin(void);
+void parameter_batch_end(void);
+
+/* [internal API]
+ * If a batch is in progress, adds s to the subscriptions called at its end
+ * and returns true. Must be called with the lock held.
+ */
+bool _parameter_batch_defer(parameter_subscription_t* s);
+
 /*
  * Get the parameter by id.
  * The id is relative to the namespace.
@@ -107,6 +195,13 @@ bool parameter_defined(const parameter_t* p);
  */
 bool parameter_changed(const parameter_t* p);
 
+/*
+ * Returns a counter incremented each time the parameter is set.
+ * Unlike parameter_changed(), this lets several readers each check whether
+ * the parameter was set since they last looked, by keeping the last value.
+ */
+uint32_t parameter_generation(const parameter_t* p);
+
 /* [internal API]
  * initialize the parameter without the type specific fields.
  */
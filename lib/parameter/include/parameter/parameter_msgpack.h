@@ -22,6 +22,47 @@ int parameter_msgpack_read(parameter_namespace_t* ns,
                            parameter_msgpack_err_cb err_cb,
                            void* err_arg);
 
+/** Maximum length of the key paths reported by parameter_msgpack_load(). */
+#ifndef PARAMETER_MSGPACK_PATH_MAX
+#define PARAMETER_MSGPACK_PATH_MAX 128
+#endif
+
+/** Loads a MessagePack document held in memory into the given namespace.
+ *
+ * Unlike parameter_msgpack_read(), keys are compared in place without being
+ * copied, and the document and the tree are walked together: each key is first
+ * matched against the sibling following the previous match, then looked up
+ * through the index of ns if it has one (see parameter_namespace_index()).
+ *
+ * Unknown keys do not stop the load. Their value is skipped (including whole
+ * namespaces) and unknown_cb is called with their path relative to ns, so all
+ * of them can be reported at once. Other errors, such as type mismatches, go
+ * to err_cb and the faulty value is skipped. Either callback can be NULL.
+ *
+ * Returns the number of unknown keys, or -1 if the document could not be read.
+ */
+int parameter_msgpack_load(parameter_namespace_t* ns,
+                           const void* buf,
+                           size_t size,
+                           parameter_msgpack_err_cb err_cb,
+                           parameter_msgpack_err_cb unknown_cb,
+                           void* arg);
+
+/** Checks a MessagePack document without changing any parameter.
+ *
+ * The document is walked as by parameter_msgpack_load(), and err_cb is called
+ * with the path of each unknown key and of each value which could not be set
+ * (wrong type, wrong vector dimension, string too long).
+ *
+ * Returns the number of problems found, so that a document can be applied only
+ * if it loads entirely, or -1 if the document could not be read.
+ */
+int parameter_msgpack_check(parameter_namespace_t* ns,
+                            const void* buf,
+                            size_t size,
+                            parameter_msgpack_err_cb err_cb,
+                            void* arg);
+
 /** Saves the given parameter tree to the given CMP context. */
 void parameter_msgpack_write_cmp(const parameter_namespace_t* ns,
                                  cmp_ctx_t* cmp,
@@ -34,6 +75,14 @@ void parameter_msgpack_write(const parameter_namespace_t* ns,
                              size_t size,
                              parameter_msgpack_err_cb err_cb,
                              void* err_arg);
+
+/** Writes the value of a single parameter, as found in the trees saved by
+ * parameter_msgpack_write_cmp().
+ *
+ * Must be called with the parameter lock held. Returns false on failure.
+ */
+bool parameter_msgpack_write_value(const parameter_t* param, cmp_ctx_t* cmp);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,97 @@
+#ifndef PARAMETER_SNAPSHOT_H
+#define PARAMETER_SNAPSHOT_H
+
+#include <parameter/parameter.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Consistent, read-only copies of the parameters of a namespace.
+ *
+ * Reading related parameters (eg. PID gains) one by one can mix values from
+ * before and after a MessagePack load. A snapshot instead holds a copy of all
+ * the scalar, integer and boolean parameters directly in a namespace, taken
+ * with the lock held and never in the middle of a batch. It is updated each
+ * time one of them is set, by building a new copy and publishing it
+ * atomically, RCU-style. As batches are global, a value set by another
+ * thread during a load only shows up once the load is done.
+ *
+ * Readers never take the lock: parameter_snapshot_acquire() is a single
+ * atomic increment, and the copy it returns stays unchanged until it is
+ * given back with parameter_snapshot_release(). Setting a parameter never
+ * waits for the readers: if all the copies are still in use, the new copy is
+ * taken by the reader giving back the first of them, so readers should
+ * release them quickly.
+ */
+
+/* One copy is published, one is being written, and one is left for a reader
+ * still holding the previous one. */
+#define PARAMETER_SNAPSHOT_SLOTS 3
+
+/* Number of entries to give to parameter_snapshot_init() for a namespace with
+ * up to n parameters. */
+#define PARAMETER_SNAPSHOT_ENTRIES(n) (PARAMETER_SNAPSHOT_SLOTS * (n))
+
+typedef struct {
+    const parameter_t* p;
+    union {
+        float s;
+        int32_t i;
+        bool b;
+    } value;
+} parameter_snapshot_entry_t;
+
+typedef struct {
+    parameter_snapshot_entry_t* entries;
+    uint16_t len;
+    uint32_t version; // incremented with each new copy
+    int32_t readers; // left over from before it was replaced
+} parameter_snapshot_view_t;
+
+typedef struct {
+    parameter_namespace_t* ns;
+    parameter_snapshot_view_t views[PARAMETER_SNAPSHOT_SLOTS];
+    uint16_t capacity;
+    uint32_t version;
+    uint32_t state; // published view in the high byte, its readers below
+    uint32_t pending; // set if an update found all the views in use
+    parameter_subscription_t subscription;
+} parameter_snapshot_t;
+
+/*
+ * Initializes a snapshot of ns and takes the first copy.
+ * entries must hold PARAMETER_SNAPSHOT_ENTRIES(capacity) elements, where
+ * capacity is at least the number of parameters in the namespace.
+ * Both snap and entries must stay valid as long as the namespace does.
+ */
+void parameter_snapshot_init(parameter_snapshot_t* snap,
+                             parameter_namespace_t* ns,
+                             parameter_snapshot_entry_t* entries,
+                             uint16_t capacity);
+
+/* Returns the latest copy, which must be given back with
+ * parameter_snapshot_release(). Never blocks.
+ * Releasing a copy takes the lock to update the snapshot if a parameter was
+ * set while all the copies were in use. */
+const parameter_snapshot_view_t* parameter_snapshot_acquire(parameter_snapshot_t* snap);
+void parameter_snapshot_release(parameter_snapshot_t* snap,
+                                const parameter_snapshot_view_t* view);
+
+/*
+ * Values of p in the given copy.
+ * p must be in the namespace and was defined when the copy was taken.
+ */
+float parameter_snapshot_scalar(const parameter_snapshot_view_t* view, const parameter_t* p);
+int32_t parameter_snapshot_integer(const parameter_snapshot_view_t* view, const parameter_t* p);
+bool parameter_snapshot_boolean(const parameter_snapshot_view_t* view, const parameter_t* p);
+
+/* Returns true if p was defined when the copy was taken. */
+bool parameter_snapshot_contains(const parameter_snapshot_view_t* view, const parameter_t* p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PARAMETER_SNAPSHOT_H */
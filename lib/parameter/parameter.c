@@ -21,8 +21,26 @@
  * temporarily become negative in case the increment is interrupted by a
  * get_parameter() which decreases the counter. This poses no problem since the
  * check for the changed count correctly handles the signed integer counter)
+ *
+ * Path indexes are only accessed with the lock held, as they are built lazily
+ * by the lookups.
+ *
+ * Subscriptions are linked into the lists like parameters and namespaces. The
+ * batch state (depth and list of pending subscriptions) and the pending flags
+ * are protected by the lock. Callbacks are always called without the lock.
  */
 
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME 16777619u
+
+/* Incremented on every declaration, to know when the indexes are outdated.
+ * Starts at 1 so that a zeroed index is never up to date. */
+static uint32_t tree_generation = 1;
+
+/* Shared by all threads, see parameter_batch_begin() */
+static int batch_depth = 0;
+static parameter_subscription_t* batch_pending = NULL;
+
 /* find the length of the next element in hierarchical id
  * returns number of characters until the first '/' or the entire
  * length if no '/' is found)
@@ -93,21 +111,224 @@ void parameter_namespace_declare(parameter_namespace_t* ns,
     ns->parent = parent;
     ns->subspaces = NULL;
     ns->parameter_list = NULL;
+    ns->index = NULL;
+    ns->subscriptions = NULL;
+    parameter_port_lock();
     if (parent != NULL) {
-        parameter_port_lock();
         // link into parent namespace
         ns->next = ns->parent->subspaces;
         ns->parent->subspaces = ns;
-        parameter_port_unlock();
     } else {
         ns->next = NULL;
     }
+    tree_generation++;
+    parameter_port_unlock();
+}
+
+/*
+ * Path index
+ *
+ * The parameters and namespaces below the indexed namespace are stored in an
+ * open addressing hash table, keyed by their path. Each entry refers to the
+ * entry of its namespace, which allows to compare the path of an entry with
+ * the one being looked up without building strings.
+ */
+
+static uint32_t path_hash_append(uint32_t hash, const char* id, size_t id_len)
+{
+    size_t i;
+    hash = (hash ^ '/') * FNV_PRIME;
+    for (i = 0; i < id_len; i++) {
+        hash = (hash ^ (uint8_t)id[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+static bool index_insert(parameter_index_t* index,
+                         uint32_t* count,
+                         const char* id,
+                         void* node,
+                         uint32_t hash,
+                         int32_t parent,
+                         bool is_namespace,
+                         int32_t* pos)
+{
+    // keep the load factor below 75% so that probe sequences stay short
+    if (*count >= index->size - index->size / 4) {
+        return false;
+    }
+    uint32_t i = hash & (index->size - 1);
+    while (index->entries[i].node != NULL) {
+        const parameter_index_entry_t* e = &index->entries[i];
+        if (e->hash == hash && e->parent == parent && e->is_namespace == is_namespace
+            && strcmp(e->id, id) == 0) {
+            // a duplicate id is never found when searching through the lists
+            *pos = -1;
+            return true;
+        }
+        i = (i + 1) & (index->size - 1);
+    }
+    index->entries[i].id = id;
+    index->entries[i].node = node;
+    index->entries[i].hash = hash;
+    index->entries[i].parent = parent;
+    index->entries[i].is_namespace = is_namespace;
+    (*count)++;
+    *pos = i;
+    return true;
+}
+
+/* Entries are inserted in list order, so that only the first of several
+ * children with the same id is indexed, which is the one found when searching
+ * through the lists. */
+static bool index_add_namespace(parameter_index_t* index,
+                                uint32_t* count,
+                                parameter_namespace_t* ns,
+                                uint32_t hash,
+                                int32_t pos)
+{
+    int32_t child_pos;
+    parameter_t* p;
+    for (p = ns->parameter_list; p != NULL; p = p->next) {
+        uint32_t child_hash = path_hash_append(hash, p->id, strlen(p->id));
+        if (!index_insert(index, count, p->id, p, child_hash, pos, false, &child_pos)) {
+            return false;
+        }
+    }
+    parameter_namespace_t* sub;
+    for (sub = ns->subspaces; sub != NULL; sub = sub->next) {
+        uint32_t child_hash = path_hash_append(hash, sub->id, strlen(sub->id));
+        if (!index_insert(index, count, sub->id, sub, child_hash, pos, true, &child_pos)) {
+            return false;
+        }
+        if (child_pos >= 0 && !index_add_namespace(index, count, sub, child_hash, child_pos)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* must be called with the lock held */
+static void index_build(parameter_namespace_t* ns)
+{
+    parameter_index_t* index = ns->index;
+    uint32_t count = 0;
+    memset(index->entries, 0, index->size * sizeof(parameter_index_entry_t));
+    index->valid = index_add_namespace(index, &count, ns, FNV_OFFSET_BASIS, -1);
+    index->generation = tree_generation;
+}
+
+/* compares the path of an entry with id, starting from the end */
+static bool index_path_matches(const parameter_index_t* index,
+                               int32_t pos,
+                               const char* id,
+                               size_t id_len)
+{
+    size_t end = id_len;
+    while (true) {
+        while (end > 0 && id[end - 1] == '/') {
+            end--; // empty elements are ignored, as in get_subnamespace()
+        }
+        if (pos < 0) {
+            return end == 0;
+        }
+        if (end == 0) {
+            return false;
+        }
+        size_t start = end;
+        while (start > 0 && id[start - 1] != '/') {
+            start--;
+        }
+        const parameter_index_entry_t* e = &index->entries[pos];
+        size_t len = end - start;
+        if (strncmp(&id[start], e->id, len) != 0 || e->id[len] != '\0') {
+            return false;
+        }
+        pos = e->parent;
+        end = start;
+    }
+}
+
+/*
+ * Looks up a path in the index of ns.
+ * Returns false if the index cannot be used, in which case the tree has to be
+ * searched instead. Otherwise *node is the result, or NULL if not found.
+ */
+static bool index_find(parameter_namespace_t* ns,
+                       const char* id,
+                       size_t id_len,
+                       bool is_namespace,
+                       void** node)
+{
+    if (!is_namespace && (id_len == 0 || id[id_len - 1] == '/')) {
+        *node = NULL; // a parameter id cannot be empty
+        return true;
+    }
+
+    uint32_t hash = FNV_OFFSET_BASIS;
+    int elements = 0;
+    uint32_t i = 0;
+    while (i < id_len) {
+        int id_elem_len = id_split(&id[i], id_len - i);
+        if (id_elem_len > 0) {
+            hash = path_hash_append(hash, &id[i], id_elem_len);
+            elements++;
+        }
+        i += id_elem_len + 1;
+    }
+
+    if (elements == 0) {
+        *node = is_namespace ? ns : NULL; // the index does not contain ns itself
+        return true;
+    }
+
+    parameter_port_lock();
+    parameter_index_t* index = ns->index;
+    if (index->generation != tree_generation) {
+        index_build(ns);
+    }
+    if (!index->valid) {
+        parameter_port_unlock();
+        return false;
+    }
+    *node = NULL;
+    i = hash & (index->size - 1);
+    while (index->entries[i].node != NULL) {
+        const parameter_index_entry_t* e = &index->entries[i];
+        if (e->hash == hash && e->is_namespace == is_namespace
+            && index_path_matches(index, i, id, id_len)) {
+            *node = e->node;
+            break;
+        }
+        i = (i + 1) & (index->size - 1);
+    }
+    parameter_port_unlock();
+    return true;
+}
+
+void parameter_namespace_index(parameter_namespace_t* ns,
+                               parameter_index_t* index,
+                               parameter_index_entry_t* entries,
+                               uint32_t size)
+{
+    parameter_port_assert(size > 0 && (size & (size - 1)) == 0);
+    parameter_port_lock();
+    index->entries = entries;
+    index->size = size;
+    index->generation = 0;
+    index->valid = false;
+    ns->index = index;
+    parameter_port_unlock();
 }
 
 parameter_namespace_t* _parameter_namespace_find_w_id_len(parameter_namespace_t* ns,
                                                           const char* id,
                                                           size_t id_len)
 {
+    void* found;
+    if (ns->index != NULL && index_find(ns, id, id_len, true, &found)) {
+        return found;
+    }
     parameter_namespace_t* nret = ns;
     uint32_t i = 0;
     while (nret != NULL && i < id_len) {
@@ -128,6 +349,10 @@ parameter_t* _parameter_find_w_id_len(parameter_namespace_t* ns,
                                       const char* id,
                                       size_t id_len)
 {
+    void* found;
+    if (ns->index != NULL && index_find(ns, id, id_len, false, &found)) {
+        return found;
+    }
     parameter_namespace_t* pns = ns;
     uint32_t i = 0;
     while (pns != NULL) {
@@ -153,10 +378,13 @@ void _parameter_declare(parameter_t* p, parameter_namespace_t* ns, const char* i
     p->ns = ns;
     p->changed = false;
     p->defined = false;
+    p->subscriptions = NULL;
+    p->generation = 0;
     parameter_port_lock();
     // link into namespace
     p->next = p->ns->parameter_list;
     p->ns->parameter_list = p;
+    tree_generation++;
     parameter_port_unlock();
 }
 
@@ -176,6 +404,14 @@ bool parameter_changed(const parameter_t* p)
     return changed;
 }
 
+uint32_t parameter_generation(const parameter_t* p)
+{
+    parameter_port_lock();
+    uint32_t generation = p->generation;
+    parameter_port_unlock();
+    return generation;
+}
+
 bool parameter_defined(const parameter_t* p)
 {
     if (p == NULL) {
@@ -187,25 +423,138 @@ bool parameter_defined(const parameter_t* p)
     return defined;
 }
 
-void _parameter_changed_set(parameter_t* p)
+static void subscription_init(parameter_subscription_t* s,
+                              parameter_subscription_cb cb,
+                              void* arg)
 {
+    s->cb = cb;
+    s->arg = arg;
+    s->pending = false;
+    s->pending_next = NULL;
+}
+
+void parameter_subscribe(parameter_subscription_t* s,
+                         parameter_t* p,
+                         parameter_subscription_cb cb,
+                         void* arg)
+{
+    subscription_init(s, cb, arg);
     parameter_port_lock();
-    bool changed_was_set = p->changed;
-    p->changed = true;
+    s->next = p->subscriptions;
+    p->subscriptions = s;
     parameter_port_unlock();
-    if (changed_was_set) {
-        return;
+}
+
+void parameter_namespace_subscribe(parameter_subscription_t* s,
+                                   parameter_namespace_t* ns,
+                                   parameter_subscription_cb cb,
+                                   void* arg)
+{
+    subscription_init(s, cb, arg);
+    parameter_port_lock();
+    s->next = ns->subscriptions;
+    ns->subscriptions = s;
+    parameter_port_unlock();
+}
+
+void parameter_batch_begin(void)
+{
+    parameter_port_lock();
+    batch_depth++;
+    parameter_port_unlock();
+}
+
+void parameter_batch_end(void)
+{
+    parameter_port_lock();
+    parameter_port_assert(batch_depth > 0);
+    batch_depth--;
+    bool flush = batch_depth == 0;
+    parameter_port_unlock();
+
+    // one subscription is taken from the list at a time, as the lock has to
+    // be released to call it
+    while (flush) {
+        parameter_port_lock();
+        parameter_subscription_t* s = batch_pending;
+        if (s != NULL) {
+            batch_pending = s->pending_next;
+            s->pending = false;
+        }
+        parameter_port_unlock();
+        if (s == NULL) {
+            break;
+        }
+        s->cb(s->arg);
     }
-    // if the above "compare and set" passes, the changed count can safely
-    // be incremented for the namespaces
+}
+
+bool _parameter_batch_defer(parameter_subscription_t* s)
+{
+    if (batch_depth == 0) {
+        return false;
+    }
+    if (!s->pending) {
+        s->pending = true;
+        s->pending_next = batch_pending;
+        batch_pending = s;
+    }
+    return true;
+}
+
+static void subscriptions_notify(parameter_subscription_t* s)
+{
+    while (s != NULL) {
+        parameter_port_lock();
+        bool deferred = _parameter_batch_defer(s);
+        parameter_port_unlock();
+        if (!deferred) {
+            s->cb(s->arg);
+        }
+        s = s->next;
+    }
+}
+
+/* calls the subscriptions of the parameter and its namespaces */
+static void parameter_notify(parameter_t* p)
+{
+    parameter_port_lock();
+    parameter_subscription_t* s = p->subscriptions;
+    parameter_port_unlock();
+    subscriptions_notify(s);
+
     parameter_namespace_t* ns = p->ns;
     while (ns != NULL) {
         parameter_port_lock();
-        ns->changed_cnt++;
+        s = ns->subscriptions;
         parameter_port_unlock();
+        subscriptions_notify(s);
         ns = ns->parent;
     }
-    p->defined = true;
+}
+
+void _parameter_changed_set(parameter_t* p)
+{
+    parameter_port_lock();
+    bool changed_was_set = p->changed;
+    p->changed = true;
+    p->generation++;
+    parameter_port_unlock();
+    if (!changed_was_set) {
+        // if the above "compare and set" passes, the changed count can safely
+        // be incremented for the namespaces
+        parameter_namespace_t* ns = p->ns;
+        while (ns != NULL) {
+            parameter_port_lock();
+            ns->changed_cnt++;
+            parameter_port_unlock();
+            ns = ns->parent;
+        }
+        p->defined = true;
+    }
+    // subscribers are notified of every update, not only of the first one
+    // since the last get
+    parameter_notify(p);
 }
 
 void _parameter_changed_clear(parameter_t* p)
@@ -390,7 +390,11 @@ int parameter_msgpack_read_cmp(parameter_namespace_t* ns,
         err_cb(err_arg, NULL, "could not read namespace map");
         return -1;
     }
-    return read_namespace(ns, map_size, cmp, err_cb, err_arg);
+    // subscribers are notified once, when the whole document is loaded
+    parameter_batch_begin();
+    int ret = read_namespace(ns, map_size, cmp, err_cb, err_arg);
+    parameter_batch_end();
+    return ret;
 }
 
 int parameter_msgpack_read(parameter_namespace_t* ns,
@@ -405,13 +409,394 @@ int parameter_msgpack_read(parameter_namespace_t* ns,
     return parameter_msgpack_read_cmp(ns, &cmp, err_cb, err_arg);
 }
 
+/*
+ * Single pass loader
+ *
+ * The document is read in place: keys are compared directly in the buffer and
+ * the tree is walked along with the document instead of being searched from
+ * the root for every key.
+ */
+
+typedef struct {
+    parameter_namespace_t* root;
+    cmp_ctx_t cmp;
+    cmp_mem_access_t mem;
+    size_t size;
+    parameter_msgpack_err_cb err_cb;
+    parameter_msgpack_err_cb unknown_cb;
+    void* arg;
+    char path[PARAMETER_MSGPACK_PATH_MAX]; // path of the current key, relative to root
+    size_t path_len;
+    int truncated_depth; // number of keys which did not fit in path
+    int unknown;
+    bool check_only; // values are checked but not set
+    int invalid;
+} load_ctx_t;
+
+/* returns a pointer to the next size bytes of the document and skips them */
+static bool load_bytes(load_ctx_t* ctx, uint32_t size, const char** data)
+{
+    size_t pos = cmp_mem_access_get_pos(&ctx->mem);
+    if (size > ctx->size - pos) {
+        return false;
+    }
+    *data = cmp_mem_access_get_ptr_at_pos(&ctx->mem, pos);
+    cmp_mem_access_set_pos(&ctx->mem, pos + size);
+    return true;
+}
+
+/* skips the next object, including the content of maps and arrays */
+static bool load_skip(load_ctx_t* ctx)
+{
+    uint64_t remaining = 1;
+    while (remaining > 0) {
+        cmp_object_t obj;
+        uint32_t size;
+        int8_t type;
+        const char* data;
+        remaining--;
+        if (!cmp_read_object(&ctx->cmp, &obj)) {
+            return false;
+        }
+        if (cmp_object_as_map(&obj, &size)) {
+            remaining += 2 * (uint64_t)size;
+        } else if (cmp_object_as_array(&obj, &size)) {
+            remaining += size;
+        } else if (cmp_object_as_str(&obj, &size)
+                   || cmp_object_as_bin(&obj, &size)
+                   || cmp_object_as_ext(&obj, &type, &size)) {
+            if (!load_bytes(ctx, size, &data)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void path_push(load_ctx_t* ctx, const char* key, size_t key_len)
+{
+    size_t sep = ctx->path_len > 0 ? 1 : 0;
+    if (ctx->truncated_depth > 0 || ctx->path_len + sep + key_len >= sizeof(ctx->path)) {
+        ctx->truncated_depth++;
+        return;
+    }
+    if (sep) {
+        ctx->path[ctx->path_len++] = '/';
+    }
+    memcpy(&ctx->path[ctx->path_len], key, key_len);
+    ctx->path_len += key_len;
+    ctx->path[ctx->path_len] = '\0';
+}
+
+static void path_pop(load_ctx_t* ctx, size_t prev_len)
+{
+    if (ctx->truncated_depth > 0) {
+        ctx->truncated_depth--;
+        return;
+    }
+    ctx->path_len = prev_len;
+    ctx->path[prev_len] = '\0';
+}
+
+static bool id_equals(const char* id, const char* key, size_t key_len)
+{
+    size_t i;
+    for (i = 0; i < key_len; i++) {
+        if (id[i] == '\0' || id[i] != key[i]) {
+            return false;
+        }
+    }
+    return id[key_len] == '\0';
+}
+
+/* Finds a child namespace of ns. The one after the previous match is tried
+ * first, as documents written by parameter_msgpack_write() are in list order,
+ * then the index of the root if any, with the full path of the key. */
+static parameter_namespace_t* load_find_namespace(load_ctx_t* ctx,
+                                                  parameter_namespace_t* ns,
+                                                  parameter_namespace_t** next,
+                                                  const char* key,
+                                                  size_t key_len)
+{
+    parameter_namespace_t* sub = *next;
+    if (sub == NULL || !id_equals(sub->id, key, key_len)) {
+        if (ctx->root->index != NULL && ctx->truncated_depth == 0) {
+            sub = _parameter_namespace_find_w_id_len(ctx->root, ctx->path, ctx->path_len);
+        } else {
+            sub = _parameter_namespace_find_w_id_len(ns, key, key_len);
+        }
+    }
+    if (sub != NULL && sub != ns) {
+        *next = sub->next;
+    }
+    return sub;
+}
+
+/* same as load_find_namespace(), for parameters */
+static parameter_t* load_find_parameter(load_ctx_t* ctx,
+                                        parameter_namespace_t* ns,
+                                        parameter_t** next,
+                                        const char* key,
+                                        size_t key_len)
+{
+    parameter_t* p = *next;
+    if (p == NULL || !id_equals(p->id, key, key_len)) {
+        if (ctx->root->index != NULL && ctx->truncated_depth == 0) {
+            p = _parameter_find_w_id_len(ctx->root, ctx->path, ctx->path_len);
+        } else {
+            p = _parameter_find_w_id_len(ns, key, key_len);
+        }
+    }
+    if (p != NULL) {
+        *next = p->next;
+    }
+    return p;
+}
+
+static int load_unknown(load_ctx_t* ctx, size_t value_pos, const char* err)
+{
+    ctx->unknown++;
+    ctx->unknown_cb(ctx->arg, ctx->path, err);
+    cmp_mem_access_set_pos(&ctx->mem, value_pos);
+    if (!load_skip(ctx)) {
+        ctx->err_cb(ctx->arg, ctx->path, "could not read value");
+        return -1;
+    }
+    return 0;
+}
+
+static bool check_vector(load_ctx_t* ctx, uint32_t len)
+{
+    uint32_t i;
+    for (i = 0; i < len; i++) {
+        cmp_object_t obj;
+        float v;
+        if (!cmp_read_object(&ctx->cmp, &obj) || !get_float(&obj, &v)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* returns true if obj can be assigned to p, may read the content of vectors */
+static bool check_parameter(load_ctx_t* ctx, parameter_t* p, cmp_object_t* obj)
+{
+    float f;
+    int32_t i;
+    bool b;
+    uint32_t size;
+    switch (p->type) {
+        case _PARAM_TYPE_SCALAR:
+            return get_float(obj, &f);
+
+        case _PARAM_TYPE_INTEGER:
+            return get_int(obj, &i);
+
+        case _PARAM_TYPE_BOOLEAN:
+            return get_bool(obj, &b);
+
+        case _PARAM_TYPE_STRING:
+            return cmp_object_as_str(obj, &size) && size < p->value.str.buf_len;
+
+        case _PARAM_TYPE_VECTOR:
+            return cmp_object_as_array(obj, &size) && size == p->value.vect.dim
+                   && check_vector(ctx, size);
+
+        case _PARAM_TYPE_VAR_VECTOR:
+            return cmp_object_as_array(obj, &size) && size <= p->value.vect.buf_dim
+                   && check_vector(ctx, size);
+
+        default:
+            return false;
+    }
+}
+
+static int load_parameter(load_ctx_t* ctx, parameter_t* p, cmp_object_t* obj, size_t value_pos)
+{
+    if (ctx->check_only) {
+        if (!check_parameter(ctx, p, obj)) {
+            ctx->invalid++;
+            ctx->err_cb(ctx->arg, ctx->path, "invalid value");
+        }
+        cmp_mem_access_set_pos(&ctx->mem, value_pos);
+        if (!load_skip(ctx)) {
+            ctx->err_cb(ctx->arg, ctx->path, "could not read value");
+            return -1;
+        }
+        return 0;
+    }
+
+    uint32_t str_len;
+    const char* str;
+    if (p->type == _PARAM_TYPE_STRING && cmp_object_as_str(obj, &str_len)
+        && str_len < p->value.str.buf_len) {
+        if (!load_bytes(ctx, str_len, &str)) {
+            ctx->err_cb(ctx->arg, p->id, "read error");
+            return -1;
+        }
+        parameter_string_set_w_len(p, str, str_len);
+        return 0;
+    }
+
+    if (read_parameter(p, obj, &ctx->cmp, ctx->err_cb, ctx->arg) != 0) {
+        // the error was reported, go on with the next key
+        cmp_mem_access_set_pos(&ctx->mem, value_pos);
+        if (!load_skip(ctx)) {
+            ctx->err_cb(ctx->arg, p->id, "could not read value");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int load_namespace(load_ctx_t* ctx, parameter_namespace_t* ns, uint32_t map_size)
+{
+    parameter_port_lock();
+    parameter_namespace_t* next_sub = ns->subspaces;
+    parameter_t* next_param = ns->parameter_list;
+    parameter_port_unlock();
+
+    uint32_t i;
+    for (i = 0; i < map_size; i++) {
+        uint32_t key_len;
+        const char* key;
+        if (!cmp_read_str_size(&ctx->cmp, &key_len) || !load_bytes(ctx, key_len, &key)) {
+            ctx->err_cb(ctx->arg, NULL, "could not read id");
+            return -1;
+        }
+        size_t value_pos = cmp_mem_access_get_pos(&ctx->mem);
+        size_t prev_len = ctx->path_len;
+        path_push(ctx, key, key_len);
+
+        int ret;
+        cmp_object_t obj;
+        uint32_t inner_map_size;
+        if (!cmp_read_object(&ctx->cmp, &obj)) {
+            ctx->err_cb(ctx->arg, ctx->path, "could not read value");
+            ret = -1;
+        } else if (cmp_object_as_map(&obj, &inner_map_size)) {
+            parameter_namespace_t* sub = load_find_namespace(ctx, ns, &next_sub, key, key_len);
+            if (sub != NULL) {
+                ret = load_namespace(ctx, sub, inner_map_size);
+            } else {
+                ret = load_unknown(ctx, value_pos, "namespace doesn't exist");
+            }
+        } else {
+            parameter_t* p = load_find_parameter(ctx, ns, &next_param, key, key_len);
+            if (p != NULL) {
+                ret = load_parameter(ctx, p, &obj, value_pos);
+            } else {
+                ret = load_unknown(ctx, value_pos, "parameter doesn't exist");
+            }
+        }
+
+        path_pop(ctx, prev_len);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+static int load_document(load_ctx_t* ctx,
+                         parameter_namespace_t* ns,
+                         const void* buf,
+                         size_t size)
+{
+    ctx->root = ns;
+    ctx->size = size;
+    ctx->path[0] = '\0';
+    ctx->path_len = 0;
+    ctx->truncated_depth = 0;
+    ctx->unknown = 0;
+    ctx->invalid = 0;
+    cmp_mem_access_ro_init(&ctx->cmp, &ctx->mem, buf, size);
+
+    uint32_t map_size;
+    if (!cmp_read_map(&ctx->cmp, &map_size)) {
+        ctx->err_cb(ctx->arg, NULL, "could not read namespace map");
+        return -1;
+    }
+    return load_namespace(ctx, ns, map_size);
+}
+
+int parameter_msgpack_load(parameter_namespace_t* ns,
+                           const void* buf,
+                           size_t size,
+                           parameter_msgpack_err_cb err_cb,
+                           parameter_msgpack_err_cb unknown_cb,
+                           void* arg)
+{
+    load_ctx_t ctx;
+    ctx.err_cb = err_cb != NULL ? err_cb : err_ignore_cb;
+    ctx.unknown_cb = unknown_cb != NULL ? unknown_cb : err_ignore_cb;
+    ctx.arg = arg;
+    ctx.check_only = false;
+
+    parameter_batch_begin();
+    int ret = load_document(&ctx, ns, buf, size);
+    parameter_batch_end();
+    if (ret != 0) {
+        return -1;
+    }
+    return ctx.unknown;
+}
+
+int parameter_msgpack_check(parameter_namespace_t* ns,
+                            const void* buf,
+                            size_t size,
+                            parameter_msgpack_err_cb err_cb,
+                            void* arg)
+{
+    load_ctx_t ctx;
+    ctx.err_cb = err_cb != NULL ? err_cb : err_ignore_cb;
+    ctx.unknown_cb = ctx.err_cb;
+    ctx.arg = arg;
+    ctx.check_only = true;
+
+    if (load_document(&ctx, ns, buf, size) != 0) {
+        return -1;
+    }
+    return ctx.unknown + ctx.invalid;
+}
+
+bool parameter_msgpack_write_value(const parameter_t* param, cmp_ctx_t* cmp)
+{
+    bool success = true;
+    uint32_t i;
+
+    switch (param->type) {
+        case _PARAM_TYPE_SCALAR:
+            return cmp_write_float(cmp, param->value.s);
+
+        case _PARAM_TYPE_INTEGER:
+            return cmp_write_s32(cmp, param->value.i);
+
+        case _PARAM_TYPE_BOOLEAN:
+            return cmp_write_bool(cmp, param->value.b);
+
+        case _PARAM_TYPE_STRING:
+            return cmp_write_str(cmp, param->value.str.buf, param->value.str.len);
+
+        case _PARAM_TYPE_VAR_VECTOR:
+        case _PARAM_TYPE_VECTOR:
+            success &= cmp_write_array(cmp, param->value.vect.dim);
+            for (i = 0; i < param->value.vect.dim; i++) {
+                success &= cmp_write_float(cmp, param->value.vect.buf[i]);
+            }
+            return success;
+
+        default:
+            return false;
+    }
+}
+
 static void parameter_msgpack_write_subtree(const parameter_namespace_t* ns,
                                             cmp_ctx_t* cmp,
                                             parameter_msgpack_err_cb err_cb,
                                             void* err_arg)
 {
     uint32_t map_size = 0;
-    uint32_t i;
 
     parameter_namespace_t* child;
     parameter_t* param;
@@ -437,47 +822,12 @@ static void parameter_msgpack_write_subtree(const parameter_namespace_t* ns,
 
     /* Write each parameter. */
     for (param = ns->parameter_list; param != NULL; param = param->next) {
-        success = true;
-
         if (param->defined == false) {
             continue;
         }
 
-        switch (param->type) {
-            case _PARAM_TYPE_SCALAR:
-                success &= cmp_write_str(cmp, param->id, strlen(param->id));
-                success &= cmp_write_float(cmp, param->value.s);
-                break;
-
-            case _PARAM_TYPE_INTEGER:
-                success &= cmp_write_str(cmp, param->id, strlen(param->id));
-                success &= cmp_write_s32(cmp, param->value.i);
-                break;
-
-            case _PARAM_TYPE_BOOLEAN:
-                success &= cmp_write_str(cmp, param->id, strlen(param->id));
-                success &= cmp_write_bool(cmp, param->value.b);
-                break;
-
-            case _PARAM_TYPE_STRING:
-                success &= cmp_write_str(cmp, param->id, strlen(param->id));
-                success &= cmp_write_str(cmp, param->value.str.buf,
-                                         param->value.str.len);
-                break;
-
-            case _PARAM_TYPE_VAR_VECTOR:
-            case _PARAM_TYPE_VECTOR:
-                success &= cmp_write_str(cmp, param->id, strlen(param->id));
-                success &= cmp_write_array(cmp, param->value.vect.dim);
-                for (i = 0; i < param->value.vect.dim; i++) {
-                    success &= cmp_write_float(cmp, param->value.vect.buf[i]);
-                }
-                break;
-
-            default:
-                err_cb(err_arg, param->id, "unsupported type for saving");
-                break;
-        }
+        success = cmp_write_str(cmp, param->id, strlen(param->id));
+        success &= parameter_msgpack_write_value(param, cmp);
 
         if (success == false) {
             err_cb(err_arg, param->id, "cmp_write failed");
@@ -0,0 +1,189 @@
+#include <parameter/parameter_snapshot.h>
+#include <parameter/parameter_port.h>
+
+/*
+ * The state word holds the index of the published view and the number of
+ * readers which acquired it, so that acquiring is a single fetch and add.
+ * When a view is replaced, its readers are moved to its own counter, which
+ * they decrement instead once they notice it. The writer only reuses views
+ * which are neither published nor read. If there is none, it sets pending,
+ * and the reader which leaves a view unread takes the copy instead.
+ */
+#define STATE_INDEX_SHIFT 24
+#define STATE_READERS_MASK ((1u << STATE_INDEX_SHIFT) - 1)
+
+/* copies the parameter values into view, must be called with the lock held */
+static void snapshot_copy(parameter_snapshot_t* snap, parameter_snapshot_view_t* view)
+{
+    uint16_t len = 0;
+    const parameter_t* p;
+    for (p = snap->ns->parameter_list; p != NULL; p = p->next) {
+        if (!p->defined) {
+            continue;
+        }
+        if (p->type != _PARAM_TYPE_SCALAR
+            && p->type != _PARAM_TYPE_INTEGER
+            && p->type != _PARAM_TYPE_BOOLEAN) {
+            continue;
+        }
+        parameter_port_assert(len < snap->capacity);
+        parameter_snapshot_entry_t* e = &view->entries[len++];
+        e->p = p;
+        switch (p->type) {
+            case _PARAM_TYPE_SCALAR:
+                e->value.s = p->value.s;
+                break;
+            case _PARAM_TYPE_INTEGER:
+                e->value.i = p->value.i;
+                break;
+            default:
+                e->value.b = p->value.b;
+                break;
+        }
+    }
+    view->len = len;
+    view->version = ++snap->version;
+}
+
+/* returns a view which is neither published nor read, or NULL */
+static parameter_snapshot_view_t* snapshot_writable(parameter_snapshot_t* snap)
+{
+    uint32_t published = __atomic_load_n(&snap->state, __ATOMIC_RELAXED) >> STATE_INDEX_SHIFT;
+    uint32_t i;
+    for (i = 0; i < PARAMETER_SNAPSHOT_SLOTS; i++) {
+        if (i != published && __atomic_load_n(&snap->views[i].readers, __ATOMIC_SEQ_CST) == 0) {
+            return &snap->views[i];
+        }
+    }
+    return NULL;
+}
+
+static void snapshot_publish(parameter_snapshot_t* snap, parameter_snapshot_view_t* view)
+{
+    uint32_t index = view - snap->views;
+    uint32_t old = __atomic_exchange_n(&snap->state, index << STATE_INDEX_SHIFT, __ATOMIC_ACQ_REL);
+    __atomic_fetch_add(&snap->views[old >> STATE_INDEX_SHIFT].readers,
+                       old & STATE_READERS_MASK, __ATOMIC_RELAXED);
+}
+
+static void snapshot_update(void* arg)
+{
+    parameter_snapshot_t* snap = (parameter_snapshot_t*)arg;
+    parameter_port_lock();
+    if (_parameter_batch_defer(&snap->subscription)) {
+        // updated once the batch is complete
+        parameter_port_unlock();
+        return;
+    }
+    // set before looking for a view, so that either a view is found or the
+    // reader releasing one sees it (see parameter_snapshot_release())
+    __atomic_store_n(&snap->pending, 1, __ATOMIC_SEQ_CST);
+    parameter_snapshot_view_t* view = snapshot_writable(snap);
+    if (view != NULL) {
+        __atomic_store_n(&snap->pending, 0, __ATOMIC_RELAXED);
+        snapshot_copy(snap, view);
+        snapshot_publish(snap, view);
+    }
+    parameter_port_unlock();
+}
+
+void parameter_snapshot_init(parameter_snapshot_t* snap,
+                             parameter_namespace_t* ns,
+                             parameter_snapshot_entry_t* entries,
+                             uint16_t capacity)
+{
+    uint32_t i;
+    snap->ns = ns;
+    snap->capacity = capacity;
+    snap->version = 0;
+    snap->state = 0;
+    snap->pending = 0;
+    for (i = 0; i < PARAMETER_SNAPSHOT_SLOTS; i++) {
+        snap->views[i].entries = &entries[i * capacity];
+        snap->views[i].len = 0;
+        snap->views[i].version = 0;
+        snap->views[i].readers = 0;
+    }
+    parameter_namespace_subscribe(&snap->subscription, ns, snapshot_update, snap);
+
+    parameter_port_lock();
+    // if a batch is in progress, the copy is taken again at its end
+    _parameter_batch_defer(&snap->subscription);
+    snapshot_copy(snap, &snap->views[0]);
+    parameter_port_unlock();
+}
+
+const parameter_snapshot_view_t* parameter_snapshot_acquire(parameter_snapshot_t* snap)
+{
+    uint32_t state = __atomic_fetch_add(&snap->state, 1, __ATOMIC_ACQUIRE);
+    return &snap->views[state >> STATE_INDEX_SHIFT];
+}
+
+void parameter_snapshot_release(parameter_snapshot_t* snap,
+                                const parameter_snapshot_view_t* view)
+{
+    uint32_t index = view - snap->views;
+    uint32_t state = __atomic_load_n(&snap->state, __ATOMIC_RELAXED);
+    while ((state >> STATE_INDEX_SHIFT) == index) {
+        if (__atomic_compare_exchange_n(&snap->state, &state, state - 1, true,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+            return;
+        }
+    }
+    // the view was replaced, its readers were moved to its own counter
+    int32_t readers = __atomic_fetch_sub(&snap->views[index].readers, 1, __ATOMIC_SEQ_CST);
+    if (readers == 1 && __atomic_load_n(&snap->pending, __ATOMIC_SEQ_CST)) {
+        // an update found all the views in use, this one is free now
+        snapshot_update(snap);
+    }
+}
+
+static const parameter_snapshot_entry_t* snapshot_entry(const parameter_snapshot_view_t* view,
+                                                        const parameter_t* p)
+{
+    uint16_t i;
+    for (i = 0; i < view->len; i++) {
+        if (view->entries[i].p == p) {
+            return &view->entries[i];
+        }
+    }
+    return NULL;
+}
+
+float parameter_snapshot_scalar(const parameter_snapshot_view_t* view, const parameter_t* p)
+{
+    parameter_port_assert(p->type == _PARAM_TYPE_SCALAR);
+    const parameter_snapshot_entry_t* e = snapshot_entry(view, p);
+    if (e == NULL) {
+        parameter_port_assert(false);
+        return 0;
+    }
+    return e->value.s;
+}
+
+int32_t parameter_snapshot_integer(const parameter_snapshot_view_t* view, const parameter_t* p)
+{
+    parameter_port_assert(p->type == _PARAM_TYPE_INTEGER);
+    const parameter_snapshot_entry_t* e = snapshot_entry(view, p);
+    if (e == NULL) {
+        parameter_port_assert(false);
+        return 0;
+    }
+    return e->value.i;
+}
+
+bool parameter_snapshot_boolean(const parameter_snapshot_view_t* view, const parameter_t* p)
+{
+    parameter_port_assert(p->type == _PARAM_TYPE_BOOLEAN);
+    const parameter_snapshot_entry_t* e = snapshot_entry(view, p);
+    if (e == NULL) {
+        parameter_port_assert(false);
+        return 0;
+    }
+    return e->value.b;
+}
+
+bool parameter_snapshot_contains(const parameter_snapshot_view_t* view, const parameter_t* p)
+{
+    return snapshot_entry(view, p) != NULL;
+}
@@ -0,0 +1,274 @@
+#include <CppUTest/TestHarness.h>
+#include <parameter/parameter.h>
+#include <parameter/parameter_msgpack.h>
+#include <cmp_mem_access/cmp_mem_access.h>
+#include <cmp/cmp.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static void load_error_cb(void* arg, const char* id, const char* err)
+{
+    (void)arg;
+    (void)id;
+    FAIL(err);
+}
+
+static void unknown_cb(void* arg, const char* id, const char* err)
+{
+    (void)err;
+    static_cast<vector<string>*>(arg)->push_back(id);
+}
+
+TEST_GROUP (MessagePackLoad) {
+    parameter_namespace_t rootns;
+    parameter_namespace_t a;
+    parameter_namespace_t b;
+    parameter_t a_foo;
+    parameter_t a_bar;
+    parameter_t b_baz;
+    parameter_t b_name;
+    char name_buf[8];
+
+    char buffer[1024];
+    cmp_mem_access_t mem;
+    cmp_ctx_t ctx;
+
+    vector<string> unknown;
+
+    void setup() override
+    {
+        parameter_namespace_declare(&rootns, nullptr, nullptr);
+        parameter_namespace_declare(&a, &rootns, "a");
+        parameter_namespace_declare(&b, &rootns, "b");
+        parameter_scalar_declare(&a_foo, &a, "foo");
+        parameter_scalar_declare(&a_bar, &a, "bar");
+        parameter_integer_declare(&b_baz, &b, "baz");
+        parameter_string_declare(&b_name, &b, "name", name_buf, sizeof(name_buf));
+
+        cmp_mem_access_init(&ctx, &mem, buffer, sizeof buffer);
+    }
+
+    int load()
+    {
+        return parameter_msgpack_load(&rootns, buffer, cmp_mem_access_get_pos(&mem),
+                                      load_error_cb, unknown_cb, &unknown);
+    }
+};
+
+TEST(MessagePackLoad, LoadsValues)
+{
+    // {'a': {'foo': 12., 'bar': 24.}, 'b': {'baz': 3, 'name': 'chaos'}}
+    cmp_write_map(&ctx, 2);
+    cmp_write_str(&ctx, "a", 1);
+    cmp_write_map(&ctx, 2);
+    cmp_write_str(&ctx, "foo", 3);
+    cmp_write_float(&ctx, 12.);
+    cmp_write_str(&ctx, "bar", 3);
+    cmp_write_float(&ctx, 24.);
+    cmp_write_str(&ctx, "b", 1);
+    cmp_write_map(&ctx, 2);
+    cmp_write_str(&ctx, "baz", 3);
+    cmp_write_s32(&ctx, 3);
+    cmp_write_str(&ctx, "name", 4);
+    cmp_write_str(&ctx, "chaos", 5);
+
+    CHECK_EQUAL(0, load());
+
+    CHECK_EQUAL(12., parameter_scalar_get(&a_foo));
+    CHECK_EQUAL(24., parameter_scalar_get(&a_bar));
+    CHECK_EQUAL(3, parameter_integer_get(&b_baz));
+    char out[8];
+    parameter_string_get(&b_name, out, sizeof(out));
+    STRCMP_EQUAL("chaos", out);
+}
+
+TEST(MessagePackLoad, ReadsBackWrittenTree)
+{
+    parameter_scalar_set(&a_foo, 1.);
+    parameter_scalar_set(&a_bar, 2.);
+    parameter_integer_set(&b_baz, 3);
+    parameter_string_set(&b_name, "order");
+    parameter_msgpack_write_cmp(&rootns, &ctx, load_error_cb, nullptr);
+
+    parameter_scalar_set(&a_foo, 0.);
+    parameter_integer_set(&b_baz, 0);
+    parameter_string_set(&b_name, "");
+
+    CHECK_EQUAL(0, load());
+
+    CHECK_EQUAL(1., parameter_scalar_get(&a_foo));
+    CHECK_EQUAL(3, parameter_integer_get(&b_baz));
+    char out[8];
+    parameter_string_get(&b_name, out, sizeof(out));
+    STRCMP_EQUAL("order", out);
+}
+
+TEST(MessagePackLoad, ReportsAllUnknownKeysWithTheirPath)
+{
+    // {'a': {'x': 1, 'foo': 12.}, 'c': {'d': {'e': [1, 2]}, 's': 'str'}, 'y': 2}
+    cmp_write_map(&ctx, 3);
+    cmp_write_str(&ctx, "a", 1);
+    cmp_write_map(&ctx, 2);
+    cmp_write_str(&ctx, "x", 1);
+    cmp_write_s32(&ctx, 1);
+    cmp_write_str(&ctx, "foo", 3);
+    cmp_write_float(&ctx, 12.);
+    cmp_write_str(&ctx, "c", 1);
+    cmp_write_map(&ctx, 2);
+    cmp_write_str(&ctx, "d", 1);
+    cmp_write_map(&ctx, 1);
+    cmp_write_str(&ctx, "e", 1);
+    cmp_write_array(&ctx, 2);
+    cmp_write_s32(&ctx, 1);
+    cmp_write_s32(&ctx, 2);
+    cmp_write_str(&ctx, "s", 1);
+    cmp_write_str(&ctx, "str", 3);
+    cmp_write_str(&ctx, "y", 1);
+    cmp_write_s32(&ctx, 2);
+
+    CHECK_EQUAL(3, load());
+
+    CHECK_EQUAL(3, unknown.size());
+    STRCMP_EQUAL("a/x", unknown[0].c_str());
+    STRCMP_EQUAL("c", unknown[1].c_str());
+    STRCMP_EQUAL("y", unknown[2].c_str());
+
+    // keys after the unknown ones are still loaded
+    CHECK_EQUAL(12., parameter_scalar_get(&a_foo));
+}
+
+TEST(MessagePackLoad, SkipsValuesOfTheWrongType)
+{
+    // {'a': {'foo': {'x': 1}, 'bar': 24.}}
+    cmp_write_map(&ctx, 1);
+    cmp_write_str(&ctx, "a", 1);
+    cmp_write_map(&ctx, 2);
+    cmp_write_str(&ctx, "foo", 3);
+    cmp_write_array(&ctx, 1);
+    cmp_write_str(&ctx, "x", 1);
+    cmp_write_str(&ctx, "bar", 3);
+    cmp_write_float(&ctx, 24.);
+
+    int errors = 0;
+    int ret = parameter_msgpack_load(
+        &rootns, buffer, cmp_mem_access_get_pos(&mem),
+        [](void* arg, const char* id, const char* err) {
+            (void)id;
+            (void)err;
+            (*static_cast<int*>(arg))++;
+        },
+        nullptr, &errors);
+
+    CHECK_EQUAL(0, ret);
+    CHECK_TRUE(errors > 0);
+    CHECK_FALSE(parameter_defined(&a_foo));
+    CHECK_EQUAL(24., parameter_scalar_get(&a_bar));
+}
+
+TEST(MessagePackLoad, AcceptsKeysInAnyOrder)
+{
+    // {'b': {'name': 'x', 'baz': 7}, 'a': {'bar': 2., 'foo': 1.}}
+    cmp_write_map(&ctx, 2);
+    cmp_write_str(&ctx, "b", 1);
+    cmp_write_map(&ctx, 2);
+    cmp_write_str(&ctx, "name", 4);
+    cmp_write_str(&ctx, "x", 1);
+    cmp_write_str(&ctx, "baz", 3);
+    cmp_write_s32(&ctx, 7);
+    cmp_write_str(&ctx, "a", 1);
+    cmp_write_map(&ctx, 2);
+    cmp_write_str(&ctx, "bar", 3);
+    cmp_write_float(&ctx, 2.);
+    cmp_write_str(&ctx, "foo", 3);
+    cmp_write_float(&ctx, 1.);
+
+    CHECK_EQUAL(0, load());
+
+    CHECK_EQUAL(1., parameter_scalar_get(&a_foo));
+    CHECK_EQUAL(2., parameter_scalar_get(&a_bar));
+    CHECK_EQUAL(7, parameter_integer_get(&b_baz));
+}
+
+TEST(MessagePackLoad, UsesTheIndexOfTheRoot)
+{
+    parameter_index_t index;
+    parameter_index_entry_t entries[16];
+    parameter_namespace_index(&rootns, &index, entries, 16);
+
+    cmp_write_map(&ctx, 2);
+    cmp_write_str(&ctx, "b", 1);
+    cmp_write_map(&ctx, 1);
+    cmp_write_str(&ctx, "baz", 3);
+    cmp_write_s32(&ctx, 7);
+    cmp_write_str(&ctx, "a", 1);
+    cmp_write_map(&ctx, 2);
+    cmp_write_str(&ctx, "baz", 3);
+    cmp_write_s32(&ctx, 8);
+    cmp_write_str(&ctx, "foo", 3);
+    cmp_write_float(&ctx, 1.);
+
+    CHECK_EQUAL(1, load());
+
+    STRCMP_EQUAL("a/baz", unknown[0].c_str());
+    CHECK_EQUAL(7, parameter_integer_get(&b_baz));
+    CHECK_EQUAL(1., parameter_scalar_get(&a_foo));
+    CHECK_TRUE(index.valid);
+}
+
+TEST(MessagePackLoad, FailsOnTruncatedDocument)
+{
+    cmp_write_map(&ctx, 1);
+    cmp_write_str(&ctx, "a", 1);
+    cmp_write_map(&ctx, 2);
+    cmp_write_str(&ctx, "foo", 3);
+    cmp_write_float(&ctx, 12.);
+    cmp_write_str(&ctx, "unknown", 7);
+
+    size_t size = cmp_mem_access_get_pos(&mem) - 3; // cuts the last key
+    CHECK_EQUAL(-1, parameter_msgpack_load(&rootns, buffer, size, nullptr, nullptr, nullptr));
+}
+
+TEST(MessagePackLoad, CheckReportsProblemsWithoutSettingParameters)
+{
+    // {'a': {'foo': 12., 'bar': 'x', 'x': 1}, 'b': {'name': 'too long for it'}}
+    cmp_write_map(&ctx, 2);
+    cmp_write_str(&ctx, "a", 1);
+    cmp_write_map(&ctx, 3);
+    cmp_write_str(&ctx, "foo", 3);
+    cmp_write_float(&ctx, 12.);
+    cmp_write_str(&ctx, "bar", 3);
+    cmp_write_str(&ctx, "x", 1);
+    cmp_write_str(&ctx, "x", 1);
+    cmp_write_s32(&ctx, 1);
+    cmp_write_str(&ctx, "b", 1);
+    cmp_write_map(&ctx, 1);
+    cmp_write_str(&ctx, "name", 4);
+    cmp_write_str(&ctx, "too long for it", 15);
+
+    int ret = parameter_msgpack_check(&rootns, buffer, cmp_mem_access_get_pos(&mem),
+                                      unknown_cb, &unknown);
+
+    CHECK_EQUAL(3, ret);
+    CHECK_EQUAL(3, unknown.size());
+    STRCMP_EQUAL("a/bar", unknown[0].c_str());
+    STRCMP_EQUAL("a/x", unknown[1].c_str());
+    STRCMP_EQUAL("b/name", unknown[2].c_str());
+    CHECK_FALSE(parameter_defined(&a_foo));
+}
+
+TEST(MessagePackLoad, CheckAcceptsAValidDocument)
+{
+    cmp_write_map(&ctx, 1);
+    cmp_write_str(&ctx, "b", 1);
+    cmp_write_map(&ctx, 2);
+    cmp_write_str(&ctx, "baz", 3);
+    cmp_write_s32(&ctx, 3);
+    cmp_write_str(&ctx, "name", 4);
+    cmp_write_str(&ctx, "chaos", 5);
+
+    CHECK_EQUAL(0, parameter_msgpack_check(&rootns, buffer, cmp_mem_access_get_pos(&mem),
+                                           load_error_cb, nullptr));
+    CHECK_FALSE(parameter_defined(&b_baz));
+}
@@ -0,0 +1,125 @@
+#include "CppUTest/TestHarness.h"
+#include <parameter/parameter.h>
+
+TEST_GROUP (ParameterIndex) {
+    parameter_namespace_t rootns;
+    parameter_namespace_t a;
+    parameter_namespace_t a1;
+    parameter_namespace_t a2;
+    parameter_namespace_t b;
+    parameter_namespace_t b1;
+    parameter_namespace_t b1i;
+    parameter_t p_a2_x;
+    parameter_t p_a2_y;
+    parameter_t p_root_x;
+    parameter_t p_b1i_x;
+    parameter_index_t index;
+    parameter_index_entry_t entries[32];
+
+    void setup() override
+    {
+        parameter_namespace_declare(&rootns, nullptr, nullptr);
+        parameter_namespace_declare(&a, &rootns, "test_a");
+        parameter_namespace_declare(&a1, &a, "eins");
+        parameter_namespace_declare(&a2, &a, "zwei");
+        parameter_namespace_declare(&b, &rootns, "test_b");
+        parameter_namespace_declare(&b1, &b, "eins");
+        parameter_namespace_declare(&b1i, &b1, "I");
+        _parameter_declare(&p_a2_x, &a2, "x");
+        _parameter_declare(&p_a2_y, &a2, "y");
+        _parameter_declare(&p_root_x, &rootns, "x");
+        _parameter_declare(&p_b1i_x, &b1i, "x");
+        parameter_namespace_index(&rootns, &index, entries, 32);
+    }
+};
+
+TEST(ParameterIndex, FindsParameters)
+{
+    POINTERS_EQUAL(&p_a2_x, parameter_find(&rootns, "test_a/zwei/x"));
+    POINTERS_EQUAL(&p_a2_y, parameter_find(&rootns, "test_a/zwei/y"));
+    POINTERS_EQUAL(&p_root_x, parameter_find(&rootns, "x"));
+    POINTERS_EQUAL(&p_b1i_x, parameter_find(&rootns, "test_b/eins/I/x"));
+    CHECK_TRUE(index.valid);
+}
+
+TEST(ParameterIndex, FindsNamespaces)
+{
+    POINTERS_EQUAL(&a, parameter_namespace_find(&rootns, "test_a"));
+    POINTERS_EQUAL(&a1, parameter_namespace_find(&rootns, "test_a/eins"));
+    POINTERS_EQUAL(&b1, parameter_namespace_find(&rootns, "test_b/eins"));
+    POINTERS_EQUAL(&b1i, parameter_namespace_find(&rootns, "test_b/eins/I"));
+}
+
+TEST(ParameterIndex, AcceptsSameSeparatorsAsTreeSearch)
+{
+    POINTERS_EQUAL(&p_root_x, parameter_find(&rootns, "/x"));
+    POINTERS_EQUAL(&p_a2_x, parameter_find(&rootns, "/test_a//zwei/x"));
+    POINTERS_EQUAL(&a, parameter_namespace_find(&rootns, "/test_a/"));
+    POINTERS_EQUAL(&rootns, parameter_namespace_find(&rootns, ""));
+    POINTERS_EQUAL(&rootns, parameter_namespace_find(&rootns, "/"));
+    POINTERS_EQUAL(NULL, parameter_find(&rootns, "test_a/zwei/x/"));
+    POINTERS_EQUAL(NULL, parameter_find(&rootns, ""));
+}
+
+TEST(ParameterIndex, DoesNotMixParametersAndNamespaces)
+{
+    POINTERS_EQUAL(NULL, parameter_find(&rootns, "test_a"));
+    POINTERS_EQUAL(NULL, parameter_namespace_find(&rootns, "x"));
+    POINTERS_EQUAL(NULL, parameter_namespace_find(&rootns, "test_a/zwei/x"));
+}
+
+TEST(ParameterIndex, DoesNotFindUnknownPaths)
+{
+    POINTERS_EQUAL(NULL, parameter_find(&rootns, "test_a/eins/x"));
+    POINTERS_EQUAL(NULL, parameter_find(&rootns, "test_a/zwei/xx"));
+    POINTERS_EQUAL(NULL, parameter_find(&rootns, "zwei/x"));
+    POINTERS_EQUAL(NULL, parameter_namespace_find(&rootns, "does/not/exist"));
+    POINTERS_EQUAL(NULL, parameter_namespace_find(&rootns, "eins"));
+}
+
+TEST(ParameterIndex, OnlyAppliesToIndexedNamespace)
+{
+    POINTERS_EQUAL(&p_b1i_x, parameter_find(&b, "eins/I/x"));
+    POINTERS_EQUAL(&b1i, parameter_namespace_find(&b1, "I"));
+}
+
+TEST(ParameterIndex, IsUpdatedAfterDeclarations)
+{
+    POINTERS_EQUAL(NULL, parameter_find(&rootns, "test_a/eins/z"));
+
+    parameter_t p_a1_z;
+    parameter_namespace_t a1i;
+    _parameter_declare(&p_a1_z, &a1, "z");
+    parameter_namespace_declare(&a1i, &a1, "I");
+
+    POINTERS_EQUAL(&p_a1_z, parameter_find(&rootns, "test_a/eins/z"));
+    POINTERS_EQUAL(&a1i, parameter_namespace_find(&rootns, "test_a/eins/I"));
+}
+
+TEST(ParameterIndex, FallsBackToTreeSearchWhenTooSmall)
+{
+    parameter_index_entry_t small_entries[8];
+    parameter_namespace_index(&rootns, &index, small_entries, 8);
+
+    POINTERS_EQUAL(&p_b1i_x, parameter_find(&rootns, "test_b/eins/I/x"));
+    POINTERS_EQUAL(&b1i, parameter_namespace_find(&rootns, "test_b/eins/I"));
+    CHECK_FALSE(index.valid);
+}
+
+TEST(ParameterIndex, FindsSameParameterAsTreeSearchForDuplicateIds)
+{
+    parameter_t duplicate_x;
+    _parameter_declare(&duplicate_x, &a2, "x");
+
+    parameter_t* expected = parameter_find(&a2, "x");
+    POINTERS_EQUAL(expected, parameter_find(&rootns, "test_a/zwei/x"));
+}
+
+TEST(ParameterIndex, FindsSameNamespaceAsTreeSearchForDuplicateIds)
+{
+    parameter_namespace_t duplicate_a2;
+    parameter_namespace_declare(&duplicate_a2, &a, "zwei");
+
+    POINTERS_EQUAL(&duplicate_a2, parameter_namespace_find(&rootns, "test_a/zwei"));
+    POINTERS_EQUAL(NULL, parameter_find(&rootns, "test_a/zwei/x"));
+}
@@ -0,0 +1,156 @@
+#include "CppUTest/TestHarness.h"
+#include <parameter/parameter.h>
+#include <parameter/parameter_snapshot.h>
+
+TEST_GROUP (ParameterSnapshot) {
+    parameter_namespace_t rootns;
+    parameter_namespace_t pid;
+    parameter_namespace_t sub;
+    parameter_t kp;
+    parameter_t ki;
+    parameter_t enabled;
+    parameter_t limit;
+    parameter_t sub_x;
+
+    parameter_snapshot_t snap;
+    parameter_snapshot_entry_t entries[PARAMETER_SNAPSHOT_ENTRIES(4)];
+
+    void setup() override
+    {
+        parameter_namespace_declare(&rootns, nullptr, nullptr);
+        parameter_namespace_declare(&pid, &rootns, "pid");
+        parameter_namespace_declare(&sub, &pid, "sub");
+        parameter_scalar_declare_with_default(&kp, &pid, "kp", 1);
+        parameter_scalar_declare_with_default(&ki, &pid, "ki", 2);
+        parameter_boolean_declare_with_default(&enabled, &pid, "enabled", true);
+        parameter_integer_declare(&limit, &pid, "limit");
+        parameter_scalar_declare(&sub_x, &sub, "x");
+
+        parameter_snapshot_init(&snap, &pid, entries, 4);
+    }
+
+    /* reads kp from a view, giving it back immediately */
+    float latest_kp()
+    {
+        const parameter_snapshot_view_t* view = parameter_snapshot_acquire(&snap);
+        float res = parameter_snapshot_scalar(view, &kp);
+        parameter_snapshot_release(&snap, view);
+        return res;
+    }
+};
+
+TEST(ParameterSnapshot, CopiesDefinedParameters)
+{
+    const parameter_snapshot_view_t* view = parameter_snapshot_acquire(&snap);
+
+    CHECK_EQUAL(1, parameter_snapshot_scalar(view, &kp));
+    CHECK_EQUAL(2, parameter_snapshot_scalar(view, &ki));
+    CHECK_TRUE(parameter_snapshot_boolean(view, &enabled));
+    CHECK_FALSE(parameter_snapshot_contains(view, &limit));
+    CHECK_FALSE(parameter_snapshot_contains(view, &sub_x));
+
+    parameter_snapshot_release(&snap, view);
+}
+
+TEST(ParameterSnapshot, IsUpdatedWhenAParameterIsSet)
+{
+    const parameter_snapshot_view_t* view = parameter_snapshot_acquire(&snap);
+    uint32_t version = view->version;
+    parameter_snapshot_release(&snap, view);
+
+    parameter_scalar_set(&kp, 10);
+    parameter_integer_set(&limit, 42);
+
+    view = parameter_snapshot_acquire(&snap);
+    CHECK_EQUAL(10, parameter_snapshot_scalar(view, &kp));
+    CHECK_EQUAL(42, parameter_snapshot_integer(view, &limit));
+    CHECK_EQUAL(version + 2, view->version);
+    parameter_snapshot_release(&snap, view);
+}
+
+TEST(ParameterSnapshot, DoesNotChangeWhileAcquired)
+{
+    const parameter_snapshot_view_t* view = parameter_snapshot_acquire(&snap);
+
+    parameter_scalar_set(&kp, 10);
+    parameter_scalar_set(&kp, 20);
+    parameter_scalar_set(&kp, 30);
+
+    CHECK_EQUAL(1, parameter_snapshot_scalar(view, &kp));
+    CHECK_EQUAL(30, latest_kp());
+
+    parameter_snapshot_release(&snap, view);
+}
+
+TEST(ParameterSnapshot, ReusesViewsOnceReleased)
+{
+    const parameter_snapshot_view_t* first = parameter_snapshot_acquire(&snap);
+    parameter_scalar_set(&kp, 10);
+    const parameter_snapshot_view_t* second = parameter_snapshot_acquire(&snap);
+    parameter_scalar_set(&kp, 20);
+
+    CHECK_TRUE(first != second);
+    CHECK_EQUAL(1, parameter_snapshot_scalar(first, &kp));
+    CHECK_EQUAL(10, parameter_snapshot_scalar(second, &kp));
+
+    parameter_snapshot_release(&snap, first);
+    parameter_scalar_set(&kp, 30);
+
+    CHECK_EQUAL(10, parameter_snapshot_scalar(second, &kp));
+    CHECK_EQUAL(30, parameter_snapshot_scalar(first, &kp));
+    CHECK_EQUAL(30, latest_kp());
+
+    parameter_snapshot_release(&snap, second);
+}
+
+TEST(ParameterSnapshot, IsUpdatedByTheReaderReleasingAViewWhenAllAreInUse)
+{
+    const parameter_snapshot_view_t* views[PARAMETER_SNAPSHOT_SLOTS];
+    for (int i = 0; i < PARAMETER_SNAPSHOT_SLOTS; i++) {
+        views[i] = parameter_snapshot_acquire(&snap);
+        parameter_scalar_set(&kp, 10 * (i + 1));
+    }
+
+    /* The last set found all the views in use and did not wait */
+    CHECK_EQUAL(10 * (PARAMETER_SNAPSHOT_SLOTS - 1), parameter_snapshot_scalar(views[PARAMETER_SNAPSHOT_SLOTS - 1], &kp));
+
+    parameter_snapshot_release(&snap, views[0]);
+    CHECK_EQUAL(10 * PARAMETER_SNAPSHOT_SLOTS, latest_kp());
+
+    for (int i = 1; i < PARAMETER_SNAPSHOT_SLOTS; i++) {
+        parameter_snapshot_release(&snap, views[i]);
+    }
+}
+
+TEST(ParameterSnapshot, IsUpdatedOnceAtTheEndOfABatch)
+{
+    uint32_t version = snap.version;
+
+    parameter_batch_begin();
+    parameter_scalar_set(&kp, 10);
+    parameter_scalar_set(&ki, 20);
+    CHECK_EQUAL(1, latest_kp());
+    parameter_batch_end();
+
+    const parameter_snapshot_view_t* view = parameter_snapshot_acquire(&snap);
+    CHECK_EQUAL(10, parameter_snapshot_scalar(view, &kp));
+    CHECK_EQUAL(20, parameter_snapshot_scalar(view, &ki));
+    CHECK_EQUAL(version + 1, view->version);
+    parameter_snapshot_release(&snap, view);
+}
+
+TEST(ParameterSnapshot, InitDuringABatchIsCompletedAtItsEnd)
+{
+    parameter_snapshot_t other;
+    parameter_snapshot_entry_t other_entries[PARAMETER_SNAPSHOT_ENTRIES(4)];
+
+    parameter_batch_begin();
+    parameter_scalar_set(&kp, 10);
+    parameter_snapshot_init(&other, &pid, other_entries, 4);
+    parameter_scalar_set(&ki, 20);
+    parameter_batch_end();
+
+    const parameter_snapshot_view_t* view = parameter_snapshot_acquire(&other);
+    CHECK_EQUAL(20, parameter_snapshot_scalar(view, &ki));
+    parameter_snapshot_release(&other, view);
+}
@@ -0,0 +1,172 @@
+#include "CppUTest/TestHarness.h"
+#include <parameter/parameter.h>
+#include <parameter/parameter_msgpack.h>
+#include <cmp_mem_access/cmp_mem_access.h>
+
+static void count_cb(void* arg)
+{
+    (*(int*)arg)++;
+}
+
+TEST_GROUP (ParameterSubscription) {
+    parameter_namespace_t rootns;
+    parameter_namespace_t a;
+    parameter_namespace_t a1;
+    parameter_namespace_t b;
+    parameter_t a_x;
+    parameter_t a_y;
+    parameter_t a1_z;
+    parameter_t b_x;
+
+    parameter_subscription_t sub, other_sub;
+    int calls = 0, other_calls = 0;
+
+    void setup() override
+    {
+        parameter_namespace_declare(&rootns, nullptr, nullptr);
+        parameter_namespace_declare(&a, &rootns, "a");
+        parameter_namespace_declare(&a1, &a, "eins");
+        parameter_namespace_declare(&b, &rootns, "b");
+        parameter_scalar_declare(&a_x, &a, "x");
+        parameter_integer_declare(&a_y, &a, "y");
+        parameter_scalar_declare(&a1_z, &a1, "z");
+        parameter_scalar_declare(&b_x, &b, "x");
+    }
+};
+
+TEST(ParameterSubscription, IsCalledWhenParameterIsSet)
+{
+    parameter_subscribe(&sub, &a_x, count_cb, &calls);
+
+    parameter_scalar_set(&a_x, 1);
+    CHECK_EQUAL(1, calls);
+
+    parameter_integer_set(&a_y, 1);
+    CHECK_EQUAL(1, calls);
+}
+
+TEST(ParameterSubscription, IsCalledForEverySetEvenIfNotRead)
+{
+    parameter_subscribe(&sub, &a_x, count_cb, &calls);
+
+    parameter_scalar_set(&a_x, 1);
+    parameter_scalar_set(&a_x, 2);
+
+    CHECK_EQUAL(2, calls);
+}
+
+TEST(ParameterSubscription, ValueIsUpdatedWhenCalled)
+{
+    static parameter_t* param;
+    static float value;
+    param = &a_x;
+    parameter_subscribe(
+        &sub, &a_x, [](void* arg) {
+            (void)arg;
+            value = parameter_scalar_read(param);
+        },
+        nullptr);
+
+    parameter_scalar_set(&a_x, 42);
+
+    CHECK_EQUAL(42, value);
+}
+
+TEST(ParameterSubscription, NamespaceSubscriptionSeesNestedParameters)
+{
+    parameter_namespace_subscribe(&sub, &a, count_cb, &calls);
+
+    parameter_scalar_set(&a_x, 1);
+    parameter_scalar_set(&a1_z, 1);
+    CHECK_EQUAL(2, calls);
+
+    parameter_scalar_set(&b_x, 1);
+    CHECK_EQUAL(2, calls);
+}
+
+TEST(ParameterSubscription, SeveralSubscriptionsAreCalled)
+{
+    parameter_subscribe(&sub, &a_x, count_cb, &calls);
+    parameter_namespace_subscribe(&other_sub, &rootns, count_cb, &other_calls);
+
+    parameter_scalar_set(&a_x, 1);
+
+    CHECK_EQUAL(1, calls);
+    CHECK_EQUAL(1, other_calls);
+}
+
+TEST(ParameterSubscription, BatchCoalescesCalls)
+{
+    parameter_namespace_subscribe(&sub, &a, count_cb, &calls);
+    parameter_namespace_subscribe(&other_sub, &b, count_cb, &other_calls);
+
+    parameter_batch_begin();
+    parameter_scalar_set(&a_x, 1);
+    parameter_integer_set(&a_y, 1);
+    parameter_scalar_set(&a1_z, 1);
+    CHECK_EQUAL(0, calls);
+    parameter_batch_end();
+
+    CHECK_EQUAL(1, calls);
+    CHECK_EQUAL(0, other_calls);
+}
+
+TEST(ParameterSubscription, NestedBatchesNotifyAtTheEnd)
+{
+    parameter_subscribe(&sub, &a_x, count_cb, &calls);
+
+    parameter_batch_begin();
+    parameter_batch_begin();
+    parameter_scalar_set(&a_x, 1);
+    parameter_batch_end();
+    CHECK_EQUAL(0, calls);
+    parameter_scalar_set(&a_x, 2);
+    parameter_batch_end();
+
+    CHECK_EQUAL(1, calls);
+}
+
+TEST(ParameterSubscription, CanBeNotifiedAgainAfterBatch)
+{
+    parameter_subscribe(&sub, &a_x, count_cb, &calls);
+
+    parameter_batch_begin();
+    parameter_scalar_set(&a_x, 1);
+    parameter_batch_end();
+    parameter_batch_begin();
+    parameter_scalar_set(&a_x, 2);
+    parameter_batch_end();
+
+    CHECK_EQUAL(2, calls);
+}
+
+TEST(ParameterSubscription, MessagePackLoadIsOneBatch)
+{
+    char buffer[128];
+    cmp_mem_access_t mem;
+    cmp_ctx_t ctx;
+    cmp_mem_access_init(&ctx, &mem, buffer, sizeof buffer);
+
+    // {'a': {'x': 1., 'y': 2, 'eins': {'z': 3.}}}
+    cmp_write_map(&ctx, 1);
+    cmp_write_str(&ctx, "a", 1);
+    cmp_write_map(&ctx, 3);
+    cmp_write_str(&ctx, "x", 1);
+    cmp_write_float(&ctx, 1.);
+    cmp_write_str(&ctx, "y", 1);
+    cmp_write_s32(&ctx, 2);
+    cmp_write_str(&ctx, "eins", 4);
+    cmp_write_map(&ctx, 1);
+    cmp_write_str(&ctx, "z", 1);
+    cmp_write_float(&ctx, 3.);
+    cmp_mem_access_set_pos(&mem, 0);
+
+    parameter_namespace_subscribe(&sub, &rootns, count_cb, &calls);
+    parameter_subscribe(&other_sub, &a1_z, count_cb, &other_calls);
+
+    CHECK_EQUAL(0, parameter_msgpack_read_cmp(&rootns, &ctx, nullptr, nullptr));
+
+    CHECK_EQUAL(1, calls);
+    CHECK_EQUAL(1, other_calls);
+    CHECK_EQUAL(3., parameter_scalar_read(&a1_z));
+}
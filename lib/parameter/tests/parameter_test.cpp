@@ -200,3 +200,13 @@ TEST(ParameterTree, ParameterDefined)
     _parameter_changed_clear(&p_a2_z);
     CHECK_TRUE(parameter_defined(&p_a2_z));
 }
+
+TEST(ParameterTree, GenerationCountsSets)
+{
+    CHECK_EQUAL(0, parameter_generation(&p_a2_z));
+    _parameter_changed_set(&p_a2_z);
+    _parameter_changed_set(&p_a2_z);
+    CHECK_EQUAL(2, parameter_generation(&p_a2_z));
+    _parameter_changed_clear(&p_a2_z);
+    CHECK_EQUAL(2, parameter_generation(&p_a2_z));
+}
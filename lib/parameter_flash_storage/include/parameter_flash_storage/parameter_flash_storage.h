@@ -24,6 +24,70 @@ void parameter_flash_storage_save(void* dst, size_t dst_len, parameter_namespace
  * @note If no valid block is found the parameter tree is unchanged.
  */
 bool parameter_flash_storage_load(parameter_namespace_t* ns, void* src);
+
+/*
+ * Log structured storage.
+ *
+ * parameter_flash_storage_save() writes the whole tree on every save. A log
+ * instead appends a block holding only the parameters set since the previous
+ * save, as a MessagePack tree of the same shape. Loading replays the blocks in
+ * order, so the last value written for each parameter wins. When the sector is
+ * full, it is erased and the whole tree is written again as its first block.
+ *
+ * The log keeps in RAM the end of its last block and the generation (see
+ * parameter_generation()) of each parameter when it was last written, so a
+ * save neither scans the flash nor rewrites unchanged parameters.
+ */
+
+typedef struct {
+    const parameter_t* p;
+    uint32_t generation; // when it was last written, 0 if it never was
+} parameter_flash_log_entry_t;
+
+typedef struct {
+    parameter_namespace_t* ns;
+    uint8_t* sector;
+    size_t size;
+    size_t end; // offset of the first free byte in the sector
+    parameter_flash_log_entry_t* entries; // in tree order
+    size_t entries_len;
+    size_t entries_size;
+    bool synced; // false if the entries do not match the flash content
+} parameter_flash_log_t;
+
+/** Initializes a log of the tree ns, kept in the given flash sector.
+ *
+ * entries must hold at least one element per parameter in the tree. The
+ * sector is scanned once to find the end of the last valid block.
+ */
+void parameter_flash_log_init(parameter_flash_log_t* log,
+                              parameter_namespace_t* ns,
+                              void* sector,
+                              size_t size,
+                              parameter_flash_log_entry_t* entries,
+                              size_t entries_size);
+
+/** Loads the parameters by replaying all the blocks of the log.
+ *
+ * Sectors written by parameter_flash_storage_save() are read as well.
+ *
+ * @returns true if at least one block was found and all of them were loaded.
+ */
+bool parameter_flash_log_load(parameter_flash_log_t* log);
+
+/** Appends the parameters set since the last save or load.
+ *
+ * The sector is compacted first if the block does not fit, or if the log was
+ * not loaded or the tree changed since.
+ *
+ * @warning Compaction erases the only sector of the log before rewriting it,
+ * so a power loss during compaction loses every stored value.
+ *
+ * @returns false if the whole tree does not fit in the sector, or if there
+ * are more parameters than entries.
+ */
+bool parameter_flash_log_save(parameter_flash_log_t* log);
+
 #ifdef __cplusplus
 }
 #endif
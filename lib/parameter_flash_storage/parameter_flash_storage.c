@@ -3,6 +3,7 @@
 #include <parameter_flash_storage/parameter_flash_storage_private.h>
 #include <parameter_flash_storage/flash.h>
 #include <parameter/parameter_msgpack.h>
+#include <parameter/parameter_port.h>
 #include <cmp/cmp.h>
 #include <cmp_mem_access/cmp_mem_access.h>
 #include <crc/crc32.h>
@@ -210,3 +211,322 @@ void* parameter_flash_storage_block_find_first_free(void* p)
 
     return block;
 }
+
+/*
+ * Log structured storage
+ */
+
+/* Walks the tree in the order of the entries: the parameters of a namespace,
+ * then each of its subspaces. Either rebuilds the entries or checks that they
+ * still match the tree. Must be called with the lock held. */
+static bool log_index_walk(parameter_flash_log_t* log,
+                           const parameter_namespace_t* ns,
+                           size_t* i,
+                           bool rebuild)
+{
+    const parameter_namespace_t* child;
+    const parameter_t* p;
+
+    for (p = ns->parameter_list; p != NULL; p = p->next) {
+        if (rebuild) {
+            if (*i >= log->entries_size) {
+                return false;
+            }
+            log->entries[*i].p = p;
+            log->entries[*i].generation = 0;
+        } else if (*i >= log->entries_len || log->entries[*i].p != p) {
+            return false;
+        }
+        (*i)++;
+    }
+
+    for (child = ns->subspaces; child != NULL; child = child->next) {
+        if (!log_index_walk(log, child, i, rebuild)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool log_index_build(parameter_flash_log_t* log)
+{
+    size_t i = 0;
+    bool success = log_index_walk(log, log->ns, &i, true);
+    log->entries_len = i;
+    return success;
+}
+
+static bool log_index_matches(parameter_flash_log_t* log)
+{
+    size_t i = 0;
+    return log_index_walk(log, log->ns, &i, false) && i == log->entries_len;
+}
+
+static bool log_needs_write(const parameter_flash_log_entry_t* e, bool full)
+{
+    return e->p->defined && (full || e->generation != e->p->generation);
+}
+
+/* Returns the number of parameters to write in ns and its subspaces, whose
+ * entries start at *i, and moves *i past them. */
+static uint32_t log_count(const parameter_flash_log_t* log,
+                          const parameter_namespace_t* ns,
+                          size_t* i,
+                          bool full)
+{
+    const parameter_namespace_t* child;
+    const parameter_t* p;
+    uint32_t count = 0;
+
+    for (p = ns->parameter_list; p != NULL; p = p->next) {
+        if (log_needs_write(&log->entries[*i], full)) {
+            count++;
+        }
+        (*i)++;
+    }
+
+    for (child = ns->subspaces; child != NULL; child = child->next) {
+        count += log_count(log, child, i, full);
+    }
+
+    return count;
+}
+
+/* Writes the parameters to save as a tree, leaving out the namespaces
+ * containing none of them. */
+static bool log_write_tree(const parameter_flash_log_t* log,
+                           const parameter_namespace_t* ns,
+                           size_t* i,
+                           bool full,
+                           cmp_ctx_t* cmp)
+{
+    const parameter_namespace_t* child;
+    const parameter_t* p;
+    uint32_t map_size = 0;
+    size_t j = *i;
+    bool success;
+
+    for (p = ns->parameter_list; p != NULL; p = p->next) {
+        if (log_needs_write(&log->entries[j], full)) {
+            map_size++;
+        }
+        j++;
+    }
+
+    for (child = ns->subspaces; child != NULL; child = child->next) {
+        if (log_count(log, child, &j, full) > 0) {
+            map_size++;
+        }
+    }
+
+    success = cmp_write_map(cmp, map_size);
+
+    for (p = ns->parameter_list; p != NULL; p = p->next) {
+        if (log_needs_write(&log->entries[*i], full)) {
+            success &= cmp_write_str(cmp, p->id, strlen(p->id));
+            success &= parameter_msgpack_write_value(p, cmp);
+        }
+        (*i)++;
+    }
+
+    for (child = ns->subspaces; child != NULL; child = child->next) {
+        j = *i;
+        if (log_count(log, child, &j, full) > 0) {
+            success &= cmp_write_str(cmp, child->id, strlen(child->id));
+            success &= log_write_tree(log, child, i, full, cmp);
+        } else {
+            *i = j;
+        }
+    }
+
+    return success;
+}
+
+static size_t cmp_count_writer(struct cmp_ctx_s* ctx, const void* data, size_t len)
+{
+    (void)data;
+    *(size_t*)ctx->buf += len;
+    return len;
+}
+
+/* Appends a block with the parameters to save, unless there are none. Must
+ * be called with the lock held and the flash unlocked. The block is small, so
+ * unlike the sector erase, writing it with the lock held is acceptable (as
+ * parameter_flash_storage_save() does).
+ * Returns false if the block does not fit in the sector. */
+static bool log_append(parameter_flash_log_t* log, bool full)
+{
+    cmp_ctx_t cmp;
+    cmp_mem_access_t mem;
+    size_t i = 0;
+    size_t len = 0;
+    uint8_t* block = log->sector + log->end;
+
+    if (!full && log_count(log, log->ns, &i, false) == 0) {
+        return true;
+    }
+
+    /* Measure the block first, so that a block which does not fit is never
+     * partially written. */
+    i = 0;
+    cmp_init(&cmp, &len, NULL, cmp_count_writer);
+    log_write_tree(log, log->ns, &i, full, &cmp);
+
+    if (len + len % 2 + PARAMETER_FLASH_STORAGE_HEADER_SIZE > log->size - log->end) {
+        return false;
+    }
+
+    i = 0;
+    cmp_mem_access_init(&cmp, &mem, block + PARAMETER_FLASH_STORAGE_HEADER_SIZE, len);
+    cmp.write = cmp_flash_writer;
+    if (!log_write_tree(log, log->ns, &i, full, &cmp)) {
+        return false;
+    }
+
+    /* Keep blocks 16 bits aligned for the STM32F3s, see
+     * parameter_flash_storage_save(). */
+    if (len % 2 == 1) {
+        uint8_t data = 0x00;
+        flash_write(block + PARAMETER_FLASH_STORAGE_HEADER_SIZE + len, &data, 1);
+        len++;
+    }
+
+    parameter_flash_storage_write_block_header(block, len);
+    log->end += PARAMETER_FLASH_STORAGE_HEADER_SIZE + len;
+
+    for (i = 0; i < log->entries_len; i++) {
+        if (log->entries[i].p->defined) {
+            log->entries[i].generation = log->entries[i].p->generation;
+        }
+    }
+
+    return true;
+}
+
+/* Returns true if a valid block fits at the given offset, and its length. */
+static bool log_block_at(const parameter_flash_log_t* log, size_t offset, uint32_t* len)
+{
+    uint8_t* block = log->sector + offset;
+
+    if (log->size - offset < PARAMETER_FLASH_STORAGE_HEADER_SIZE) {
+        return false;
+    }
+
+    *len = parameter_flash_storage_block_get_length(block);
+    if (*len > log->size - offset - PARAMETER_FLASH_STORAGE_HEADER_SIZE) {
+        return false;
+    }
+
+    return parameter_flash_storage_block_is_valid(block);
+}
+
+/* Returns true if the flash after the last block is erased, false if it holds
+ * a corrupted block (eg. interrupted by a reset) which cannot be written over. */
+static bool log_end_is_erased(const parameter_flash_log_t* log)
+{
+    size_t i;
+
+    for (i = log->end; i < log->size && i < log->end + PARAMETER_FLASH_STORAGE_HEADER_SIZE; i++) {
+        if (log->sector[i] != 0xff) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void parameter_flash_log_init(parameter_flash_log_t* log,
+                              parameter_namespace_t* ns,
+                              void* sector,
+                              size_t size,
+                              parameter_flash_log_entry_t* entries,
+                              size_t entries_size)
+{
+    uint32_t len;
+
+    log->ns = ns;
+    log->sector = (uint8_t*)sector;
+    log->size = size;
+    log->end = 0;
+    log->entries = entries;
+    log->entries_len = 0;
+    log->entries_size = entries_size;
+    log->synced = false;
+
+    while (log_block_at(log, log->end, &len)) {
+        log->end += PARAMETER_FLASH_STORAGE_HEADER_SIZE + len;
+    }
+}
+
+bool parameter_flash_log_load(parameter_flash_log_t* log)
+{
+    size_t offset = 0;
+    size_t i;
+    uint32_t len;
+    bool found = false;
+    bool success = true;
+    bool indexed;
+
+    /* Keep the generations from before the load, to know which parameters
+     * were found in the flash. */
+    parameter_port_lock();
+    indexed = log_index_build(log);
+    for (i = 0; i < log->entries_len; i++) {
+        log->entries[i].generation = log->entries[i].p->generation;
+    }
+    parameter_port_unlock();
+
+    while (log_block_at(log, offset, &len)) {
+        if (parameter_msgpack_read(log->ns,
+                                   log->sector + offset + PARAMETER_FLASH_STORAGE_HEADER_SIZE,
+                                   len, err_mark_false, &success)
+            != 0) {
+            success = false;
+        }
+        offset += PARAMETER_FLASH_STORAGE_HEADER_SIZE + len;
+        found = true;
+    }
+
+    parameter_port_lock();
+    for (i = 0; i < log->entries_len; i++) {
+        parameter_flash_log_entry_t* e = &log->entries[i];
+        e->generation = (e->p->generation != e->generation) ? e->p->generation : 0;
+    }
+    log->end = offset;
+    log->synced = indexed && found && success && log_end_is_erased(log);
+    parameter_port_unlock();
+
+    return found && success;
+}
+
+bool parameter_flash_log_save(parameter_flash_log_t* log)
+{
+    bool success;
+    bool indexed;
+
+    flash_unlock();
+
+    parameter_port_lock();
+    success = log->synced && log_index_matches(log) && log_append(log, false);
+    indexed = success || log_index_build(log);
+    log->synced = success;
+    parameter_port_unlock();
+
+    if (!success && indexed) {
+        /* Compact the log by writing the whole tree in a new sector. The
+         * erase takes milliseconds, so it is done without the lock, which is
+         * a critical section on some ports. */
+        flash_sector_erase(log->sector);
+
+        parameter_port_lock();
+        log->end = 0;
+        success = log_index_build(log) && log_append(log, true);
+        log->synced = success;
+        parameter_port_unlock();
+    }
+
+    flash_lock();
+
+    return success;
+}
@@ -0,0 +1,230 @@
+#include <CppUTest/TestHarness.h>
+#include <CppUTestExt/MockSupport.h>
+#include <parameter_flash_storage/parameter_flash_storage.h>
+#include <parameter_flash_storage/parameter_flash_storage_private.h>
+#include <parameter/parameter_msgpack.h>
+#include <cstring>
+
+static void err_cb(void* arg, const char* id, const char* err)
+{
+    (void)arg;
+    (void)id;
+    FAIL(err);
+}
+
+TEST_GROUP (ParameterFlashLogTestGroup) {
+    uint8_t data[256];
+    parameter_namespace_t ns, control;
+    parameter_t foo, kp, ki;
+    parameter_flash_log_entry_t entries[3];
+    parameter_flash_log_t log;
+
+    void setup() override
+    {
+        mock("flash").ignoreOtherCalls();
+
+        // Erased flash
+        memset(data, 0xff, sizeof(data));
+
+        parameter_namespace_declare(&ns, nullptr, nullptr);
+        parameter_namespace_declare(&control, &ns, "control");
+        parameter_integer_declare(&foo, &ns, "foo");
+        parameter_scalar_declare(&kp, &control, "kp");
+        parameter_scalar_declare(&ki, &control, "ki");
+
+        parameter_integer_set(&foo, 10);
+        parameter_scalar_set(&kp, 1);
+        parameter_scalar_set(&ki, 2);
+
+        parameter_flash_log_init(&log, &ns, data, sizeof(data), entries, 3);
+    }
+
+    // Loads the parameters back through a new log, as after a reset
+    bool reload()
+    {
+        parameter_flash_log_init(&log, &ns, data, sizeof(data), entries, 3);
+        return parameter_flash_log_load(&log);
+    }
+};
+
+TEST(ParameterFlashLogTestGroup, FirstSaveWritesTheWholeTree)
+{
+    mock("flash").expectOneCall("erase").withParameter("sector", data);
+
+    CHECK_TRUE(parameter_flash_log_save(&log));
+
+    parameter_integer_set(&foo, 0);
+    parameter_scalar_set(&kp, 0);
+    parameter_scalar_set(&ki, 0);
+
+    // The first block can be read as a regular save
+    CHECK_TRUE(parameter_flash_storage_load(&ns, data));
+    CHECK_EQUAL(10, parameter_integer_get(&foo));
+    CHECK_EQUAL(1, parameter_scalar_get(&kp));
+    CHECK_EQUAL(2, parameter_scalar_get(&ki));
+}
+
+TEST(ParameterFlashLogTestGroup, SaveAppendsOnlyTheChangedParameters)
+{
+    parameter_flash_log_save(&log);
+    size_t first_len = parameter_flash_storage_block_get_length(data);
+
+    parameter_scalar_set(&kp, 3);
+    CHECK_TRUE(parameter_flash_log_save(&log));
+
+    void* block = parameter_flash_storage_block_find_last_used(data);
+    POINTERS_EQUAL(&data[first_len + PARAMETER_FLASH_STORAGE_HEADER_SIZE], block);
+    CHECK_TRUE(parameter_flash_storage_block_get_length(block) < first_len);
+
+    // Reading the last block alone only restores kp
+    parameter_integer_set(&foo, 0);
+    parameter_scalar_set(&kp, 0);
+    CHECK_TRUE(parameter_flash_storage_load(&ns, data));
+    CHECK_EQUAL(3, parameter_scalar_get(&kp));
+    CHECK_EQUAL(0, parameter_integer_get(&foo));
+}
+
+TEST(ParameterFlashLogTestGroup, SavingWithoutChangesWritesNothing)
+{
+    parameter_flash_log_save(&log);
+    size_t end = log.end;
+
+    CHECK_TRUE(parameter_flash_log_save(&log));
+
+    CHECK_EQUAL(end, log.end);
+}
+
+TEST(ParameterFlashLogTestGroup, LoadReplaysAllBlocks)
+{
+    parameter_flash_log_save(&log);
+    parameter_scalar_set(&kp, 3);
+    parameter_flash_log_save(&log);
+    parameter_scalar_set(&ki, 4);
+    parameter_flash_log_save(&log);
+
+    parameter_integer_set(&foo, 0);
+    parameter_scalar_set(&kp, 0);
+    parameter_scalar_set(&ki, 0);
+
+    CHECK_TRUE(reload());
+    CHECK_EQUAL(10, parameter_integer_get(&foo));
+    CHECK_EQUAL(3, parameter_scalar_get(&kp));
+    CHECK_EQUAL(4, parameter_scalar_get(&ki));
+}
+
+TEST(ParameterFlashLogTestGroup, SaveAfterLoadAppends)
+{
+    parameter_flash_log_save(&log);
+    reload();
+    size_t end = log.end;
+
+    parameter_scalar_set(&kp, 3);
+    CHECK_TRUE(parameter_flash_log_save(&log));
+
+    CHECK_TRUE(log.end > end);
+    CHECK_TRUE(reload());
+    CHECK_EQUAL(3, parameter_scalar_get(&kp));
+}
+
+TEST(ParameterFlashLogTestGroup, LoadFailsOnEmptyFlash)
+{
+    CHECK_FALSE(parameter_flash_log_load(&log));
+    CHECK_EQUAL(10, parameter_integer_get(&foo));
+}
+
+TEST(ParameterFlashLogTestGroup, CompactsWhenTheSectorIsFull)
+{
+    parameter_flash_log_save(&log);
+    size_t first_len = parameter_flash_storage_block_get_length(data);
+
+    // Each save appends a block until there is no space left
+    float kp_value = 10;
+    while (log.end + PARAMETER_FLASH_STORAGE_HEADER_SIZE + first_len < sizeof(data)) {
+        parameter_scalar_set(&kp, ++kp_value);
+        CHECK_TRUE(parameter_flash_log_save(&log));
+    }
+
+    mock("flash").expectOneCall("erase").withParameter("sector", data);
+    parameter_integer_set(&foo, 20);
+    parameter_scalar_set(&kp, ++kp_value);
+    parameter_scalar_set(&ki, 5);
+    CHECK_TRUE(parameter_flash_log_save(&log));
+
+    // The whole tree was written again as the first block. The flash mock
+    // only erases the first byte of the sector, so the old blocks following
+    // it are still there and the first block is read directly.
+    CHECK_EQUAL(first_len + PARAMETER_FLASH_STORAGE_HEADER_SIZE, log.end);
+    CHECK_TRUE(parameter_flash_storage_block_is_valid(data));
+    parameter_integer_set(&foo, 0);
+    parameter_scalar_set(&kp, 0);
+    parameter_scalar_set(&ki, 0);
+    CHECK_EQUAL(0, parameter_msgpack_read(&ns, &data[PARAMETER_FLASH_STORAGE_HEADER_SIZE], first_len, err_cb, nullptr));
+    CHECK_EQUAL(20, parameter_integer_get(&foo));
+    CHECK_EQUAL(kp_value, parameter_scalar_get(&kp));
+    CHECK_EQUAL(5, parameter_scalar_get(&ki));
+}
+
+TEST(ParameterFlashLogTestGroup, CorruptedBlockIsIgnored)
+{
+    parameter_flash_log_save(&log);
+    size_t first_end = log.end;
+    parameter_scalar_set(&kp, 3);
+    parameter_flash_log_save(&log);
+
+    // For example a save interrupted by a reset
+    data[log.end - 1] ^= 0x40;
+
+    CHECK_TRUE(reload());
+    CHECK_EQUAL(1, parameter_scalar_get(&kp));
+
+    // The corrupted block cannot be written over, so the log is compacted
+    mock("flash").expectOneCall("erase").withParameter("sector", data);
+    parameter_scalar_set(&ki, 4);
+    CHECK_TRUE(parameter_flash_log_save(&log));
+    CHECK_EQUAL(first_end, log.end);
+}
+
+TEST(ParameterFlashLogTestGroup, CanLoadRegularSaves)
+{
+    parameter_flash_storage_save(data, sizeof(data), &ns);
+    parameter_scalar_set(&kp, 3);
+    parameter_flash_storage_save(data, sizeof(data), &ns);
+    parameter_scalar_set(&kp, 0);
+
+    CHECK_TRUE(reload());
+    CHECK_EQUAL(3, parameter_scalar_get(&kp));
+}
+
+TEST(ParameterFlashLogTestGroup, NewParametersAreSavedAfterLoad)
+{
+    parameter_flash_log_save(&log);
+
+    // For example added by a firmware update
+    parameter_t kd;
+    parameter_scalar_declare(&kd, &control, "kd");
+    parameter_scalar_set(&kd, 5);
+    parameter_flash_log_entry_t more_entries[4];
+    parameter_flash_log_init(&log, &ns, data, sizeof(data), more_entries, 4);
+
+    // The parameter was not found in the flash, so it is written by the next save
+    CHECK_TRUE(parameter_flash_log_load(&log));
+    CHECK_TRUE(parameter_flash_log_save(&log));
+    parameter_scalar_set(&kd, 0);
+    CHECK_TRUE(parameter_flash_log_load(&log));
+    CHECK_EQUAL(5, parameter_scalar_get(&kd));
+}
+
+TEST(ParameterFlashLogTestGroup, SaveFailsIfThereAreNotEnoughEntries)
+{
+    parameter_t kd;
+    parameter_scalar_declare(&kd, &control, "kd");
+
+    CHECK_FALSE(parameter_flash_log_save(&log));
+}
+
+TEST(ParameterFlashLogTestGroup, SaveFailsIfTheTreeDoesNotFit)
+{
+    parameter_flash_log_init(&log, &ns, data, 16, entries, 3);
+
+    CHECK_FALSE(parameter_flash_log_save(&log));
+}
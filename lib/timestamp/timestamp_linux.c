@@ -0,0 +1,16 @@
+#include <time.h>
+
+#include <timestamp/timestamp.h>
+
+/* Same clock as clock_gettime(CLOCK_MONOTONIC), in us */
+ltimestamp_t ltimestamp_get(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ltimestamp_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+timestamp_t timestamp_get(void)
+{
+    return (timestamp_t)ltimestamp_get();
+}
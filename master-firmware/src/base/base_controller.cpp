@@ -1,110 +1,174 @@
-#include <thread>
 #include <math.h>
+#include <thread>
+#include <absl/flags/flag.h>
 
 #include <error/error.h>
+#include <parameter/parameter_snapshot.h>
 
 #include <aversive/trajectory_manager/trajectory_manager.h>
 #include <aversive/trajectory_manager/trajectory_manager_utils.h>
 #include <aversive/trajectory_manager/trajectory_manager_core.h>
+#include <aversive/control_system_manager/control_system.hpp>
 
 #include "main.h"
 #include "config.h"
+#include "config_accessors.h"
 
 #include "rs_port.h"
 #include "base_controller.h"
+#include "periodic_task.hpp"
+#include "can/motor_driver_uavcan.hpp"
+#include "debug/control_latency.hpp"
+#include "protobuf/encoders.pb.h"
 #include "protobuf/position.pb.h"
 
 #define BASE_CONTROLLER_STACKSIZE 1024
 #define POSITION_MANAGER_STACKSIZE 1024
 #define TRAJECTORY_MANAGER_STACKSIZE 2048
 
+/* Maximum number of parameters in the namespaces read through snapshots */
+#define PARAMS_SNAPSHOT_CAPACITY 8
+
 using namespace std::chrono_literals;
 
+ABSL_FLAG(int, control_priority, 0, "SCHED_FIFO priority of the control loops, 0 to use the default scheduler.");
+ABSL_FLAG(int, control_cpu, -1, "CPU to pin the control loops to, -1 to run them on any CPU.");
+ABSL_FLAG(bool, control_on_encoders, false,
+          "Run odometry and control in one pass as soon as /encoders is published, "
+          "instead of on their own timers, and send the motor setpoints right after each pass. "
+          "The encoders must be sent at the control frequency.");
+
+/** Fallback pass is run if no encoder data came in this long */
+#define CONTROL_WATCHDOG_TIMEOUT (2 * (1000ms / ASSERV_FREQUENCY))
+
 struct _robot robot;
 
-void robot_init()
+static PeriodicTask base_ctrl_task("base_ctrl", 1000ms / ASSERV_FREQUENCY);
+static PeriodicTask position_manager_task("position_manager", 1000ms / ODOM_FREQUENCY);
+static PeriodicTask trajectory_manager_task("trajectory_manager", 1000ms / ODOM_FREQUENCY);
+static PeriodicTask control_watchdog_task("control_watchdog", 1000ms / ASSERV_FREQUENCY);
+
+/* Control systems of the base, resolved at compile time. robot_init() also
+ * sets up the callbacks of the C control systems, for the C API. */
+using AnglePipeline = control_system::Pipeline<control_system::Filter<quadramp_do_filter>,
+                                               control_system::Identity,
+                                               control_system::Filter<cs_pid_process>,
+                                               control_system::Identity,
+                                               control_system::ProcessOut<rs_get_ext_angle>,
+                                               control_system::ProcessIn<rs_set_angle>>;
+
+static const AnglePipeline angle_pipeline{
+    {&robot.angle_qr}, {}, {&robot.angle_pid}, {}, {&robot.rs}, {&robot.rs}};
+
+using DistancePipeline = control_system::Pipeline<control_system::Filter<quadramp_do_filter>,
+                                                  control_system::Identity,
+                                                  control_system::Filter<cs_pid_process>,
+                                                  control_system::Identity,
+                                                  control_system::ProcessOut<rs_get_ext_distance>,
+                                                  control_system::ProcessIn<rs_set_distance>>;
+
+static const DistancePipeline distance_pipeline{
+    {&robot.distance_qr}, {}, {&robot.distance_pid}, {}, {&robot.rs}, {&robot.rs}};
+
+static void control_task_start(PeriodicTask* task, std::function<void()> body)
 {
-    absl::MutexLock _(&robot.lock);
+    task->set_realtime_priority(absl::GetFlag(FLAGS_control_priority));
+    task->set_cpu(absl::GetFlag(FLAGS_control_cpu));
+    task->start(std::move(body));
+}
 
-    robot.mode = BOARD_MODE_ANGLE_DISTANCE;
+void robot_init()
+{
     robot.base_speed = BASE_SPEED_FAST;
 
-    /* Motors */
-    static rs_motor_t left_wheel_motor = {.m = &motor_manager, .direction = 1.};
-    static rs_motor_t right_wheel_motor = {.m = &motor_manager, .direction = -1.};
-    rs_encoder_init();
+    {
+        absl::MutexLock _(&robot.cs_lock);
 
-    robot.angle_pid.divider = 100;
-    robot.distance_pid.divider = 100;
+        robot.mode = BOARD_MODE_ANGLE_DISTANCE;
 
-    /* Robot system initialisation, encoders and PWM */
-    rs_init(&robot.rs);
-    rs_set_flags(&robot.rs, RS_USE_EXT);
+        /* Motors */
+        static rs_motor_t left_wheel_motor = {.m = &motor_manager, .direction = 1.};
+        static rs_motor_t right_wheel_motor = {.m = &motor_manager, .direction = -1.};
+        rs_encoder_init();
 
-    rs_set_left_pwm(&robot.rs, rs_left_wheel_set_voltage, &left_wheel_motor);
-    rs_set_right_pwm(&robot.rs, rs_right_wheel_set_voltage, &right_wheel_motor);
+        robot.angle_pid.divider = 100;
+        robot.distance_pid.divider = 100;
 
-    rs_set_left_ext_encoder(&robot.rs, rs_encoder_get_left_ext, nullptr,
-                            config_get_scalar("master/odometry/left_wheel_correction_factor"));
-    rs_set_right_ext_encoder(&robot.rs, rs_encoder_get_right_ext, nullptr,
-                             config_get_scalar("master/odometry/right_wheel_correction_factor"));
+        /* Robot system initialisation, encoders and PWM */
+        rs_init(&robot.rs);
+        rs_set_flags(&robot.rs, RS_USE_EXT);
 
-    /* Position manager */
-    position_init(&robot.pos);
-    position_set_related_robot_system(&robot.pos, &robot.rs); // Link pos manager to robot system
+        rs_set_left_pwm(&robot.rs, rs_left_wheel_set_voltage, &left_wheel_motor);
+        rs_set_right_pwm(&robot.rs, rs_right_wheel_set_voltage, &right_wheel_motor);
 
-    position_set_physical_params(&robot.pos,
-                                 config_get_scalar("master/odometry/external_track_mm"),
-                                 config_get_scalar("master/odometry/external_encoder_ticks_per_mm"));
-    position_use_ext(&robot.pos);
-
-    position_set(&robot.pos, 200, 1000, 0);
-
-    /* Base angle controller */
-    pid_init(&robot.angle_pid.pid);
-    quadramp_init(&robot.angle_qr);
-
-    cs_init(&robot.angle_cs);
-    cs_set_consign_filter(&robot.angle_cs, quadramp_do_filter, &robot.angle_qr); // Filter acceleration
-    cs_set_correct_filter(&robot.angle_cs, cs_pid_process, &robot.angle_pid.pid);
-    cs_set_process_in(&robot.angle_cs, rs_set_angle, &robot.rs); // Output on angular virtual pwm
-    cs_set_process_out(&robot.angle_cs, rs_get_ext_angle, &robot.rs); // Read angular virtuan encoder
-    cs_set_consign(&robot.angle_cs, 0);
-
-    /* Base distance controller */
-    pid_init(&robot.distance_pid.pid);
-    quadramp_init(&robot.distance_qr);
-
-    cs_init(&robot.distance_cs);
-    cs_set_consign_filter(&robot.distance_cs, quadramp_do_filter, &robot.distance_qr); // Filter acceleration
-    cs_set_correct_filter(&robot.distance_cs, cs_pid_process, &robot.distance_pid.pid);
-    cs_set_process_in(&robot.distance_cs, rs_set_distance, &robot.rs); // Output on distance virtual pwm
-    cs_set_process_out(&robot.distance_cs, rs_get_ext_distance, &robot.rs); // Read distance virtuan encoder
-    cs_set_consign(&robot.distance_cs, 0);
+        rs_set_left_ext_encoder(&robot.rs, rs_encoder_get_left_ext, nullptr,
+                                config_master_odometry_left_wheel_correction_factor());
+        rs_set_right_ext_encoder(&robot.rs, rs_encoder_get_right_ext, nullptr,
+                                 config_master_odometry_right_wheel_correction_factor());
+
+        /* Position manager */
+        position_init(&robot.pos);
+        position_set_related_robot_system(&robot.pos, &robot.rs); // Link pos manager to robot system
+
+        position_set_physical_params(&robot.pos,
+                                     config_master_odometry_external_track_mm(),
+                                     config_master_odometry_external_encoder_ticks_per_mm());
+        position_use_ext(&robot.pos);
+
+        position_set(&robot.pos, 200, 1000, 0);
+
+        /* Base angle controller */
+        pid_init(&robot.angle_pid.pid);
+        quadramp_init(&robot.angle_qr);
+
+        cs_init(&robot.angle_cs);
+        cs_set_consign_filter(&robot.angle_cs, quadramp_do_filter, &robot.angle_qr); // Filter acceleration
+        cs_set_correct_filter(&robot.angle_cs, cs_pid_process, &robot.angle_pid.pid);
+        cs_set_process_in(&robot.angle_cs, rs_set_angle, &robot.rs); // Output on angular virtual pwm
+        cs_set_process_out(&robot.angle_cs, rs_get_ext_angle, &robot.rs); // Read angular virtuan encoder
+        cs_set_consign(&robot.angle_cs, 0);
+
+        /* Base distance controller */
+        pid_init(&robot.distance_pid.pid);
+        quadramp_init(&robot.distance_qr);
+
+        cs_init(&robot.distance_cs);
+        cs_set_consign_filter(&robot.distance_cs, quadramp_do_filter, &robot.distance_qr); // Filter acceleration
+        cs_set_correct_filter(&robot.distance_cs, cs_pid_process, &robot.distance_pid.pid);
+        cs_set_process_in(&robot.distance_cs, rs_set_distance, &robot.rs); // Output on distance virtual pwm
+        cs_set_process_out(&robot.distance_cs, rs_get_ext_distance, &robot.rs); // Read distance virtuan encoder
+        cs_set_consign(&robot.distance_cs, 0);
+    }
 
     /* Trajector manager */
     trajectory_manager_init(&robot.traj, ASSERV_FREQUENCY);
     trajectory_set_cs(&robot.traj, &robot.distance_cs, &robot.angle_cs);
     trajectory_set_robot_params(&robot.traj, &robot.rs, &robot.pos);
+    trajectory_set_cs_lock(&robot.traj, &robot.cs_lock);
 
     // Distance window, angle window, angle start
     trajectory_set_windows(
         &robot.traj,
-        config_get_scalar("master/aversive/trajectories/windows/distance"),
-        config_get_scalar("master/aversive/trajectories/windows/angle"),
-        config_get_scalar("master/aversive/trajectories/windows/angle_start"));
+        config_master_aversive_trajectories_windows_distance(),
+        config_master_aversive_trajectories_windows_angle(),
+        config_master_aversive_trajectories_windows_angle_start());
 
     /* Initialize blocking detection managers */
-    bd_init(&robot.angle_bd);
-    bd_init(&robot.distance_bd);
+    {
+        absl::MutexLock _(&robot.bd_lock);
+        bd_init(&robot.angle_bd);
+        bd_init(&robot.distance_bd);
+        bd_set_thresholds(&robot.distance_bd, 15000, 1);
+        bd_set_thresholds(&robot.angle_bd, 15000, 1);
+    }
 
     /* Set calibration side */
-    robot.calibration_direction = (enum direction_t)config_get_integer("master/calibration_direction");
+    robot.calibration_direction = (enum direction_t)config_master_calibration_direction();
 
     /* Set obstacle inflation sizes */
-    robot.robot_size = config_get_integer("master/robot_size_x_mm");
-    robot.alignement_length = config_get_integer("master/robot_alignment_length_mm");
-    robot.opponent_size = config_get_integer("master/opponent_size_x_mm_default");
+    robot.robot_size = config_master_robot_size_x_mm();
+    robot.alignement_length = config_master_robot_alignment_length_mm();
+    robot.opponent_size = config_master_opponent_size_x_mm_default();
 
     /* Set some defaultj speed and acc. */
     trajectory_set_speed(&robot.traj,
@@ -113,149 +177,404 @@ void robot_init()
     trajectory_set_acc(&robot.traj,
                        acc_mm2imp(&robot.traj, 3000.),
                        acc_rd2imp(&robot.traj, 30.));
-    bd_set_thresholds(&robot.distance_bd, 15000, 1);
-    bd_set_thresholds(&robot.angle_bd, 15000, 1);
 }
 
-static void base_ctrl_thd()
+/** Parameter resolved once, with its last read value */
+struct cached_param {
+    parameter_t* param;
+    float value;
+    uint32_t generation; // of the parameter when value was read
+};
+
+/** Consistent copy of the parameters of a namespace, so that a set of gains
+ * is never applied half updated, with the version applied last. */
+struct params_snapshot {
+    parameter_snapshot_t snapshot;
+    parameter_snapshot_entry_t entries[PARAMETER_SNAPSHOT_ENTRIES(PARAMS_SNAPSHOT_CAPACITY)];
+    uint32_t applied_version;
+};
+
+struct pid_params {
+    parameter_t *kp, *ki, *kd, *i_limit;
+    params_snapshot snapshot;
+};
+
+struct odometry_params {
+    parameter_t *left_wheel_correction_factor, *right_wheel_correction_factor;
+    parameter_t *external_track_mm, *external_encoder_ticks_per_mm;
+    params_snapshot snapshot;
+};
+
+struct speed_params {
+    cached_param distance_speed, angle_speed;
+    cached_param distance_acc, angle_acc;
+};
+
+/* Parameters used by the control loop, resolved once at startup through the
+ * generated accessors so that the loop never walks the parameter tree. */
+static struct {
+    pid_params angle_pid, distance_pid;
+    odometry_params odometry;
+    speed_params speeds[BASE_SPEED_FAST + 1]; // Indexed by enum base_speed_t
+} base_params;
+
+static void cached_param_init(cached_param* p, parameter_t* param)
+{
+    p->param = param;
+    p->generation = parameter_generation(param);
+    p->value = parameter_scalar_read(param);
+}
+
+/** Refreshes the value if the parameter was set since it was last read,
+ * returns true if it was. */
+static bool cached_param_update(cached_param* p)
 {
-    parameter_namespace_t* control_params = parameter_namespace_find(&master_config, "aversive/control");
-    parameter_namespace_t* odometry_params = parameter_namespace_find(&master_config, "odometry");
+    if (!config_changed_since(p->param, &p->generation)) {
+        return false;
+    }
+    p->value = parameter_scalar_read(p->param);
+    return true;
+}
 
-    while (true) {
-        robot.lock.Lock();
+/** The snapshot covers the namespace of the given parameter */
+static void params_snapshot_init(params_snapshot* s, parameter_t* param)
+{
+    parameter_snapshot_init(&s->snapshot, param->ns, s->entries, PARAMS_SNAPSHOT_CAPACITY);
+    s->applied_version = 0; // applied on the first pass
+}
+
+/** Returns the latest copy if it was not applied yet, nullptr otherwise. A
+ * returned copy must be given back with parameter_snapshot_release(). */
+static const parameter_snapshot_view_t* params_snapshot_acquire_new(params_snapshot* s)
+{
+    const parameter_snapshot_view_t* view = parameter_snapshot_acquire(&s->snapshot);
+    if (view->version == s->applied_version) {
+        parameter_snapshot_release(&s->snapshot, view);
+        return nullptr;
+    }
+    s->applied_version = view->version;
+    return view;
+}
+
+static void pid_params_init(pid_params* pid, parameter_t* kp, parameter_t* ki, parameter_t* kd, parameter_t* i_limit)
+{
+    pid->kp = kp;
+    pid->ki = ki;
+    pid->kd = kd;
+    pid->i_limit = i_limit;
+    params_snapshot_init(&pid->snapshot, kp);
+}
+
+static void speed_params_init(speed_params* speed,
+                              parameter_t* distance_speed,
+                              parameter_t* angle_speed,
+                              parameter_t* distance_acc,
+                              parameter_t* angle_acc)
+{
+    cached_param_init(&speed->distance_speed, distance_speed);
+    cached_param_init(&speed->angle_speed, angle_speed);
+    cached_param_init(&speed->distance_acc, distance_acc);
+    cached_param_init(&speed->angle_acc, angle_acc);
+}
+
+static void base_params_init()
+{
+    pid_params_init(&base_params.angle_pid,
+                    config_master_aversive_control_angle_kp_param(),
+                    config_master_aversive_control_angle_ki_param(),
+                    config_master_aversive_control_angle_kd_param(),
+                    config_master_aversive_control_angle_i_limit_param());
+    pid_params_init(&base_params.distance_pid,
+                    config_master_aversive_control_distance_kp_param(),
+                    config_master_aversive_control_distance_ki_param(),
+                    config_master_aversive_control_distance_kd_param(),
+                    config_master_aversive_control_distance_i_limit_param());
+
+    odometry_params* odometry = &base_params.odometry;
+    odometry->left_wheel_correction_factor = config_master_odometry_left_wheel_correction_factor_param();
+    odometry->right_wheel_correction_factor = config_master_odometry_right_wheel_correction_factor_param();
+    odometry->external_track_mm = config_master_odometry_external_track_mm_param();
+    odometry->external_encoder_ticks_per_mm = config_master_odometry_external_encoder_ticks_per_mm_param();
+    params_snapshot_init(&odometry->snapshot, odometry->external_track_mm);
+
+    speed_params_init(&base_params.speeds[BASE_SPEED_INIT],
+                      config_master_aversive_trajectories_distance_speed_init_param(),
+                      config_master_aversive_trajectories_angle_speed_init_param(),
+                      config_master_aversive_trajectories_distance_acceleration_init_param(),
+                      config_master_aversive_trajectories_angle_acceleration_init_param());
+    speed_params_init(&base_params.speeds[BASE_SPEED_SLOW],
+                      config_master_aversive_trajectories_distance_speed_slow_param(),
+                      config_master_aversive_trajectories_angle_speed_slow_param(),
+                      config_master_aversive_trajectories_distance_acceleration_slow_param(),
+                      config_master_aversive_trajectories_angle_acceleration_slow_param());
+    speed_params_init(&base_params.speeds[BASE_SPEED_FAST],
+                      config_master_aversive_trajectories_distance_speed_fast_param(),
+                      config_master_aversive_trajectories_angle_speed_fast_param(),
+                      config_master_aversive_trajectories_distance_acceleration_fast_param(),
+                      config_master_aversive_trajectories_angle_acceleration_fast_param());
+}
+
+static void pid_params_update(pid_params* params, pid_ctrl_t* pid)
+{
+    const parameter_snapshot_view_t* view = params_snapshot_acquire_new(&params->snapshot);
+    if (view == nullptr) {
+        return;
+    }
+    pid_set_gains(pid,
+                  parameter_snapshot_scalar(view, params->kp),
+                  parameter_snapshot_scalar(view, params->ki),
+                  parameter_snapshot_scalar(view, params->kd));
+    pid_set_integral_limit(pid, parameter_snapshot_scalar(view, params->i_limit));
+    parameter_snapshot_release(&params->snapshot.snapshot, view);
+}
+
+static void odometry_params_update(odometry_params* params)
+{
+    const parameter_snapshot_view_t* view = params_snapshot_acquire_new(&params->snapshot);
+    if (view == nullptr) {
+        return;
+    }
+    rs_set_left_ext_encoder(&robot.rs, rs_encoder_get_left_ext, nullptr,
+                            parameter_snapshot_scalar(view, params->left_wheel_correction_factor));
+    rs_set_right_ext_encoder(&robot.rs, rs_encoder_get_right_ext, nullptr,
+                             parameter_snapshot_scalar(view, params->right_wheel_correction_factor));
+    position_set_physical_params(&robot.pos,
+                                 parameter_snapshot_scalar(view, params->external_track_mm),
+                                 parameter_snapshot_scalar(view, params->external_encoder_ticks_per_mm));
+    parameter_snapshot_release(&params->snapshot.snapshot, view);
+}
+
+static void pose_publish(timestamp_t timestamp);
+
+/** Runs the control systems on the latest encoder values. When with_odometry
+ * is set, the position is updated from the same values first and published
+ * afterwards. */
+static void base_ctrl_manage(bool with_odometry)
+{
+    int32_t angle_error, distance_error;
+    timestamp_t now = timestamp_get();
+
+    {
+        absl::MutexLock _(&robot.cs_lock);
         rs_update(&robot.rs);
 
+        if (with_odometry) {
+            position_manage_at(&robot.pos, now);
+        }
+
         /* Control system manage */
         if (robot.mode != BOARD_MODE_SET_PWM) {
             if (robot.mode == BOARD_MODE_ANGLE_DISTANCE || robot.mode == BOARD_MODE_ANGLE_ONLY) {
-                cs_manage(&robot.angle_cs);
+                angle_pipeline.manage(&robot.angle_cs);
             } else {
                 rs_set_angle(&robot.rs, 0); // Sets angle PWM to zero
             }
 
             if (robot.mode == BOARD_MODE_ANGLE_DISTANCE || robot.mode == BOARD_MODE_DISTANCE_ONLY) {
-                cs_manage(&robot.distance_cs);
+                distance_pipeline.manage(&robot.distance_cs);
             } else {
                 rs_set_distance(&robot.rs, 0); // Sets distance PWM to zero
             }
         }
 
-        /* Blocking detection manage */
-        bd_manage(&robot.angle_bd, abs(cs_get_error(&robot.angle_cs)));
-        bd_manage(&robot.distance_bd, abs(cs_get_error(&robot.distance_cs)));
-
-        if (parameter_namespace_contains_changed(control_params)) {
-            float kp, ki, kd, ilim;
-            pid_get_gains(&robot.angle_pid.pid, &kp, &ki, &kd);
-            kp = parameter_scalar_get(parameter_find(control_params, "angle/kp"));
-            ki = parameter_scalar_get(parameter_find(control_params, "angle/ki"));
-            kd = parameter_scalar_get(parameter_find(control_params, "angle/kd"));
-            ilim = parameter_scalar_get(parameter_find(control_params, "angle/i_limit"));
-            pid_set_gains(&robot.angle_pid.pid, kp, ki, kd);
-            pid_set_integral_limit(&robot.angle_pid.pid, ilim);
-
-            pid_get_gains(&robot.distance_pid.pid, &kp, &ki, &kd);
-            kp = parameter_scalar_get(parameter_find(control_params, "distance/kp"));
-            ki = parameter_scalar_get(parameter_find(control_params, "distance/ki"));
-            kd = parameter_scalar_get(parameter_find(control_params, "distance/kd"));
-            ilim = parameter_scalar_get(parameter_find(control_params, "distance/i_limit"));
-            pid_set_gains(&robot.distance_pid.pid, kp, ki, kd);
-            pid_set_integral_limit(&robot.distance_pid.pid, ilim);
-        }
-        if (parameter_namespace_contains_changed(odometry_params)) {
-            rs_set_left_ext_encoder(&robot.rs, rs_encoder_get_left_ext, nullptr,
-                                    config_get_scalar("master/odometry/left_wheel_correction_factor"));
-            rs_set_right_ext_encoder(&robot.rs, rs_encoder_get_right_ext, nullptr,
-                                     config_get_scalar("master/odometry/right_wheel_correction_factor"));
-
-            position_set_physical_params(&robot.pos,
-                                         config_get_scalar("master/odometry/external_track_mm"),
-                                         config_get_scalar("master/odometry/external_encoder_ticks_per_mm"));
-        }
+        angle_error = cs_get_error(&robot.angle_cs);
+        distance_error = cs_get_error(&robot.distance_cs);
 
-        switch (robot.base_speed) {
-            case BASE_SPEED_INIT:
-                trajectory_set_speed(&robot.traj,
-                                     1000 * speed_mm2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/distance/speed/init")),
-                                     speed_rd2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/angle/speed/init")));
-
-                trajectory_set_acc(&robot.traj,
-                                   1000 * acc_mm2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/distance/acceleration/init")),
-                                   acc_rd2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/angle/acceleration/init")));
-                break;
-
-            case BASE_SPEED_SLOW:
-                trajectory_set_speed(&robot.traj,
-                                     1000 * speed_mm2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/distance/speed/slow")),
-                                     speed_rd2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/angle/speed/slow")));
-
-                trajectory_set_acc(&robot.traj,
-                                   1000 * acc_mm2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/distance/acceleration/slow")),
-                                   acc_rd2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/angle/acceleration/slow")));
-                break;
-
-            case BASE_SPEED_FAST:
-                trajectory_set_speed(&robot.traj,
-                                     1000 * speed_mm2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/distance/speed/fast")),
-                                     speed_rd2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/angle/speed/fast")));
-                trajectory_set_acc(&robot.traj,
-                                   1000 * acc_mm2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/distance/acceleration/fast")),
-                                   acc_rd2imp(&robot.traj, config_get_scalar("master/aversive/trajectories/angle/acceleration/fast")));
-                break;
-            default:
-                WARNING("Unknown speed type, going back to safe!");
-                robot.base_speed = BASE_SPEED_SLOW;
-                break;
-        }
+        /* Checking the snapshots never blocks, so it is done on every pass */
+        pid_params_update(&base_params.angle_pid, &robot.angle_pid.pid);
+        pid_params_update(&base_params.distance_pid, &robot.distance_pid.pid);
+        odometry_params_update(&base_params.odometry);
+    }
+
+    control_latency.control_updated(control_latency_now_us());
 
-        robot.lock.Unlock();
+    /* Blocking detection manage */
+    bool blocked;
+    {
+        absl::MutexLock _(&robot.bd_lock);
+        bd_manage(&robot.angle_bd, abs(angle_error));
+        bd_manage(&robot.distance_bd, abs(distance_error));
+        blocked = bd_get(&robot.angle_bd) || bd_get(&robot.distance_bd);
+    }
 
-        /* Wait until next regulation loop */
-        std::this_thread::sleep_for(1000ms / ASSERV_FREQUENCY);
+    /* Only passes of the same loop (or serialized by fused_pass_lock) touch it */
+    static bool was_blocked = false;
+    if (blocked && !was_blocked) {
+        robot.events.signal(ROBOT_EVENT_BLOCKING);
     }
+    was_blocked = blocked;
+
+    if (with_odometry) {
+        pose_publish(now);
+    }
+
+    enum base_speed_t base_speed = robot.base_speed;
+    if (base_speed < BASE_SPEED_INIT || base_speed > BASE_SPEED_FAST) {
+        WARNING("Unknown speed type, going back to safe!");
+        base_speed = BASE_SPEED_SLOW;
+        robot.base_speed = base_speed;
+    }
+
+    /* Each level keeps the generation of its own values, so only the one in
+     * use needs to be refreshed */
+    speed_params* speed = &base_params.speeds[base_speed];
+    cached_param_update(&speed->distance_speed);
+    cached_param_update(&speed->angle_speed);
+    cached_param_update(&speed->distance_acc);
+    cached_param_update(&speed->angle_acc);
+
+    trajectory_set_speed(&robot.traj,
+                         1000 * speed_mm2imp(&robot.traj, speed->distance_speed.value),
+                         speed_rd2imp(&robot.traj, speed->angle_speed.value));
+    trajectory_set_acc(&robot.traj,
+                       1000 * acc_mm2imp(&robot.traj, speed->distance_acc.value),
+                       acc_rd2imp(&robot.traj, speed->angle_acc.value));
 }
 
-void base_controller_start()
+/* Passes are run both on encoder arrival and by the watchdog */
+static absl::Mutex fused_pass_lock;
+static std::atomic<int64_t> last_fused_pass_ns{0};
+
+static int64_t steady_now_ns()
 {
-    std::thread ctrl_thd(base_ctrl_thd);
-    ctrl_thd.detach();
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
 }
 
-static void position_manager_thd()
+static void fused_pass()
 {
+    absl::MutexLock _(&fused_pass_lock);
+    base_ctrl_manage(true);
+    last_fused_pass_ns = steady_now_ns();
+
+    /* Send the new voltages now rather than on the next periodic send */
+    motor_driver_uavcan_request_setpoints();
+}
+
+static void control_on_encoders_main()
+{
+    periodic_task_set_scheduling("control_on_encoders",
+                                 absl::GetFlag(FLAGS_control_priority),
+                                 absl::GetFlag(FLAGS_control_cpu));
+
+    messagebus_topic_t* topic = messagebus_find_topic_blocking(&bus, "/encoders");
+    NOTICE("Control runs on encoder arrival");
+
     while (true) {
-        {
-            absl::MutexLock _(&robot.lock);
-            position_manage(&robot.pos);
-            DEBUG_EVERY_N(ODOM_FREQUENCY, "pos: %d %d %d",
-                          position_get_x_s16(&robot.pos),
-                          position_get_y_s16(&robot.pos),
-                          position_get_a_deg_s16(&robot.pos));
-        }
-        std::this_thread::sleep_for(1000ms / ODOM_FREQUENCY);
+        WheelEncodersPulse msg;
+        messagebus_topic_wait(topic, &msg, sizeof(msg));
+        fused_pass();
+    }
+}
+
+/* Keeps the robot controlled, on stale encoder values, if they stop coming */
+static void control_watchdog()
+{
+    auto since_last_pass = std::chrono::nanoseconds(steady_now_ns() - last_fused_pass_ns);
+    if (since_last_pass > CONTROL_WATCHDOG_TIMEOUT) {
+        WARNING_EVERY_N(ASSERV_FREQUENCY, "No encoder data for %lld ms, running control on timer",
+                        (long long)std::chrono::duration_cast<std::chrono::milliseconds>(since_last_pass).count());
+        fused_pass();
+    }
+}
+
+void base_controller_start()
+{
+    base_params_init();
+
+    if (!absl::GetFlag(FLAGS_control_on_encoders)) {
+        control_task_start(&base_ctrl_task, []() {
+            base_ctrl_manage(false);
+        });
+        return;
     }
+
+    last_fused_pass_ns = steady_now_ns();
+    std::thread thd(control_on_encoders_main);
+    thd.detach();
+
+    control_task_start(&control_watchdog_task, control_watchdog);
+}
+
+/* Wraps the angle in [-pi, pi] */
+static float wrap_angle(float angle)
+{
+    return atan2f(sinf(angle), cosf(angle));
+}
+
+/** Computes the pose from the position manager and makes it available to the
+ * other threads through robot.pose. timestamp is the time of the odometry
+ * sample the position was computed from. */
+static void pose_publish(timestamp_t timestamp)
+{
+    struct robot_pose previous = robot.pose.load();
+    struct robot_pose pose;
+    pose.x = position_get_x_float(&robot.pos);
+    pose.y = position_get_y_float(&robot.pos);
+    pose.a = position_get_a_rad_float(&robot.pos);
+    pose.timestamp = timestamp;
+
+    float dt = timestamp_duration_s(previous.timestamp, pose.timestamp);
+    if (previous.timestamp != 0 && dt > 0) {
+        /* Speed along the heading, negative when going backward */
+        pose.distance_speed = ((pose.x - previous.x) * cosf(pose.a) + (pose.y - previous.y) * sinf(pose.a)) / dt;
+        pose.angle_speed = wrap_angle(pose.a - previous.a) / dt;
+    } else {
+        pose.distance_speed = 0;
+        pose.angle_speed = 0;
+    }
+
+    robot.pose.store(pose);
+    robot.events.signal(ROBOT_EVENT_POSE);
+
+    DEBUG_EVERY_N(ODOM_FREQUENCY, "pos: %d %d %d",
+                  (int)pose.x, (int)pose.y, (int)(pose.a * 180 / M_PI));
+}
+
+static void position_manager_manage()
+{
+    timestamp_t now = timestamp_get();
+
+    {
+        /* The odometry reads the encoders from the robot system */
+        absl::ReaderMutexLock _(&robot.cs_lock);
+        position_manage_at(&robot.pos, now);
+    }
+
+    pose_publish(now);
 }
 
 void position_manager_start()
 {
-    std::thread pos_thd(position_manager_thd);
-    pos_thd.detach();
+    if (absl::GetFlag(FLAGS_control_on_encoders)) {
+        NOTICE("Odometry is updated by the control pass");
+        return;
+    }
+
+    control_task_start(&position_manager_task, position_manager_manage);
 }
 
-void trajectory_manager_thd()
+/* Signals when the trajectory finishes or enters its window, so that waiters
+ * do not have to poll it. */
+static void trajectory_events_update()
 {
-    while (true) {
-        {
-            absl::MutexLock _(&robot.lock);
-            trajectory_manager_manage(&robot.traj);
-        }
-        std::this_thread::sleep_for(1000ms / ODOM_FREQUENCY);
+    static bool was_finished, was_nearly_finished;
+
+    bool finished = trajectory_finished(&robot.traj);
+    bool nearly_finished = trajectory_nearly_finished(&robot.traj);
+
+    if (finished != was_finished || nearly_finished != was_nearly_finished) {
+        robot.events.signal(ROBOT_EVENT_TRAJECTORY);
     }
+
+    was_finished = finished;
+    was_nearly_finished = nearly_finished;
 }
 
 void trajectory_manager_start()
 {
-    std::thread traj_thd(trajectory_manager_thd);
-    traj_thd.detach();
+    control_task_start(&trajectory_manager_task, []() {
+        trajectory_manager_manage(&robot.traj);
+        trajectory_events_update();
+    });
 }
@@ -1,6 +1,7 @@
 #ifndef BASE_CONTROLLER_H
 #define BASE_CONTROLLER_H
 
+#include <atomic>
 #include <absl/synchronization/mutex.h>
 
 #include <quadramp/quadramp.h>
@@ -11,7 +12,11 @@
 #include <aversive/robot_system/robot_system.h>
 #include <aversive/trajectory_manager/trajectory_manager.h>
 
+#include <timestamp/timestamp.h>
+
 #include "cs_port.h"
+#include "robot_events.hpp"
+#include "seqlock.hpp"
 
 /** Frequency of the regulation loop and odometry loop (in Hz) */
 #define ASSERV_FREQUENCY 100
@@ -48,6 +53,16 @@ enum base_speed_t {
     BASE_SPEED_FAST
 };
 
+/** Pose and speed of the robot, as computed by the position manager */
+struct robot_pose {
+    float x; // in mm
+    float y; // in mm
+    float a; // in rad
+    float distance_speed; // in mm/s
+    float angle_speed; // in rad/s
+    timestamp_t timestamp; // time of the computation
+};
+
 /**
  @brief contains all global vars.
 
@@ -55,9 +70,16 @@ enum base_speed_t {
  group all vars in one place. It also serve as a namespace.
  */
 struct _robot {
+    /* Locks are always taken in this order: traj.lock_, cs_lock, pos.lock_.
+     * bd_lock is never held together with another one. */
+    absl::Mutex cs_lock; // Robot system, control systems and mode
+    absl::Mutex bd_lock; // Blocking detection managers
+
     struct robot_system rs; // Robot system (angle & distance)
-    struct robot_position pos; // Position manager
-    enum base_speed_t base_speed;
+    struct robot_position pos; // Position manager, has its own lock
+    SeqLock<struct robot_pose> pose; // Latest pose, readable without locking
+    std::atomic<enum base_speed_t> base_speed;
+    RobotEvents events; // Signaled by the control loops, the odometry and the map
 
     struct cs angle_cs; // Control system manager for angle
     struct cs distance_cs; // Control system manager for distance
@@ -66,11 +88,11 @@ struct _robot {
     struct quadramp_filter angle_qr;
     struct quadramp_filter distance_qr;
 
-    struct trajectory traj; // Trivial trajectory manager
+    struct trajectory traj; // Trivial trajectory manager, has its own lock
     struct blocking_detection angle_bd; // Angle blocking detection manager
     struct blocking_detection distance_bd; // Distance blocking detection manager
 
-    enum board_mode_t mode; // The current board mode
+    enum board_mode_t mode GUARDED_BY(cs_lock); // The current board mode
 
     enum direction_t calibration_direction; // Calibration direction / side of the robot
     int robot_size;
@@ -78,7 +100,6 @@ struct _robot {
     int opponent_size;
 
     uint32_t start_time; // Time since the beginning of the match, in microseconds
-    absl::Mutex lock;
 };
 
 extern struct _robot robot;
@@ -1,31 +1,34 @@
 #include <aversive/math/geometry/discrete_circles.h>
 
 #include "robot_helpers/math_helpers.h"
-#include "base_controller.h"
 #include "map.h"
-#include "strategy/table.h"
 
 #define TABLE_POINT_X(x) math_clamp_value(x, 0, MAP_SIZE_X_MM)
 #define TABLE_POINT_Y(y) math_clamp_value(y, 0, MAP_SIZE_Y_MM)
 
-static void map_lock(mutex_t* lock)
-{
-    chMtxLock(lock);
-}
-static void map_unlock(mutex_t* lock)
+/* Index of the movable obstacles in the grid planner */
+#define MAP_GRID_ALLY_INDEX 0
+#define MAP_GRID_OPPONENT_INDEX(i) (1 + (i))
+
+static void map_sync_grid(struct _map* map, int index, poly_t* poly)
 {
-    chMtxUnlock(lock);
+    if (map->has_grid) {
+        grid_planner_set_dynamic_poly(&map->grid, index, poly);
+    }
 }
 
-void map_init(struct _map* map, int robot_size, bool enable_wall)
+int map_init(struct _map* map, int robot_size, bool enable_wall)
 {
     // Initialise obstacle avoidance state
-    oa_init(&map->oa);
-    chMtxObjectInit(&map->lock);
+    if (oa_init(&map->oa) < 0) {
+        return -1;
+    }
+    map->has_grid = false;
+    map->planner = MAP_PLANNER_OBSTACLE_AVOIDANCE;
 
     /* Define table borders */
-    polygon_set_boundingbox(robot_size / 2, robot_size / 2,
-                            MAP_SIZE_X_MM - robot_size / 2, MAP_SIZE_Y_MM - robot_size / 2);
+    oa_set_boundingbox(&map->oa, robot_size / 2, robot_size / 2,
+                       MAP_SIZE_X_MM - robot_size / 2, MAP_SIZE_Y_MM - robot_size / 2);
 
     /* Add ally obstacle at origin */
     map->ally = oa_new_poly(&map->oa, MAP_NUM_ALLY_EDGES);
@@ -42,6 +45,8 @@ void map_init(struct _map* map, int robot_size, bool enable_wall)
     if (enable_wall) {
         map->the_wall = oa_new_poly(&map->oa, 4);
         map_set_rectangular_obstacle(map->the_wall, 1500, 1450, 40, 200, robot_size);
+    } else {
+        map->the_wall = NULL;
     }
 
     /* Add the distributors ahead of the ramp */
@@ -54,7 +59,117 @@ void map_init(struct _map* map, int robot_size, bool enable_wall)
     map->ramp_obstacle = oa_new_poly(&map->oa, 4);
     map_set_rectangular_obstacle_from_corners(map->ramp_obstacle, 450, 1578, 2550, 2000, robot_size);
 
-    map->enable_opponent = true;
+    return 0;
+}
+
+void map_deinit(struct _map* map)
+{
+    if (map->has_grid) {
+        grid_planner_deinit(&map->grid);
+        map->has_grid = false;
+    }
+    oa_deinit(&map->oa);
+}
+
+static poly_t* map_rebase_poly(const struct _map* src, struct _map* dst, poly_t* poly)
+{
+    if (poly == NULL) {
+        return NULL;
+    }
+    return &dst->oa.polys[poly - src->oa.polys];
+}
+
+int map_copy(struct _map* dst, const struct _map* src)
+{
+    if (oa_copy(&dst->oa, &src->oa) < 0) {
+        return -1;
+    }
+
+    dst->the_wall = map_rebase_poly(src, dst, src->the_wall);
+    dst->ramp_obstacle = map_rebase_poly(src, dst, src->ramp_obstacle);
+    dst->distributor_obstacle[0] = map_rebase_poly(src, dst, src->distributor_obstacle[0]);
+    dst->distributor_obstacle[1] = map_rebase_poly(src, dst, src->distributor_obstacle[1]);
+    dst->ally = map_rebase_poly(src, dst, src->ally);
+    for (int i = 0; i < MAP_NUM_OPPONENT; i++) {
+        dst->opponents[i] = map_rebase_poly(src, dst, src->opponents[i]);
+    }
+    dst->last_opponent_index = src->last_opponent_index;
+    dst->planner = src->planner;
+
+    if (!src->has_grid) {
+        return 0;
+    }
+
+    if (dst->has_grid && grid_planner_copy(&dst->grid, &src->grid) == 0) {
+        return 0;
+    }
+
+    /* First copy, or the grid parameters changed */
+    if (dst->has_grid) {
+        grid_planner_deinit(&dst->grid);
+        dst->has_grid = false;
+    }
+    if (grid_planner_init(&dst->grid, &src->grid.params, src->grid.playground) < 0) {
+        return -1;
+    }
+    dst->has_grid = true;
+
+    return grid_planner_copy(&dst->grid, &src->grid);
+}
+
+int map_init_grid_planner(struct _map* map, const struct grid_planner_params* params)
+{
+    struct grid_planner_params grid_params = *params;
+    grid_params.max_dynamic_obstacles = MAP_GRID_OPPONENT_INDEX(MAP_NUM_OPPONENT);
+
+    if (map->has_grid) {
+        grid_planner_deinit(&map->grid);
+        map->has_grid = false;
+    }
+
+    /* Same playground as the obstacle avoidance, cells outside of it are
+     * unreachable */
+    if (grid_planner_init(&map->grid, &grid_params, map->oa.bbox) < 0) {
+        return -1;
+    }
+
+    if (map->the_wall) {
+        grid_planner_add_static_poly(&map->grid, map->the_wall);
+    }
+    grid_planner_add_static_poly(&map->grid, map->distributor_obstacle[0]);
+    grid_planner_add_static_poly(&map->grid, map->distributor_obstacle[1]);
+    grid_planner_add_static_poly(&map->grid, map->ramp_obstacle);
+    grid_planner_update_distances(&map->grid);
+
+    map->has_grid = true;
+
+    map_sync_grid(map, MAP_GRID_ALLY_INDEX, map->ally);
+    for (int i = 0; i < MAP_NUM_OPPONENT; i++) {
+        map_sync_grid(map, MAP_GRID_OPPONENT_INDEX(i), map->opponents[i]);
+    }
+
+    return 0;
+}
+
+void map_set_planner(struct _map* map, enum map_planner planner)
+{
+    map->planner = planner;
+}
+
+int map_plan_path(struct _map* map, point_t start, point_t end, point_t** path)
+{
+    int num_points;
+
+    if (map->planner == MAP_PLANNER_GRID && map->has_grid) {
+        grid_planner_process(&map->grid, start, end);
+        num_points = grid_planner_get_path(&map->grid, path);
+    } else {
+        oa_start_end_points(&map->oa, start.x, start.y, end.x, end.y);
+        oa_process(&map->oa);
+        num_points = oa_get_path(&map->oa, path);
+    }
+
+    return num_points;
 }
 
 void map_set_ally_obstacle(struct _map* map, int32_t x, int32_t y, int32_t ally_size, int32_t robot_size)
@@ -63,16 +178,14 @@ void map_set_ally_obstacle(struct _map* map, int32_t x, int32_t y, int32_t ally_
     ally.x = x;
     ally.y = y;
     ally.r = MAP_ALLY_SIZE_FACTOR * (robot_size + ally_size) / 2;
-    map_lock(&map->lock);
     discretize_circle(map->ally, ally, MAP_NUM_ALLY_EDGES, 0);
-    map_unlock(&map->lock);
+    map_sync_grid(map, MAP_GRID_ALLY_INDEX, map->ally);
 }
 
 void map_set_opponent_obstacle(struct _map* map, int index, int32_t x, int32_t y, int32_t opponent_size, int32_t robot_size)
 {
-    map_lock(&map->lock);
     map_set_rectangular_obstacle(map->opponents[index], x, y, opponent_size, opponent_size, robot_size);
-    map_unlock(&map->lock);
+    map_sync_grid(map, MAP_GRID_OPPONENT_INDEX(index), map->opponents[index]);
 }
 
 poly_t* map_get_opponent_obstacle(struct _map* map, int index)
@@ -114,13 +227,30 @@ void map_set_rectangular_obstacle_from_corners(poly_t* opponent, int bottom_left
 
 void map_update_opponent_obstacle(struct _map* map, int32_t x, int32_t y, int32_t opponent_size, int32_t robot_size)
 {
-    map_lock(&map->lock);
     map_set_rectangular_obstacle(map->opponents[map->last_opponent_index], x, y,
                                  opponent_size, opponent_size, robot_size);
+    map_sync_grid(map, MAP_GRID_OPPONENT_INDEX(map->last_opponent_index),
+                  map->opponents[map->last_opponent_index]);
+
+    map->last_opponent_index++;
+    if (map->last_opponent_index >= MAP_NUM_OPPONENT) {
+        map->last_opponent_index = 0;
+    }
+}
+
+void map_update_opponent_swept_obstacle(struct _map* map, const struct opponent_prediction* opponent, float horizon, int32_t opponent_size, int32_t robot_size)
+{
+    poly_t* obstacle = map->opponents[map->last_opponent_index];
+
+    opponent_prediction_swept_obstacle(opponent, horizon, opponent_size, robot_size, obstacle);
+    for (int i = 0; i < obstacle->l; i++) {
+        obstacle->pts[i].x = TABLE_POINT_X(obstacle->pts[i].x);
+        obstacle->pts[i].y = TABLE_POINT_Y(obstacle->pts[i].y);
+    }
+    map_sync_grid(map, MAP_GRID_OPPONENT_INDEX(map->last_opponent_index), obstacle);
 
     map->last_opponent_index++;
     if (map->last_opponent_index >= MAP_NUM_OPPONENT) {
         map->last_opponent_index = 0;
     }
-    map_unlock(&map->lock);
 }
@@ -1,14 +1,18 @@
 #ifndef MAP_H
 #define MAP_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include <aversive/obstacle_avoidance/obstacle_avoidance.h>
+#include <aversive/grid_planner/grid_planner.h>
+
+#include "robot_helpers/opponent_prediction.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-#include <ch.h>
-
 #define MAP_SIZE_X_MM 3000
 #define MAP_SIZE_Y_MM 2000
 #define MAP_NUM_ALLY_EDGES 4
@@ -16,6 +20,12 @@ extern "C" {
 #define MAP_NUM_OPPONENT 2
 #define MAP_NUM_OPPONENT_EDGES 4
 
+/** Path planner used by map_plan_path() */
+enum map_planner {
+    MAP_PLANNER_OBSTACLE_AVOIDANCE = 0, /**< Visibility graph, see obstacle_avoidance.h */
+    MAP_PLANNER_GRID, /**< Occupancy grid with clearance, see grid_planner.h */
+};
+
 struct _map {
     poly_t* the_wall;
     poly_t* ramp_obstacle;
@@ -26,16 +36,55 @@ struct _map {
     poly_t* opponents[MAP_NUM_OPPONENT];
     uint8_t last_opponent_index;
 
-    mutex_t lock;
     struct obstacle_avoidance oa;
 
-    bool enable_opponent;
+    struct grid_planner grid;
+    bool has_grid;
+    enum map_planner planner;
 };
 
 /** Initialize the map of the Eurobot table with the static obstacles and
  * opponents
+ *
+ * @returns 0 on success, -1 if the obstacle avoidance could not be allocated.
+ * @note The map is not synchronized, it must either be owned by a single
+ * thread or be left untouched once shared, see map_server.h.
+ */
+int map_init(struct _map* map, int robot_size, bool enable_wall);
+
+/** Release the memory used by the path planners of the map
+ */
+void map_deinit(struct _map* map);
+
+/** Copy the obstacles of src into dst
+ *
+ * dst must have been initialized with map_init. Its grid planner is created
+ * if src has one, so that dst can then plan on its own.
+ * @returns 0 on success, -1 if dst could not hold the obstacles of src.
  */
-void map_init(struct _map* map, int robot_size, bool enable_wall);
+int map_copy(struct _map* dst, const struct _map* src);
+
+/** Create the grid planner from the obstacles of the map
+ *
+ * @returns 0 on success, -1 if the grid could not be allocated.
+ * @note Must be called after map_init. The obstacles are kept in sync with
+ * the grid afterwards.
+ */
+int map_init_grid_planner(struct _map* map, const struct grid_planner_params* params);
+
+/** Select the path planner used by map_plan_path
+ *
+ * Selecting the grid planner without calling map_init_grid_planner first
+ * keeps the obstacle avoidance.
+ */
+void map_set_planner(struct _map* map, enum map_planner planner);
+
+/** Compute a path from start to end using the selected planner
+ *
+ * @returns The number of points in the path, the last one being end, or a
+ * negative or zero value if no path was found.
+ */
+int map_plan_path(struct _map* map, point_t start, point_t end, point_t** path);
 
 /** Set the position of the ally
  */
@@ -53,6 +102,11 @@ poly_t* map_get_opponent_obstacle(struct _map* map, int index);
  */
 void map_update_opponent_obstacle(struct _map* map, int32_t x, int32_t y, int32_t opponent_size, int32_t robot_size);
 
+/** Update opponent obstacle to cover the positions predicted over the next
+ * horizon seconds
+ */
+void map_update_opponent_swept_obstacle(struct _map* map, const struct opponent_prediction* opponent, float horizon, int32_t opponent_size, int32_t robot_size);
+
 /** Set the points of a rectangle given its center position and size
  */
 void map_set_rectangular_obstacle(poly_t* opponent, int center_x, int center_y, int size_x, int size_y, int robot_size);
@@ -1,40 +1,123 @@
-#include <ch.h>
-#include <hal.h>
 #include <string.h>
+#include <thread>
+#include <absl/synchronization/mutex.h>
 #include <error/error.h>
+#include <msgbus/posix/port.h>
 #include <timestamp/timestamp.h>
 
 #include "config.h"
+#include "config_accessors.h"
 #include "main.h"
-#include "priorities.h"
 
 #include "base/base_controller.h"
 #include "base/map.h"
 #include "base/map_server.h"
+#include "base/snapshot_pool.hpp"
 #include "robot_helpers/beacon_helpers.h"
 #include "robot_helpers/trajectory_helpers.h"
-#include "strategy/state.h"
 
 #include "protobuf/beacons.pb.h"
 #include "protobuf/ally_position.pb.h"
 
-#define MAP_SERVER_STACKSIZE 1024
+/* One snapshot is published, the others are either being read by planners or
+ * free to build the next one. */
+#define MAP_SERVER_NUM_SNAPSHOTS 4
 
-static struct {
-    struct _map map;
-    MUTEX_DECL(map_lock);
-} map_data;
+/* Planners write into the map while searching, so each one plans on its own
+ * copy of the snapshot, in one of these workspaces. */
+#define MAP_SERVER_NUM_WORKSPACES 2
 
-static THD_FUNCTION(map_server_thd, arg)
+static SnapshotPool<struct _map, MAP_SERVER_NUM_SNAPSHOTS> snapshots;
+
+/* Wakes the map server up when a snapshot is given back while it waits for a
+ * writable one */
+static absl::Mutex snapshot_release_lock;
+static absl::CondVar snapshot_released;
+
+/* Allocated by the map server thread before it publishes the first snapshot,
+ * and kept for the lifetime of the firmware like the snapshots. */
+static struct _map workspaces[MAP_SERVER_NUM_WORKSPACES];
+static absl::Mutex workspace_lock;
+static absl::CondVar workspace_released;
+static bool workspace_in_use[MAP_SERVER_NUM_WORKSPACES] GUARDED_BY(workspace_lock);
+
+/* Motion of the opponent, written by the map server thread only */
+static absl::Mutex opponent_lock;
+static struct opponent_prediction opponent GUARDED_BY(opponent_lock);
+
+static int map_server_create_map(struct _map* map, int robot_size, bool enable_wall)
+{
+    if (map_init(map, robot_size, enable_wall) < 0) {
+        return -1;
+    }
+
+    if (!config_master_map_use_grid_planner()) {
+        return 0;
+    }
+
+    struct grid_planner_params grid_params;
+    grid_params.resolution_mm = config_master_map_grid_resolution_mm();
+    grid_params.safety_margin_mm = config_master_map_grid_safety_margin_mm();
+    grid_params.clearance_mm = config_master_map_grid_clearance_mm();
+    grid_params.clearance_weight = config_master_map_grid_clearance_weight();
+    grid_params.max_checkpoints = MAX_CHKPOINTS;
+
+    if (map_init_grid_planner(map, &grid_params) < 0) {
+        WARNING("Could not allocate the grid planner, using obstacle avoidance");
+    } else {
+        map_set_planner(map, MAP_PLANNER_GRID);
+    }
+
+    return 0;
+}
+
+static void map_server_publish(const struct _map* map)
+{
+    struct _map* snapshot;
+
+    /* All snapshots are being read, wait for a planner to be done */
+    {
+        absl::MutexLock _(&snapshot_release_lock);
+        while ((snapshot = snapshots.writable()) == nullptr) {
+            snapshot_released.Wait(&snapshot_release_lock);
+        }
+    }
+
+    if (map_copy(snapshot, map) < 0) {
+        WARNING("Could not copy the map, keeping the previous one");
+        return;
+    }
+
+    snapshots.publish(snapshot);
+}
+
+static void map_server_thd(enum strat_color_t color)
 {
-    enum strat_color_t color = *(enum strat_color_t*)arg;
     (void)color;
-    chRegSetThreadName(__FUNCTION__);
 
-    int robot_size = config_get_integer("master/robot_size_x_mm");
-    int opponent_size = config_get_integer("master/opponent_size_x_mm_default");
-    bool enable_wall = config_get_boolean("master/is_main_robot");
-    map_init(&map_data.map, robot_size, enable_wall);
+    int robot_size = config_master_robot_size_x_mm();
+    int opponent_size = config_master_opponent_size_x_mm_default();
+    bool enable_wall = config_master_is_main_robot();
+
+    /* The map is only modified by this thread, planners use the snapshots */
+    static struct _map map;
+    if (map_server_create_map(&map, robot_size, enable_wall) < 0) {
+        ERROR("Could not allocate the map");
+        return;
+    }
+    for (int i = 0; i < MAP_SERVER_NUM_SNAPSHOTS; i++) {
+        if (map_init(&snapshots[i], robot_size, enable_wall) < 0) {
+            ERROR("Could not allocate the map snapshots");
+            return;
+        }
+    }
+    for (int i = 0; i < MAP_SERVER_NUM_WORKSPACES; i++) {
+        if (map_init(&workspaces[i], robot_size, enable_wall) < 0) {
+            ERROR("Could not allocate the planning maps");
+            return;
+        }
+    }
+    map_server_publish(&map);
 
     BeaconSignal beacon_signal;
     messagebus_topic_t* proximity_beacon_topic = messagebus_find_topic_blocking(&bus, "/proximity_beacon");
@@ -42,82 +125,153 @@ static THD_FUNCTION(map_server_thd, arg)
     AllyPosition ally_position;
     messagebus_topic_t* allied_position_topic = messagebus_find_topic_blocking(&bus, "/ally_pos");
 
-    StrategyState state = initial_state();
+    {
+        absl::MutexLock _(&opponent_lock);
+        opponent_prediction_init(&opponent, TRAJ_OPPONENT_PREDICTION_SMOOTHING);
+    }
+
     messagebus_topic_t* strategy_state_topic = messagebus_find_topic_blocking(&bus, "/state");
 
     static messagebus_watcher_t watchers[3];
+    static messagebus_watchgroup_t watchgroup;
+    static MESSAGEBUS_POSIX_SYNC_DECL(watchgroup_sync);
 
-    static struct {
-        mutex_t lock;
-        condition_variable_t cv;
-        messagebus_watchgroup_t group;
-    } watchgroup;
-
-    chMtxObjectInit(&watchgroup.lock);
-    chCondObjectInit(&watchgroup.cv);
-
-    messagebus_watchgroup_init(&watchgroup.group, &watchgroup.lock, &watchgroup.cv);
-    messagebus_watchgroup_watch(&watchers[0], &watchgroup.group, proximity_beacon_topic);
-    messagebus_watchgroup_watch(&watchers[1], &watchgroup.group, allied_position_topic);
-    messagebus_watchgroup_watch(&watchers[2], &watchgroup.group, strategy_state_topic);
+    messagebus_watchgroup_init(&watchgroup, &watchgroup_sync, &watchgroup_sync);
+    messagebus_watchgroup_watch(&watchers[0], &watchgroup, proximity_beacon_topic);
+    messagebus_watchgroup_watch(&watchers[1], &watchgroup, allied_position_topic);
+    messagebus_watchgroup_watch(&watchers[2], &watchgroup, strategy_state_topic);
 
     NOTICE("Map initialized");
 
     while (true) {
-        auto map = map_server_map_lock_and_get();
-        robot_size = config_get_integer("master/robot_size_x_mm");
-        opponent_size = config_get_integer("master/opponent_size_x_mm_default");
+        robot_size = config_master_robot_size_x_mm();
+        opponent_size = config_master_opponent_size_x_mm_default();
 
         /* Create obstacle at opponent position, only consider recent beacon signal */
         if (messagebus_topic_read(proximity_beacon_topic, &beacon_signal, sizeof(beacon_signal))) {
+            absl::MutexLock _(&opponent_lock);
             if (timestamp_duration_s(beacon_signal.timestamp.us, timestamp_get()) < TRAJ_MAX_TIME_DELAY_OPPONENT_DETECTION) {
                 float x_opp, y_opp;
                 beacon_cartesian_convert(&robot.pos,
                                          1000 * beacon_signal.range.range.distance,
                                          beacon_signal.range.angle,
                                          &x_opp, &y_opp);
-                map_update_opponent_obstacle(map, x_opp, y_opp, opponent_size * 1.25, robot_size);
+                /* Block the area the opponent is heading to, not only where it is */
+                point_t position = {x_opp, y_opp};
+                opponent_prediction_update(&opponent, position, beacon_signal.timestamp.us);
+                map_update_opponent_swept_obstacle(&map, &opponent, TRAJ_OPPONENT_PREDICTION_HORIZON,
+                                                   opponent_size * 1.25, robot_size);
             } else {
-                map_update_opponent_obstacle(map, 0, 0, 0, 0); // reset opponent position
+                opponent_prediction_reset(&opponent);
+                map_update_opponent_obstacle(&map, 0, 0, 0, 0); // reset opponent position
             }
         }
 
         /* Create obstacle at ally position */
         if (messagebus_topic_read(allied_position_topic, &ally_position, sizeof(ally_position))) {
-            map_set_ally_obstacle(map,
+            map_set_ally_obstacle(&map,
                                   ally_position.x,
                                   ally_position.y,
                                   robot_size,
                                   robot_size);
         } else {
-            map_set_ally_obstacle(map, 0, 0, 0, 0); // reset ally position
+            map_set_ally_obstacle(&map, 0, 0, 0, 0); // reset ally position
         }
 
-        map_server_map_release(map);
-        messagebus_watchgroup_wait(&watchgroup.group);
+        map_server_publish(&map);
+        robot.events.signal(ROBOT_EVENT_OBSTACLE);
+
+        messagebus_watchgroup_wait(&watchgroup);
     }
 }
 
 void map_server_start(enum strat_color_t color)
 {
-    static THD_WORKING_AREA(map_server_thd_wa, MAP_SERVER_STACKSIZE);
-    chThdCreateStatic(map_server_thd_wa, sizeof(map_server_thd_wa),
-                      MAP_SERVER_PRIO, map_server_thd, &color);
+    std::thread map_thd(map_server_thd, color);
+    map_thd.detach();
+}
+
+bool map_server_opponent_prediction(struct opponent_prediction* prediction)
+{
+    absl::MutexLock _(&opponent_lock);
+    *prediction = opponent;
+
+    /* The map server only runs when the beacon publishes, so the last
+     * measurement can be stale */
+    return opponent.num_measurements > 0
+        && timestamp_duration_s(opponent.timestamp, timestamp_get()) < TRAJ_MAX_TIME_DELAY_OPPONENT_DETECTION;
 }
 
-struct _map* map_server_map_lock_and_get(void)
+const struct _map* map_server_map_acquire(void)
 {
-    chMtxLock(&map_data.map_lock);
-    return &map_data.map;
+    return snapshots.acquire();
+}
+
+void map_server_map_release(const struct _map* map)
+{
+    snapshots.release(map);
+
+    absl::MutexLock _(&snapshot_release_lock);
+    snapshot_released.Signal();
+}
+
+static struct _map* map_server_workspace_acquire(void)
+{
+    absl::MutexLock _(&workspace_lock);
+    while (true) {
+        for (int i = 0; i < MAP_SERVER_NUM_WORKSPACES; i++) {
+            if (!workspace_in_use[i]) {
+                workspace_in_use[i] = true;
+                return &workspaces[i];
+            }
+        }
+        workspace_released.Wait(&workspace_lock);
+    }
 }
 
-void map_server_map_release(struct _map* map_ptr)
+static void map_server_workspace_release(struct _map* workspace)
 {
-    osalDbgAssert(map_ptr == &map_data.map, "wrong map ptr");
-    chMtxUnlock(&map_data.map_lock);
+    absl::MutexLock _(&workspace_lock);
+    workspace_in_use[workspace - workspaces] = false;
+    workspace_released.Signal();
 }
 
-void map_server_enable_opponent(struct _map* map_ptr, bool enable)
+int map_server_plan_path(point_t start, point_t end, bool ignore_opponents, point_t* path, int max_points)
 {
-    map_ptr->enable_opponent = enable;
+    /* The workspaces are allocated before the first snapshot is published */
+    const struct _map* snapshot = map_server_map_acquire();
+    if (snapshot == nullptr) {
+        WARNING("No map published yet");
+        return 0;
+    }
+
+    struct _map* workspace = map_server_workspace_acquire();
+    int ret = map_copy(workspace, snapshot);
+    map_server_map_release(snapshot);
+
+    if (ret < 0) {
+        map_server_workspace_release(workspace);
+        WARNING("Could not copy the map");
+        return 0;
+    }
+
+    // Dangerous mode: removes opponent
+    if (ignore_opponents) {
+        for (int i = 0; i < MAP_NUM_OPPONENT; i++) {
+            map_set_opponent_obstacle(workspace, i, 0, 0, 0, 0);
+        }
+    }
+
+    point_t* points;
+    int num_points = map_plan_path(workspace, start, end, &points);
+
+    if (num_points > max_points) {
+        num_points = -1;
+    } else if (num_points > 0) {
+        memcpy(path, points, num_points * sizeof(point_t));
+    }
+
+    map_server_workspace_release(workspace);
+
+    return num_points;
 }
@@ -1,18 +1,53 @@
 #ifndef MAP_SERVER_H
 #define MAP_SERVER_H
 
-#include "robot_helpers/strategy_helpers.h"
+#include <stdbool.h>
+
+#include "strategy/color.h"
 #include "base/map.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/** Start the thread keeping the map up to date with the opponents and ally.
+ *
+ * A new immutable snapshot of the map is published on every update, so that
+ * planners never wait on the map server nor on each other.
+ */
 void map_server_start(enum strat_color_t color);
-struct _map* map_server_map_lock_and_get(void);
-void map_server_map_release(struct _map* map);
 
-void map_server_enable_opponent(struct _map* map_ptr, bool enable);
+/** Get the motion of the opponent, as predicted from the beacon
+ *
+ * This is the prediction used for the opponent obstacle of the map.
+ * @returns false if the opponent was not seen recently.
+ */
+bool map_server_opponent_prediction(struct opponent_prediction* prediction);
+
+/** Get the latest published map, without blocking
+ *
+ * The map is left untouched until it is given back with
+ * map_server_map_release, which should be done quickly as the server only has
+ * a few snapshots to build the next ones into.
+ * @returns NULL if no map was published yet.
+ */
+const struct _map* map_server_map_acquire(void);
+
+/** Give back a map obtained from map_server_map_acquire
+ */
+void map_server_map_release(const struct _map* map);
+
+/** Compute a path from start to end on the latest map
+ *
+ * Several threads may plan at the same time, each on its own copy of the map.
+ * The copies are preallocated, so when they are all in use the call waits for
+ * another planner to be done.
+ * @param [in] ignore_opponents Plan as if there were no opponent.
+ * @param [out] path Buffer receiving the points of the path, end included.
+ * @returns The number of points in path, or zero or a negative value if
+ * no path was found or if it does not fit in max_points.
+ */
+int map_server_plan_path(point_t start, point_t end, bool ignore_opponents, point_t* path, int max_points);
 
 #ifdef __cplusplus
 }
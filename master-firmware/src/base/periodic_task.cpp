@@ -0,0 +1,201 @@
+#include <thread>
+#include <time.h>
+#include <errno.h>
+#include <string.h>
+#include <error/error.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "periodic_task.hpp"
+
+#define NS_PER_S 1000000000LL
+
+/* Statistics are logged at most this often, in nanoseconds */
+#define PERIODIC_TASK_REPORT_INTERVAL (10 * NS_PER_S)
+
+#ifdef __linux__
+static int64_t now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NS_PER_S + ts.tv_nsec;
+}
+
+static void sleep_until_ns(int64_t deadline)
+{
+    struct timespec ts;
+    ts.tv_sec = deadline / NS_PER_S;
+    ts.tv_nsec = deadline % NS_PER_S;
+
+    /* Absolute deadline, so we can simply retry when interrupted */
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
+#else
+/* No clock_nanosleep on MacOS, the steady clock is the closest thing */
+static int64_t now_ns()
+{
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+static void sleep_until_ns(int64_t deadline)
+{
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(deadline)));
+}
+#endif
+
+void PeriodicTaskStats::record(int64_t lateness, int64_t execution, int64_t period)
+{
+    iterations++;
+
+    if (execution + lateness > period) {
+        overruns++;
+    }
+
+    if (lateness > max_lateness) {
+        max_lateness = lateness;
+    }
+
+    if (execution > max_execution) {
+        max_execution = execution;
+    }
+
+    int64_t bin = execution * PERIODIC_TASK_HISTOGRAM_BINS / period;
+    if (bin >= PERIODIC_TASK_HISTOGRAM_BINS) {
+        bin = PERIODIC_TASK_HISTOGRAM_BINS - 1;
+    }
+    if (bin < 0) {
+        bin = 0;
+    }
+    execution_histogram[bin]++;
+}
+
+int64_t periodic_task_next_deadline(int64_t deadline, int64_t now, int64_t period, uint64_t* missed)
+{
+    int64_t next = deadline + period;
+
+    if (next <= now) {
+        int64_t skipped = (now - next) / period + 1;
+        next += skipped * period;
+        *missed += skipped;
+    }
+
+    return next;
+}
+
+void periodic_task_set_scheduling(const char* name, int priority, int cpu)
+{
+#ifdef __linux__
+    if (priority > 0) {
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = priority;
+
+        int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (err) {
+            WARNING("%s: could not set realtime priority %d: %s", name, priority, strerror(err));
+        }
+    }
+
+    if (cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (err) {
+            WARNING("%s: could not pin to CPU %d: %s", name, cpu, strerror(err));
+        }
+    }
+#else
+    if (priority > 0 || cpu >= 0) {
+        WARNING("%s: realtime priority and CPU affinity are only supported on Linux", name);
+    }
+#endif
+}
+
+PeriodicTask::PeriodicTask(const char* name, std::chrono::nanoseconds period)
+    : name(name)
+    , period(period.count())
+{
+}
+
+void PeriodicTask::set_realtime_priority(int priority)
+{
+    this->priority = priority;
+}
+
+void PeriodicTask::set_cpu(int cpu)
+{
+    this->cpu = cpu;
+}
+
+void PeriodicTask::start(std::function<void()> body)
+{
+    this->body = std::move(body);
+
+    std::thread thd(&PeriodicTask::run, this);
+    thd.detach();
+}
+
+PeriodicTaskStats PeriodicTask::stats() const
+{
+    absl::MutexLock _(&lock);
+    return stats_;
+}
+
+void PeriodicTask::run()
+{
+    periodic_task_set_scheduling(name, priority, cpu);
+
+    int64_t deadline = now_ns();
+    int64_t last_report = deadline;
+    uint64_t reported_overruns = 0;
+
+    while (true) {
+        int64_t start = now_ns();
+        body();
+        int64_t end = now_ns();
+
+        PeriodicTaskStats snapshot;
+        {
+            absl::MutexLock _(&lock);
+            stats_.record(start - deadline, end - start, period);
+            deadline = periodic_task_next_deadline(deadline, end, period, &stats_.missed_periods);
+            snapshot = stats_;
+        }
+
+        if (end - last_report > PERIODIC_TASK_REPORT_INTERVAL) {
+            if (snapshot.overruns > reported_overruns) {
+                WARNING("%s: %llu overruns (%llu periods missed), worst lateness %lld us, worst execution %lld us",
+                        name,
+                        (unsigned long long)snapshot.overruns,
+                        (unsigned long long)snapshot.missed_periods,
+                        (long long)(snapshot.max_lateness / 1000),
+                        (long long)(snapshot.max_execution / 1000));
+                reported_overruns = snapshot.overruns;
+            }
+
+            static_assert(PERIODIC_TASK_HISTOGRAM_BINS == 10, "Update the log below");
+            DEBUG("%s: execution histogram (tenths of period): %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu",
+                  name,
+                  (unsigned long long)snapshot.execution_histogram[0],
+                  (unsigned long long)snapshot.execution_histogram[1],
+                  (unsigned long long)snapshot.execution_histogram[2],
+                  (unsigned long long)snapshot.execution_histogram[3],
+                  (unsigned long long)snapshot.execution_histogram[4],
+                  (unsigned long long)snapshot.execution_histogram[5],
+                  (unsigned long long)snapshot.execution_histogram[6],
+                  (unsigned long long)snapshot.execution_histogram[7],
+                  (unsigned long long)snapshot.execution_histogram[8],
+                  (unsigned long long)snapshot.execution_histogram[9]);
+            last_report = end;
+        }
+
+        sleep_until_ns(deadline);
+    }
+}
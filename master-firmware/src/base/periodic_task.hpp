@@ -0,0 +1,76 @@
+#ifndef PERIODIC_TASK_HPP
+#define PERIODIC_TASK_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <absl/synchronization/mutex.h>
+
+/** Number of bins of the execution time histogram, each one covering a
+ * fraction of the period. The last bin also counts the overruns. */
+#define PERIODIC_TASK_HISTOGRAM_BINS 10
+
+/** Timing statistics of a periodic task, all times in nanoseconds. */
+struct PeriodicTaskStats {
+    uint64_t iterations = 0;
+    uint64_t overruns = 0; /**< Iterations that ended after the next deadline. */
+    uint64_t missed_periods = 0; /**< Periods skipped to catch up after overruns. */
+    int64_t max_lateness = 0; /**< Worst delay between a deadline and the wake up. */
+    int64_t max_execution = 0;
+    uint64_t execution_histogram[PERIODIC_TASK_HISTOGRAM_BINS] = {};
+
+    void record(int64_t lateness, int64_t execution, int64_t period);
+};
+
+/** Returns the first deadline after now, given the deadline of the iteration
+ * that just ran.
+ *
+ * Periods that were entirely missed are skipped and counted in missed rather
+ * than run back to back, so that the task keeps its phase.
+ */
+int64_t periodic_task_next_deadline(int64_t deadline, int64_t now, int64_t period, uint64_t* missed);
+
+/** Applies a SCHED_FIFO priority (if positive) and a CPU affinity (if not
+ * negative) to the calling thread, logging a warning on failure.
+ *
+ * Used by PeriodicTask, and by event driven threads which should be scheduled
+ * like it.
+ */
+void periodic_task_set_scheduling(const char* name, int priority, int cpu);
+
+/** Loop running at a fixed rate on absolute deadlines, so that the execution
+ * time of the body and the scheduler jitter do not make the period drift.
+ *
+ * The object must outlive the thread, which runs forever: declare it static.
+ */
+class PeriodicTask {
+public:
+    PeriodicTask(const char* name, std::chrono::nanoseconds period);
+
+    /** Run the task with the given SCHED_FIFO priority. Zero (the default)
+     * keeps the normal scheduler. Must be called before start(). */
+    void set_realtime_priority(int priority);
+
+    /** Pin the task to the given CPU. Negative (the default) lets it run on
+     * any CPU. Must be called before start(). */
+    void set_cpu(int cpu);
+
+    /** Start a thread calling body once per period */
+    void start(std::function<void()> body);
+
+    PeriodicTaskStats stats() const;
+
+private:
+    void run();
+
+    const char* name;
+    int64_t period;
+    int priority = 0;
+    int cpu = -1;
+    std::function<void()> body;
+
+    mutable absl::Mutex lock;
+    PeriodicTaskStats stats_ GUARDED_BY(lock);
+};
+
+#endif /* PERIODIC_TASK_HPP */
@@ -0,0 +1,82 @@
+#ifndef ROBOT_EVENTS_HPP
+#define ROBOT_EVENTS_HPP
+
+#include <cstdint>
+#include <absl/synchronization/mutex.h>
+#include <absl/time/time.h>
+
+/** Things that happen to the robot, which a thread can wait for */
+enum robot_event_t {
+    ROBOT_EVENT_TRAJECTORY = (1 << 0), ///< Trajectory finished, or entered its window
+    ROBOT_EVENT_BLOCKING = (1 << 1), ///< Blocking detected on the angle or distance
+    ROBOT_EVENT_OBSTACLE = (1 << 2), ///< Map obstacles (opponent, ally) updated
+    ROBOT_EVENT_POSE = (1 << 3), ///< New pose computed by the odometry
+};
+
+#define ROBOT_EVENT_COUNT 4
+
+/** Lets threads sleep until an event is signaled instead of polling the state
+ * of the robot.
+ *
+ * Events are counted rather than latched: a waiter first takes a mark, then
+ * checks the state it is interested in, then waits for events signaled since
+ * the mark. That way an event signaled while it was checking is not lost.
+ */
+class RobotEvents {
+public:
+    struct Mark {
+        uint32_t counts[ROBOT_EVENT_COUNT];
+    };
+
+    Mark mark() const
+    {
+        absl::MutexLock _(&lock);
+        Mark m;
+        for (int i = 0; i < ROBOT_EVENT_COUNT; i++) {
+            m.counts[i] = counts[i];
+        }
+        return m;
+    }
+
+    /** Signals the given events (a mask of robot_event_t) */
+    void signal(unsigned events)
+    {
+        absl::MutexLock _(&lock);
+        for (int i = 0; i < ROBOT_EVENT_COUNT; i++) {
+            if (events & (1 << i)) {
+                counts[i]++;
+            }
+        }
+        cond.SignalAll();
+    }
+
+    /** Blocks until one of the events was signaled after the mark was taken,
+     * or until the deadline. Returns false if the deadline was reached first. */
+    bool wait(const Mark& since, unsigned events, absl::Time deadline) const
+    {
+        absl::MutexLock _(&lock);
+        while (!signaled_since(since, events)) {
+            if (cond.WaitWithDeadline(&lock, deadline)) {
+                return signaled_since(since, events);
+            }
+        }
+        return true;
+    }
+
+private:
+    bool signaled_since(const Mark& since, unsigned events) const EXCLUSIVE_LOCKS_REQUIRED(lock)
+    {
+        for (int i = 0; i < ROBOT_EVENT_COUNT; i++) {
+            if ((events & (1 << i)) && counts[i] != since.counts[i]) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    mutable absl::Mutex lock;
+    mutable absl::CondVar cond;
+    uint32_t counts[ROBOT_EVENT_COUNT] GUARDED_BY(lock) = {};
+};
+
+#endif /* ROBOT_EVENTS_HPP */
@@ -0,0 +1,66 @@
+#ifndef SEQLOCK_HPP
+#define SEQLOCK_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/** Small value shared by a single writer with any number of readers, which
+ * never block the writer nor wait on a lock.
+ *
+ * The writer bumps a sequence number before and after each update, so that it
+ * is odd while an update is in progress. A reader copies the value and retries
+ * if the sequence number was odd or changed meanwhile. The value is stored as
+ * atomic words, so that torn reads are detected rather than undefined.
+ */
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock values are copied bytewise");
+
+    static constexpr size_t num_words = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> sequence{0};
+    std::array<std::atomic<uint32_t>, num_words> words{};
+
+public:
+    /** Publishes a new value. Must only be called by one thread at a time. */
+    void store(const T& value)
+    {
+        uint32_t buffer[num_words] = {};
+        memcpy(buffer, &value, sizeof(T));
+
+        const uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+
+        /* Release keeps the odd sequence number visible before the data */
+        for (size_t i = 0; i < num_words; i++) {
+            words[i].store(buffer[i], std::memory_order_release);
+        }
+
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    /** Returns the last published value, or a zeroed one if none was. */
+    T load() const
+    {
+        uint32_t buffer[num_words];
+        uint32_t before, after;
+
+        do {
+            before = sequence.load(std::memory_order_acquire);
+            /* Acquire keeps the data read before the second sequence number */
+            for (size_t i = 0; i < num_words; i++) {
+                buffer[i] = words[i].load(std::memory_order_acquire);
+            }
+            after = sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+
+        T value;
+        memcpy(&value, buffer, sizeof(T));
+        return value;
+    }
+};
+
+#endif /* SEQLOCK_HPP */
@@ -0,0 +1,94 @@
+#ifndef SNAPSHOT_POOL_HPP
+#define SNAPSHOT_POOL_HPP
+
+#include <array>
+#include <atomic>
+
+/** Fixed pool of immutable snapshots of T, published by a single writer and
+ * read by any number of threads, RCU-style.
+ *
+ * Readers grab the latest published snapshot without ever blocking nor
+ * blocking the writer: each slot holds a count of readers, and the writer
+ * only builds the next snapshot in a slot that is neither published nor
+ * read. A reader that raced with the writer notices that the slot it counted
+ * itself on is not the published one anymore and retries.
+ *
+ * Snapshots are preallocated, so T can own heavy buffers which are reused
+ * from one snapshot to the next.
+ */
+template <typename T, int N>
+class SnapshotPool {
+    static_assert(N >= 2, "Need one published and one writable snapshot");
+
+    struct Slot {
+        T value;
+        std::atomic<int> readers{0};
+    };
+
+    std::array<Slot, N> slots;
+    std::atomic<int> published{-1};
+
+public:
+    /** Access to the storage, only meant for initialization before any
+     * snapshot is published. */
+    T& operator[](int index)
+    {
+        return slots[index].value;
+    }
+
+    /** Returns a snapshot that the writer may modify, or nullptr if all of
+     * them are in use. Must only be called by the writer thread. */
+    T* writable()
+    {
+        const int current = published.load();
+        for (int i = 0; i < N; i++) {
+            if (i != current && slots[i].readers.load() == 0) {
+                return &slots[i].value;
+            }
+        }
+        return nullptr;
+    }
+
+    /** Makes the given snapshot, obtained from writable(), the latest one. */
+    void publish(T* snapshot)
+    {
+        published.store(index_of(snapshot));
+    }
+
+    /** Returns the latest snapshot, or nullptr if none was published yet.
+     * The snapshot stays unchanged until given back with release(). */
+    const T* acquire()
+    {
+        while (true) {
+            const int current = published.load();
+            if (current < 0) {
+                return nullptr;
+            }
+
+            slots[current].readers.fetch_add(1);
+            if (published.load() == current) {
+                return &slots[current].value;
+            }
+            slots[current].readers.fetch_sub(1);
+        }
+    }
+
+    /** Gives back a snapshot obtained from acquire(). */
+    void release(const T* snapshot)
+    {
+        slots[index_of(snapshot)].readers.fetch_sub(1);
+    }
+
+private:
+    int index_of(const T* snapshot) const
+    {
+        for (int i = 0; i < N; i++) {
+            if (&slots[i].value == snapshot) {
+                return i;
+            }
+        }
+        return -1;
+    }
+};
+
+#endif /* SNAPSHOT_POOL_HPP */
@@ -5,6 +5,7 @@
 
 #include "main.h"
 #include "config.h"
+#include "config_accessors.h"
 #include "robot_helpers/beacon_helpers.h"
 #include "protobuf/beacons.pb.h"
 
@@ -12,25 +13,12 @@ static TOPIC_DECL(proximity_beacon_topic, BeaconSignal);
 
 static void beacon_cb(const uavcan::ReceivedDataStructure<cvra::proximity_beacon::Signal>& msg)
 {
-    float reflector_radius;
-    float angular_offset;
-
-    parameter_t *reflector_radius_p, *angular_offset_p;
-    reflector_radius_p = parameter_find(&global_config, "/master/beacon/reflector_radius");
-    angular_offset_p = parameter_find(&global_config, "/master/beacon/angular_offset");
-
-    if (reflector_radius_p == NULL || angular_offset_p == NULL) {
-        WARNING("Cound not find beacon parameters!");
-        return;
-    }
-
-    reflector_radius = parameter_scalar_get(reflector_radius_p);
-    angular_offset = parameter_scalar_get(angular_offset_p);
+    float reflector_radius = config_master_beacon_reflector_radius();
+    float angular_offset = config_master_beacon_angular_offset();
 
     BeaconSignal data;
 
-    // TODO: replace this once the timestamp module is ported
-    data.timestamp.us = 0;
+    data.timestamp.us = timestamp_get();
     data.range.range.distance = reflector_radius / tanf(msg.length / 2.);
     data.range.range.type = Range_RangeType_OTHER;
     data.range.angle = beacon_get_angle(msg.start_angle + angular_offset, msg.length);
@@ -101,6 +101,15 @@ void motor_driver_set_voltage(motor_driver_t* d, float voltage)
     motor_driver_unlock(d);
 }
 
+void motor_driver_set_trajectory(motor_driver_t* d, const scurve_t* profile)
+{
+    motor_driver_lock(d);
+    d->control_mode = MOTOR_CONTROL_MODE_TRAJECTORY;
+    d->trajectory.profile = *profile;
+    d->trajectory.started = false;
+    motor_driver_unlock(d);
+}
+
 void motor_driver_disable(motor_driver_t* d)
 {
     motor_driver_lock(d);
@@ -165,6 +174,21 @@ float motor_driver_get_voltage_setpt(motor_driver_t* d)
     return d->setpt.voltage;
 }
 
+scurve_point_t motor_driver_get_trajectory_setpt(motor_driver_t* d, int64_t now_us)
+{
+    if (d->control_mode != MOTOR_CONTROL_MODE_TRAJECTORY) {
+        ERROR("motor driver get trajectory wrong setpt mode");
+    }
+
+    if (!d->trajectory.started) {
+        d->trajectory.start_us = now_us;
+        d->trajectory.started = true;
+    }
+
+    float t = (now_us - d->trajectory.start_us) / 1e6f;
+    return scurve_sample(&d->trajectory.profile, t);
+}
+
 void motor_driver_set_stream_value(motor_driver_t* d, uint32_t stream, float value)
 {
     if (stream < MOTOR_STREAMS_NB_VALUES) {
@@ -1,8 +1,11 @@
 #ifndef MOTOR_DRIVER_H
 #define MOTOR_DRIVER_H
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <parameter/parameter.h>
 #include <pthread.h>
+#include "math/scurve.h"
 
 #define MOTOR_ID_MAX_LEN 24
 #define MOTOR_ID_MAX_LEN_WITH_NUL (MOTOR_ID_MAX_LEN + 1) // terminated C string buffer
@@ -12,6 +15,7 @@
 #define MOTOR_CONTROL_MODE_VELOCITY 2
 #define MOTOR_CONTROL_MODE_TORQUE 3
 #define MOTOR_CONTROL_MODE_VOLTAGE 4
+#define MOTOR_CONTROL_MODE_TRAJECTORY 5
 
 #define MOTOR_STREAMS_NB_VALUES 10
 #define MOTOR_STREAM_CURRENT 0
@@ -49,6 +53,13 @@ typedef struct {
         float voltage;
     } setpt;
 
+    /* Valid in trajectory mode, sampled when sending each setpoint */
+    struct {
+        scurve_t profile;
+        bool started;
+        int64_t start_us;
+    } trajectory;
+
     struct {
         parameter_namespace_t root;
         parameter_namespace_t control;
@@ -109,6 +120,9 @@ void motor_driver_set_position(motor_driver_t* d, float position);
 void motor_driver_set_velocity(motor_driver_t* d, float velocity);
 void motor_driver_set_torque(motor_driver_t* d, float torque);
 void motor_driver_set_voltage(motor_driver_t* d, float voltage);
+
+// the motion starts when its first setpoint is sent to the motor board
+void motor_driver_set_trajectory(motor_driver_t* d, const scurve_t* profile);
 void motor_driver_disable(motor_driver_t* d);
 
 #define CAN_ID_NOT_SET 0xFFFF
@@ -127,6 +141,9 @@ float motor_driver_get_velocity_setpt(motor_driver_t* d);
 float motor_driver_get_torque_setpt(motor_driver_t* d);
 float motor_driver_get_voltage_setpt(motor_driver_t* d);
 
+// now_us is a monotonic time, the first call sets the start of the trajectory
+scurve_point_t motor_driver_get_trajectory_setpt(motor_driver_t* d, int64_t now_us);
+
 void motor_driver_set_stream_value(motor_driver_t* d, uint32_t stream, float value);
 uint32_t motor_driver_get_stream_change_status(motor_driver_t* d);
 float motor_driver_get_and_clear_stream_value(motor_driver_t* d, uint32_t stream);
@@ -1,3 +1,4 @@
+#include <atomic>
 #include <uavcan/uavcan.hpp>
 #include <uavcan/protocol/NodeStatus.hpp>
 #include <uavcan/protocol/param/GetSet.hpp>
@@ -5,6 +6,7 @@
 #include <cvra/motor/control/Position.hpp>
 #include <cvra/motor/control/Torque.hpp>
 #include <cvra/motor/control/Voltage.hpp>
+#include <cvra/motor/control/Trajectory.hpp>
 
 #include <error/error.h>
 #include <timestamp/timestamp.h>
@@ -14,13 +16,14 @@
 #include "motor_manager.h"
 #include "control_panel.h"
 #include "main.h"
+#include "debug/control_latency.hpp"
 
 using namespace uavcan;
 using namespace cvra::motor;
 
 /*** Sends a setpoint to the motor board, picking the message type according to
- * the current value. */
-static void motor_driver_uavcan_send_setpoint(motor_driver_t* d);
+ * the current value. now_us is the monotonic time the setpoint is sent at. */
+static void motor_driver_uavcan_send_setpoint(motor_driver_t* d, int64_t now_us);
 
 /** Send new parameters from the global tree to the motor board. */
 static int motor_driver_uavcan_update_config(motor_driver_t* d);
@@ -29,6 +32,23 @@ static LazyConstructor<Publisher<control::Velocity>> velocity_pub;
 static LazyConstructor<Publisher<control::Position>> position_pub;
 static LazyConstructor<Publisher<control::Torque>> torque_pub;
 static LazyConstructor<Publisher<control::Voltage>> voltage_pub;
+static LazyConstructor<Publisher<control::Trajectory>> trajectory_pub;
+
+static std::atomic<bool> setpoints_requested{false};
+
+static void motor_driver_uavcan_send_setpoints(int64_t now_us)
+{
+    motor_driver_t* drv_list;
+    uint16_t drv_list_len;
+
+    motor_manager_get_list(&motor_manager, &drv_list, &drv_list_len);
+
+    for (int i = 0; i < drv_list_len; i++) {
+        motor_driver_uavcan_send_setpoint(&drv_list[i], now_us);
+    }
+
+    control_latency.setpoint_sent(control_latency_now_us());
+}
 
 int motor_driver_uavcan_init(INode& node)
 {
@@ -36,6 +56,7 @@ int motor_driver_uavcan_init(INode& node)
     position_pub.construct<INode&>(node);
     torque_pub.construct<INode&>(node);
     voltage_pub.construct<INode&>(node);
+    trajectory_pub.construct<INode&>(node);
 
     /* Setup a timer that will send the config & setpoints to the motor boards
      * periodically.
@@ -45,8 +66,6 @@ int motor_driver_uavcan_init(INode& node)
     static Timer periodic_timer(node);
     periodic_timer.setCallback(
         [&](const TimerEvent& event) {
-            (void)event;
-
             motor_driver_t* drv_list;
             uint16_t drv_list_len;
 
@@ -59,9 +78,7 @@ int motor_driver_uavcan_init(INode& node)
                 }
             }
 
-            for (int i = 0; i < drv_list_len; i++) {
-                motor_driver_uavcan_send_setpoint(&drv_list[i]);
-            }
+            motor_driver_uavcan_send_setpoints(event.real_time.toUSec());
         });
 
     /* Starts the periodic timer. Its rate must be at least every 300 ms,
@@ -72,6 +89,18 @@ int motor_driver_uavcan_init(INode& node)
     return 0;
 }
 
+void motor_driver_uavcan_request_setpoints()
+{
+    setpoints_requested = true;
+}
+
+void motor_driver_uavcan_send_requested_setpoints(INode& node)
+{
+    if (setpoints_requested.exchange(false)) {
+        motor_driver_uavcan_send_setpoints(node.getMonotonicTime().toUSec());
+    }
+}
+
 static void update_motor_can_id(motor_driver_t* d)
 {
     int node_id = motor_driver_get_can_id(d);
@@ -95,12 +124,13 @@ static int motor_driver_uavcan_update_config(motor_driver_t* d)
     return 1;
 }
 
-static void motor_driver_uavcan_send_setpoint(motor_driver_t* d)
+static void motor_driver_uavcan_send_setpoint(motor_driver_t* d, int64_t now_us)
 {
     control::Position position_setpoint;
     control::Velocity velocity_setpoint;
     control::Torque torque_setpoint;
     control::Voltage voltage_setpoint;
+    control::Trajectory trajectory_setpoint;
 
     update_motor_can_id(d);
     int node_id = motor_driver_get_can_id(d);
@@ -134,6 +164,18 @@ static void motor_driver_uavcan_send_setpoint(motor_driver_t* d)
             voltage_pub->broadcast(voltage_setpoint);
         } break;
 
+        /* The board interpolates with the given acceleration until the next
+         * point, so the profile only needs to be sampled at our rate. */
+        case MOTOR_CONTROL_MODE_TRAJECTORY: {
+            scurve_point_t point = motor_driver_get_trajectory_setpt(d, now_us);
+            trajectory_setpoint.position = point.position;
+            trajectory_setpoint.velocity = point.velocity;
+            trajectory_setpoint.acceleration = point.acceleration;
+            trajectory_setpoint.torque = 0;
+            trajectory_setpoint.node_id = node_id;
+            trajectory_pub->broadcast(trajectory_setpoint);
+        } break;
+
         /* Nothing to do, not sending any setpoint will disable the board. */
         case MOTOR_CONTROL_MODE_DISABLED:
             break;
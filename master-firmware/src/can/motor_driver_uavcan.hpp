@@ -5,4 +5,12 @@
 
 int motor_driver_uavcan_init(uavcan::INode& node);
 
+/** Asks for the setpoints to be sent at the end of the current UAVCAN spin,
+ * instead of on the next periodic send. Can be called from any thread. */
+void motor_driver_uavcan_request_setpoints();
+
+/** Sends the setpoints if they were requested. Must be called from the
+ * UAVCAN thread, between two spins. */
+void motor_driver_uavcan_send_requested_setpoints(uavcan::INode& node);
+
 #endif /* MOTOR_DRIVER_UAVCAN_HPP */
@@ -111,3 +111,17 @@ void motor_manager_set_position(motor_manager_t* m,
     }
     motor_driver_set_position(driver, position);
 }
+
+void motor_manager_set_trajectory(motor_manager_t* m,
+                                  const char* actuator_id,
+                                  const scurve_t* profile)
+{
+    motor_driver_t* driver;
+    driver = get_driver(m, actuator_id);
+
+    if (driver == NULL) {
+        // control error
+        return;
+    }
+    motor_driver_set_trajectory(driver, profile);
+}
@@ -57,6 +57,10 @@ void motor_manager_set_position(motor_manager_t* m,
                                 const char* actuator_id,
                                 float position);
 
+void motor_manager_set_trajectory(motor_manager_t* m,
+                                  const char* actuator_id,
+                                  const scurve_t* profile);
+
 #ifdef __cplusplus
 }
 #endif
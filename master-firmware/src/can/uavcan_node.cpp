@@ -168,6 +168,10 @@ static void main(std::string can_iface, uint8_t id)
         if (res < 0) {
             WARNING("UAVCAN spin warning %d", res);
         }
+
+        /* Setpoints computed on encoder arrival go out after at most one spin
+         * period, instead of waiting for the periodic send */
+        motor_driver_uavcan_send_requested_setpoints(node);
     }
 }
 
@@ -4,6 +4,7 @@
 #include "protobuf/encoders.pb.h"
 #include <error/error.h>
 #include "main.h"
+#include "debug/control_latency.hpp"
 #include <msgbus/messagebus.h>
 #include <msgbus/posix/port.h>
 
@@ -17,11 +18,15 @@ using Subscriber = uavcan::Subscriber<cvra::odometry::WheelEncoder>;
 static void WheelEncoder_handler(
     const uavcan::ReceivedDataStructure<cvra::odometry::WheelEncoder>& msg)
 {
+    control_latency.encoders_received(msg.getMonotonicTimestamp().toUSec());
+
     DEBUG_EVERY_N(100, "received wheel encoder (%d;%d)", msg.left_encoder_raw, msg.right_encoder_raw);
     WheelEncodersPulse bus_msg;
     bus_msg.left = msg.left_encoder_raw;
     bus_msg.right = msg.right_encoder_raw;
+
     messagebus_topic_publish(&encoders_topic, &bus_msg, sizeof(bus_msg));
+    control_latency.encoders_published(control_latency_now_us());
 }
 
 int wheel_encoder_handler_init(uavcan::INode& node)
@@ -14,6 +14,7 @@ extern "C" {
 #include <string.h>
 #include <shell.h>
 #include "config.h"
+#include "config_accessors.h"
 #include "commands.h"
 #include "debug/panic_log.h"
 #include "unix_timestamp.h"
@@ -716,8 +717,8 @@ SHELL_COMMAND(wheel_calib, chp, argc, argv)
         return;
     }
 
-    parameter_scalar_set(PARAMETER("master/odometry/left_wheel_correction_factor"), left_gain);
-    parameter_scalar_set(PARAMETER("master/odometry/right_wheel_correction_factor"), right_gain);
+    parameter_scalar_set(config_master_odometry_left_wheel_correction_factor_param(), left_gain);
+    parameter_scalar_set(config_master_odometry_right_wheel_correction_factor_param(), right_gain);
     chprintf(chp, "New wheel correction factors set\r\n");
 }
 
@@ -773,7 +774,7 @@ SHELL_COMMAND(track_calib, chp, argc, argv)
         return;
     }
 
-    parameter_scalar_set(PARAMETER("master/odometry/external_track_mm"), track_calibrated);
+    parameter_scalar_set(config_master_odometry_external_track_mm_param(), track_calibrated);
     chprintf(chp, "New track set\r\n");
 }
 
@@ -4,12 +4,19 @@
 #include <error/error.h>
 #include "config.h"
 
+#include "config_accessors.h"
 #include "config_private.h"
 
 parameter_namespace_t global_config;
 parameter_namespace_t actuator_config;
 parameter_namespace_t master_config;
 
+/* Large enough for the config files and the parameters declared by the
+ * drivers, see parameter_namespace_index() */
+#define CONFIG_INDEX_SIZE 1024
+static parameter_index_t config_index;
+static parameter_index_entry_t config_index_entries[CONFIG_INDEX_SIZE];
+
 void config_init(void)
 {
     config_master_init(); // Generated, see config_private.h
@@ -18,9 +25,11 @@ void config_init(void)
     memcpy(&global_config, &config.ns, sizeof(parameter_namespace_t));
     memcpy(&master_config, &config.master.ns, sizeof(parameter_namespace_t));
     parameter_namespace_declare(&actuator_config, &global_config, "actuator");
+
+    parameter_namespace_index(&global_config, &config_index, config_index_entries, CONFIG_INDEX_SIZE);
 }
 
-static parameter_t* config_get_param(const char* id)
+parameter_t* config_get_param(const char* id)
 {
     parameter_t* p;
 
@@ -47,3 +56,15 @@ bool config_get_boolean(const char* id)
 {
     return parameter_boolean_get(config_get_param(id));
 }
+
+bool config_changed_since(parameter_t* p, uint32_t* generation)
+{
+    uint32_t current = parameter_generation(p);
+
+    if (current == *generation) {
+        return false;
+    }
+
+    *generation = current;
+    return true;
+}
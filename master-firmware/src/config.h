@@ -14,6 +14,12 @@ extern parameter_namespace_t master_config;
 /* Inits all the globally available objects. */
 void config_init(void);
 
+/** Find a parameter via its name, to read it later without searching for it.
+ *
+ * @note Panics if the ID is unknown.
+ */
+parameter_t* config_get_param(const char* id);
+
 /** Shorthand to get a parameter via its name.
  *
  * @note Panics if the ID is unknown.
@@ -22,6 +28,14 @@ float config_get_scalar(const char* id);
 int config_get_integer(const char* id);
 bool config_get_boolean(const char* id);
 
+/** Returns true if the parameter was set since the last call with the same
+ * generation, which should be initialized to zero.
+ *
+ * Unlike parameter_changed(), several readers can each keep their own
+ * generation for the same parameter.
+ */
+bool config_changed_since(parameter_t* p, uint32_t* generation);
+
 /* Macro to easily find a parameter from path */
 #define PARAMETER(s) parameter_find(&global_config, (s))
 
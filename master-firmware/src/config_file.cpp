@@ -0,0 +1,95 @@
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#include <error/error.h>
+#include <parameter/parameter_msgpack.h>
+
+#include "config.h"
+#include "config_file.h"
+
+static void config_file_err_cb(void* arg, const char* id, const char* err)
+{
+    const char* path = static_cast<const char*>(arg);
+    WARNING("%s: parameter %s: %s", path, id == NULL ? "(...)" : id, err);
+}
+
+static void config_file_load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!file.good() && !file.eof()) {
+        WARNING("Could not read config file %s", path.c_str());
+        return;
+    }
+
+    void* arg = const_cast<char*>(path.c_str());
+
+    /* Nothing is applied unless the whole file can be */
+    int problems = parameter_msgpack_check(&global_config, content.data(), content.size(),
+                                           config_file_err_cb, arg);
+    if (problems != 0) {
+        WARNING("Config file %s rejected", path.c_str());
+        return;
+    }
+
+    parameter_msgpack_load(&global_config, content.data(), content.size(),
+                           config_file_err_cb, config_file_err_cb, arg);
+    NOTICE("Loaded config file %s", path.c_str());
+}
+
+static void config_file_watch(std::string path, int fd)
+{
+    const size_t name_start = path.rfind('/') + 1; // 0 if there is no '/'
+    const std::string name = path.substr(name_start);
+
+    alignas(struct inotify_event) char buffer[4096];
+
+    while (true) {
+        ssize_t len = read(fd, buffer, sizeof(buffer));
+        if (len <= 0) {
+            WARNING("Stopped watching config file %s", path.c_str());
+            close(fd);
+            return;
+        }
+
+        /* Several events can come for a single write, load it once */
+        bool changed = false;
+        for (char* p = buffer; p < buffer + len;) {
+            auto event = reinterpret_cast<struct inotify_event*>(p);
+            if (event->len > 0 && name == event->name) {
+                changed = true;
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+
+        if (changed) {
+            config_file_load(path);
+        }
+    }
+}
+
+void config_file_watch_start(const std::string& path)
+{
+    config_file_load(path);
+
+    /* The directory is watched rather than the file, as editors and
+     * config_to_msgpack.py replace the file instead of writing to it */
+    const size_t name_start = path.rfind('/') + 1;
+    const std::string dir = name_start > 0 ? path.substr(0, name_start) : ".";
+
+    int fd = inotify_init();
+    if (fd < 0 || inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        WARNING("Cannot watch config file %s, it will not be reloaded", path.c_str());
+        if (fd >= 0) {
+            close(fd);
+        }
+        return;
+    }
+
+    std::thread watcher(config_file_watch, path, fd);
+    watcher.detach();
+}
@@ -0,0 +1,15 @@
+#ifndef CONFIG_FILE_H
+#define CONFIG_FILE_H
+
+#include <string>
+
+/** Loads the given MessagePack config file over the current config, then
+ * reloads it each time it is written, until the program exits.
+ *
+ * Each version of the file is checked entirely first and only applied if all
+ * its keys and values are valid, as a single batched update. Such a file can
+ * be generated from a YAML config with tools/config/config_to_msgpack.py --raw.
+ */
+void config_file_watch_start(const std::string& path);
+
+#endif /* CONFIG_FILE_H */
@@ -0,0 +1,132 @@
+#include <error/error.h>
+#include <timestamp/timestamp.h>
+
+#include "base/periodic_task.hpp"
+#include "msgbus_protobuf.h"
+#include "protobuf/latency.pb.h"
+#include "control_latency.hpp"
+
+using namespace std::chrono_literals;
+
+ControlLatencyTrace control_latency;
+
+int control_latency_bin(int64_t latency_us)
+{
+    static const int64_t bin_limits_us[CONTROL_LATENCY_BINS - 1] = {
+        100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000};
+
+    int bin = 0;
+    while (bin < CONTROL_LATENCY_BINS - 1 && latency_us >= bin_limits_us[bin]) {
+        bin++;
+    }
+    return bin;
+}
+
+void LatencyStats::record(int64_t latency_us)
+{
+    /* Clocks of different threads may not agree to the microsecond */
+    if (latency_us < 0) {
+        latency_us = 0;
+    }
+
+    count++;
+    sum_us += latency_us;
+    if (latency_us > max_us) {
+        max_us = latency_us;
+    }
+    bins[control_latency_bin(latency_us)]++;
+}
+
+void ControlLatencyTrace::encoders_received(int64_t rx_us)
+{
+    absl::MutexLock _(&lock);
+    sample++;
+    received_us = rx_us;
+    published = false;
+}
+
+void ControlLatencyTrace::encoders_published(int64_t now_us)
+{
+    absl::MutexLock _(&lock);
+    if (published) {
+        return;
+    }
+    stats_.publish.record(now_us - received_us);
+    published_us = now_us;
+    published = true;
+
+    /* Publishing wakes the control loop up, which may be done before the
+     * publisher stamps it */
+    if (controlled_sample == sample) {
+        stats_.control.record(0);
+    }
+}
+
+void ControlLatencyTrace::control_updated(int64_t now_us)
+{
+    absl::MutexLock _(&lock);
+    if (sample == 0 || controlled_sample == sample) {
+        return;
+    }
+    if (published) {
+        stats_.control.record(now_us - published_us);
+    }
+    controlled_sample = sample;
+    controlled_us = now_us;
+    controlled_received_us = received_us;
+    setpoint_pending = true;
+}
+
+void ControlLatencyTrace::setpoint_sent(int64_t now_us)
+{
+    absl::MutexLock _(&lock);
+    if (!setpoint_pending) {
+        return;
+    }
+    stats_.transmit.record(now_us - controlled_us);
+    stats_.total.record(now_us - controlled_received_us);
+    setpoint_pending = false;
+}
+
+ControlLatencyStats ControlLatencyTrace::stats() const
+{
+    absl::MutexLock _(&lock);
+    return stats_;
+}
+
+int64_t control_latency_now_us()
+{
+    return ltimestamp_get();
+}
+
+static void latency_histogram_fill(LatencyHistogram* msg, const LatencyStats& stats)
+{
+    msg->count = stats.count;
+    msg->mean_us = stats.count ? stats.sum_us / stats.count : 0;
+    msg->max_us = stats.max_us;
+
+    static_assert(CONTROL_LATENCY_BINS == sizeof(msg->bins) / sizeof(msg->bins[0]),
+                  "Update the max_count of bins in latency.proto");
+    for (int i = 0; i < CONTROL_LATENCY_BINS; i++) {
+        msg->bins[i] = stats.bins[i];
+    }
+}
+
+void control_latency_publisher_start(messagebus_t* bus)
+{
+    static TOPIC_DECL(control_latency_topic, ControlLatency);
+    messagebus_advertise_topic(bus, &control_latency_topic.topic, "/control_latency");
+
+    static PeriodicTask publisher("control_latency", 1s);
+    publisher.start([]() {
+        ControlLatencyStats stats = control_latency.stats();
+
+        ControlLatency msg = ControlLatency_init_default;
+        latency_histogram_fill(&msg.publish, stats.publish);
+        latency_histogram_fill(&msg.control, stats.control);
+        latency_histogram_fill(&msg.transmit, stats.transmit);
+        latency_histogram_fill(&msg.total, stats.total);
+
+        messagebus_topic_publish(&control_latency_topic.topic, &msg, sizeof(msg));
+    });
+}
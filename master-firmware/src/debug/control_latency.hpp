@@ -0,0 +1,77 @@
+#ifndef CONTROL_LATENCY_HPP
+#define CONTROL_LATENCY_HPP
+
+#include <cstdint>
+#include <absl/synchronization/mutex.h>
+#include <msgbus/messagebus.h>
+
+/** Number of bins of the latency histograms, see control_latency_bin(). */
+#define CONTROL_LATENCY_BINS 11
+
+/** Returns the histogram bin of a latency in microseconds. The bins are
+ * bounded by 0.1, 0.2, 0.5, 1, 2, 5, 10, 20, 50 and 100 ms, the last one
+ * counting anything slower. */
+int control_latency_bin(int64_t latency_us);
+
+struct LatencyStats {
+    uint64_t count = 0;
+    int64_t sum_us = 0;
+    int64_t max_us = 0;
+    uint64_t bins[CONTROL_LATENCY_BINS] = {};
+
+    void record(int64_t latency_us);
+};
+
+/** Latency of each stage of the control path, all fed by the same samples. */
+struct ControlLatencyStats {
+    LatencyStats publish; /**< Encoder frame received to /encoders published. */
+    LatencyStats control; /**< /encoders published to control update. */
+    LatencyStats transmit; /**< Control update to setpoint sent to the motors. */
+    LatencyStats total; /**< Encoder frame received to setpoint sent. */
+};
+
+/** Follows encoder samples from their reception on the CAN bus to the motor
+ * setpoints computed from them.
+ *
+ * Each stage is timestamped by the thread doing it and matched to the latest
+ * sample. A sample is only counted once per stage: control updates running
+ * without a new sample and setpoints sent again without a new control update
+ * are not measured.
+ */
+class ControlLatencyTrace {
+public:
+    void encoders_received(int64_t rx_us);
+    void encoders_published(int64_t now_us);
+    void control_updated(int64_t now_us);
+    void setpoint_sent(int64_t now_us);
+
+    ControlLatencyStats stats() const;
+
+private:
+    mutable absl::Mutex lock;
+    ControlLatencyStats stats_ GUARDED_BY(lock);
+
+    uint32_t sample GUARDED_BY(lock) = 0;
+    int64_t received_us GUARDED_BY(lock) = 0;
+    int64_t published_us GUARDED_BY(lock) = 0;
+    bool published GUARDED_BY(lock) = false;
+
+    uint32_t controlled_sample GUARDED_BY(lock) = 0;
+    int64_t controlled_us GUARDED_BY(lock) = 0;
+    int64_t controlled_received_us GUARDED_BY(lock) = 0;
+    bool setpoint_pending GUARDED_BY(lock) = false;
+};
+
+/** Trace of the robot's control path. */
+extern ControlLatencyTrace control_latency;
+
+/** Time base of the trace, the same monotonic clock as UAVCAN's. It is
+ * ltimestamp_get(), so that latencies can be compared with the pose history
+ * stamped with timestamp_get(). */
+int64_t control_latency_now_us();
+
+/** Publishes the statistics of control_latency on /control_latency every
+ * second. */
+void control_latency_publisher_start(messagebus_t* bus);
+
+#endif /* CONTROL_LATENCY_HPP */
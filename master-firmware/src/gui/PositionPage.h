@@ -1,4 +1,5 @@
 #pragma once
+#include <math.h>
 #include "gfx.h"
 #include <error/error.h>
 
@@ -42,14 +43,9 @@ public:
 
     void on_timer() override
     {
-        auto x = 0, y = 0, a = 0;
-
-        {
-            absl::MutexLock l(&robot.lock);
-            x = position_get_x_s16(&robot.pos);
-            y = position_get_y_s16(&robot.pos);
-            a = position_get_a_deg_s16(&robot.pos);
-        }
+        /* Never blocks the position manager */
+        struct robot_pose pose = robot.pose.load();
+        int x = pose.x, y = pose.y, a = pose.a * 180 / M_PI;
 
         std::string msg = absl::StrCat("x: ", x, " y: ", y, " a: ", a, " deg");
 
@@ -11,6 +11,7 @@
 #include "msgbus/messagebus.h"
 #include "main.h"
 #include "config.h"
+#include "config_accessors.h"
 
 class ScorePage : public Page {
     GHandle page_title;
@@ -55,7 +56,7 @@ public:
 
         int score;
         if (messagebus_topic_read(topic, &state, sizeof state)) {
-            bool is_main_robot = config_get_boolean("/master/is_main_robot");
+            bool is_main_robot = config_master_is_main_robot();
             score = compute_score(state, is_main_robot);
         } else {
             score = -1;
@@ -17,11 +17,12 @@
 #include <msgbus/posix/port.h>
 #include "can/uavcan_node.h"
 #include "config.h"
+#include "config_file.h"
 #include <parameter/parameter_msgpack.h>
-#include <cmp_mem_access/cmp_mem_access.h>
 #include "can/motor_manager.h"
 #include <error/error.h>
 #include "base/base_controller.h"
+#include "debug/control_latency.hpp"
 #include "robot_helpers/trajectory_helpers.h"
 #include "strategy.h"
 #include "gui.h"
@@ -45,6 +46,7 @@ ABSL_FLAG(std::string, can_iface, "vcan0", "SocketCAN interface to use. If empty
 ABSL_FLAG(bool, verbose, false, "Enable verbose output");
 ABSL_FLAG(bool, enable_gui, true, "Enable on-robot GUI");
 ABSL_FLAG(std::string, robot_config, "simulation", "Which config to load, can be order, chaos or simulation.");
+ABSL_FLAG(std::string, config_file, "", "MessagePack config file applied over robot_config, reloaded when it changes.");
 
 void config_load_err_cb(void* arg, const char* id, const char* err)
 {
@@ -52,10 +54,16 @@ void config_load_err_cb(void* arg, const char* id, const char* err)
     ERROR("parameter %s: %s", id == NULL ? "(...)" : id, err);
 }
 
+void config_load_unknown_cb(void* arg, const char* id, const char* err)
+{
+    (void)arg;
+    WARNING("parameter %s: %s", id, err);
+}
+
 void config_load_from_flash()
 {
-    cmp_ctx_t cmp;
-    cmp_mem_access_t mem;
+    const void* config = nullptr;
+    size_t config_size = 0;
 
     extern unsigned char msgpack_config_chaos[];
     extern const size_t msgpack_config_chaos_size;
@@ -66,20 +74,27 @@ void config_load_from_flash()
 
     if (absl::GetFlag(FLAGS_robot_config) == "chaos") {
         NOTICE("Loading msgpack config for Chaos");
-        cmp_mem_access_ro_init(&cmp, &mem, msgpack_config_chaos, msgpack_config_chaos_size);
+        config = msgpack_config_chaos;
+        config_size = msgpack_config_chaos_size;
     } else if (absl::GetFlag(FLAGS_robot_config) == "order") {
         NOTICE("Loading msgpack config for order");
-        cmp_mem_access_ro_init(&cmp, &mem, msgpack_config_order, msgpack_config_order_size);
+        config = msgpack_config_order;
+        config_size = msgpack_config_order_size;
     } else if (absl::GetFlag(FLAGS_robot_config) == "simulation") {
         NOTICE("Loading msgpack config for the simulator");
-        cmp_mem_access_ro_init(&cmp, &mem, msgpack_config_simulation, msgpack_config_simulation_size);
+        config = msgpack_config_simulation;
+        config_size = msgpack_config_simulation_size;
     } else {
         ERROR("Unknown robot_config value %s", absl::GetFlag(FLAGS_robot_config).c_str());
     }
 
-    int ret = parameter_msgpack_read_cmp(&global_config, &cmp, config_load_err_cb, nullptr);
-    if (ret != 0) {
-        ERROR("parameter_msgpack_read_cmp failed");
+    /* Unknown keys are all listed before stopping, so that they can be fixed at once */
+    int ret = parameter_msgpack_load(&global_config, config, config_size,
+                                     config_load_err_cb, config_load_unknown_cb, nullptr);
+    if (ret < 0) {
+        ERROR("parameter_msgpack_load failed");
+    } else if (ret > 0) {
+        ERROR("%d unknown keys in config", ret);
     }
 }
 
@@ -152,6 +167,9 @@ int main(int argc, char** argv)
 
     /* Load stored robot config */
     config_load_from_flash();
+    if (!absl::GetFlag(FLAGS_config_file).empty()) {
+        config_file_watch_start(absl::GetFlag(FLAGS_config_file));
+    }
 
     control_panel_init();
     if (absl::GetFlag(FLAGS_enable_gui)) {
@@ -163,6 +181,7 @@ int main(int argc, char** argv)
     base_controller_start();
     position_manager_start();
     trajectory_manager_start();
+    control_latency_publisher_start(&bus);
 
     //strategy_play_game();
 
@@ -0,0 +1,125 @@
+#include <math.h>
+
+#include "scurve.h"
+
+/* Durations of the jerk and constant acceleration segments needed to go from
+ * rest to the given velocity. */
+static void scurve_acceleration_phase(float vel, float max_acc, float max_jerk, float* t_jerk, float* t_acc)
+{
+    if (vel * max_jerk >= max_acc * max_acc) {
+        *t_jerk = max_acc / max_jerk;
+        *t_acc = vel / max_acc - *t_jerk;
+    } else {
+        /* Maximum acceleration is never reached */
+        *t_jerk = sqrtf(vel / max_jerk);
+        *t_acc = 0;
+    }
+}
+
+void scurve_plan(scurve_t* s, float start, float end, float max_vel, float max_acc, float max_jerk)
+{
+    float distance = fabsf(end - start);
+    float vel = max_vel;
+    float t_jerk, t_acc, t_cruise;
+
+    s->start = start;
+    s->end = end;
+    s->direction = end >= start ? 1 : -1;
+
+    /* The acceleration is symmetric, so the mean velocity while accelerating
+     * is half the final one */
+    scurve_acceleration_phase(vel, max_acc, max_jerk, &t_jerk, &t_acc);
+    float acc_distance = vel * (2 * t_jerk + t_acc) / 2;
+
+    if (2 * acc_distance <= distance) {
+        t_cruise = (distance - 2 * acc_distance) / vel;
+    } else {
+        /* Too short to reach max velocity, find the highest reachable one,
+         * first assuming max acceleration is reached */
+        float t = max_acc / max_jerk;
+        vel = max_acc * (sqrtf(t * t + 4 * distance / max_acc) - t) / 2;
+
+        if (vel * max_jerk < max_acc * max_acc) {
+            vel = powf(distance * sqrtf(max_jerk) / 2, 2.f / 3.f);
+        }
+
+        scurve_acceleration_phase(vel, max_acc, max_jerk, &t_jerk, &t_acc);
+        t_cruise = 0;
+    }
+
+    const float jerk[SCURVE_NUM_SEGMENTS] = {max_jerk, 0, -max_jerk, 0, -max_jerk, 0, max_jerk};
+    const float duration[SCURVE_NUM_SEGMENTS] = {t_jerk, t_acc, t_jerk, t_cruise, t_jerk, t_acc, t_jerk};
+
+    float time = 0;
+    scurve_point_t p = {0, 0, 0};
+
+    for (int i = 0; i < SCURVE_NUM_SEGMENTS; i++) {
+        float j = jerk[i], dt = duration[i];
+
+        s->jerk[i] = j;
+        s->duration[i] = dt;
+        s->start_time[i] = time;
+        s->start_point[i] = p;
+
+        p.position += p.velocity * dt + p.acceleration * dt * dt / 2 + j * dt * dt * dt / 6;
+        p.velocity += p.acceleration * dt + j * dt * dt / 2;
+        p.acceleration += j * dt;
+        time += dt;
+    }
+}
+
+float scurve_duration(const scurve_t* s)
+{
+    const int last = SCURVE_NUM_SEGMENTS - 1;
+    return s->start_time[last] + s->duration[last];
+}
+
+scurve_point_t scurve_sample(const scurve_t* s, float t)
+{
+    scurve_point_t res = {s->start, 0, 0};
+
+    if (t <= 0) {
+        return res;
+    }
+
+    if (t >= scurve_duration(s)) {
+        res.position = s->end;
+        return res;
+    }
+
+    int i = SCURVE_NUM_SEGMENTS - 1;
+    while (i > 0 && s->start_time[i] > t) {
+        i--;
+    }
+
+    const scurve_point_t* p = &s->start_point[i];
+    float j = s->jerk[i];
+    float dt = t - s->start_time[i];
+
+    res.position = p->position + p->velocity * dt + p->acceleration * dt * dt / 2 + j * dt * dt * dt / 6;
+    res.velocity = p->velocity + p->acceleration * dt + j * dt * dt / 2;
+    res.acceleration = p->acceleration + j * dt;
+
+    res.position = s->start + s->direction * res.position;
+    res.velocity *= s->direction;
+    res.acceleration *= s->direction;
+
+    return res;
+}
+
+int scurve_sample_chunk(const scurve_t* s, float t_start, float period, scurve_point_t* points, int max_points)
+{
+    float duration = scurve_duration(s);
+    int n = 0;
+
+    while (n < max_points) {
+        float t = t_start + n * period;
+        points[n++] = scurve_sample(s, t);
+
+        if (t >= duration) {
+            break;
+        }
+    }
+
+    return n;
+}
@@ -0,0 +1,58 @@
+#ifndef SCURVE_H
+#define SCURVE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Jerk limited (S-curve) point to point motion profile.
+ *
+ * The motion starts and ends at rest. It is made of seven segments of
+ * constant jerk: jerk up, constant acceleration, jerk down, cruise, and the
+ * same mirrored for the deceleration. Segments which are not needed to reach
+ * the target, such as the cruise of a short motion, have a zero duration.
+ */
+
+#define SCURVE_NUM_SEGMENTS 7
+
+typedef struct {
+    float position;
+    float velocity;
+    float acceleration;
+} scurve_point_t;
+
+typedef struct {
+    float direction; // +1 or -1, the profile is computed for a positive motion
+    float jerk[SCURVE_NUM_SEGMENTS];
+    float duration[SCURVE_NUM_SEGMENTS];
+
+    /* Time and state at the start of each segment, relative to the start */
+    float start_time[SCURVE_NUM_SEGMENTS];
+    scurve_point_t start_point[SCURVE_NUM_SEGMENTS];
+
+    float start, end;
+} scurve_t;
+
+/** Computes the fastest motion from start to end which respects the given
+ * velocity, acceleration and jerk limits (all positive). */
+void scurve_plan(scurve_t* s, float start, float end, float max_vel, float max_acc, float max_jerk);
+
+/** Returns the duration of the motion in seconds */
+float scurve_duration(const scurve_t* s);
+
+/** Returns the setpoint t seconds after the start of the motion. Before the
+ * start it is at the start, after the end it stays at the end. */
+scurve_point_t scurve_sample(const scurve_t* s, float t);
+
+/** Samples the motion every period, starting at t_start, into points.
+ *
+ * Returns the number of points written, which stops at max_points or at the
+ * first point at or after the end of the motion (included).
+ */
+int scurve_sample_chunk(const scurve_t* s, float t_start, float period, scurve_point_t* points, int max_points);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCURVE_H */
@@ -0,0 +1,196 @@
+#include <math.h>
+
+#include "opponent_prediction.h"
+
+/* Number of positions sampled to build the swept obstacle */
+#define SWEPT_OBSTACLE_SAMPLES 8
+
+/* Time step of the space-time collision check, in seconds */
+#define COLLISION_CHECK_STEP 0.05f
+
+/* Wraps the angle in [-pi, pi] */
+static float wrap_angle(float angle)
+{
+    return atan2f(sinf(angle), cosf(angle));
+}
+
+void opponent_prediction_init(struct opponent_prediction* opponent, float smoothing)
+{
+    opponent->smoothing = smoothing;
+    opponent_prediction_reset(opponent);
+}
+
+void opponent_prediction_reset(struct opponent_prediction* opponent)
+{
+    opponent->position.x = 0;
+    opponent->position.y = 0;
+    opponent->timestamp = 0;
+    opponent->speed = 0;
+    opponent->heading = 0;
+    opponent->turn_rate = 0;
+    opponent->num_measurements = 0;
+}
+
+static void restart_from(struct opponent_prediction* opponent, point_t position, timestamp_t timestamp)
+{
+    opponent_prediction_reset(opponent);
+    opponent->position = position;
+    opponent->timestamp = timestamp;
+    opponent->num_measurements = 1;
+}
+
+void opponent_prediction_update(struct opponent_prediction* opponent, point_t position, timestamp_t timestamp)
+{
+    const float a = opponent->smoothing;
+
+    if (opponent->num_measurements == 0) {
+        restart_from(opponent, position, timestamp);
+        return;
+    }
+
+    float dt = timestamp_duration_s(opponent->timestamp, timestamp);
+
+    /* Same measurement read twice */
+    if (dt <= 0) {
+        return;
+    }
+
+    float vx = (position.x - opponent->position.x) / dt;
+    float vy = (position.y - opponent->position.y) / dt;
+    float speed = sqrtf(vx * vx + vy * vy);
+
+    /* Either we lost the opponent for a while, or the beacon jumped to
+     * something else: the previous motion tells nothing */
+    if (dt > OPPONENT_PREDICTION_TIMEOUT || speed > OPPONENT_PREDICTION_MAX_SPEED) {
+        restart_from(opponent, position, timestamp);
+        return;
+    }
+
+    if (speed > OPPONENT_PREDICTION_MIN_SPEED) {
+        float heading = atan2f(vy, vx);
+
+        if (opponent->speed > OPPONENT_PREDICTION_MIN_SPEED) {
+            float delta = wrap_angle(heading - opponent->heading);
+            opponent->turn_rate += a * (delta / dt - opponent->turn_rate);
+            opponent->heading = wrap_angle(opponent->heading + a * delta);
+        } else {
+            /* Starting to move, no previous heading to compare with */
+            opponent->heading = heading;
+            opponent->turn_rate = 0;
+        }
+    } else {
+        opponent->turn_rate *= 1 - a;
+    }
+
+    opponent->speed += a * (speed - opponent->speed);
+    opponent->position = position;
+    opponent->timestamp = timestamp;
+    opponent->num_measurements++;
+}
+
+point_t opponent_prediction_position(const struct opponent_prediction* opponent, float dt)
+{
+    point_t p = opponent->position;
+    const float v = opponent->speed;
+    const float h = opponent->heading;
+    const float w = opponent->turn_rate;
+
+    if (v < OPPONENT_PREDICTION_MIN_SPEED) {
+        return p;
+    }
+
+    if (fabsf(w) < 1e-3f) {
+        p.x += v * cosf(h) * dt;
+        p.y += v * sinf(h) * dt;
+    } else {
+        p.x += v / w * (sinf(h + w * dt) - sinf(h));
+        p.y += v / w * (cosf(h) - cosf(h + w * dt));
+    }
+
+    return p;
+}
+
+void opponent_prediction_swept_obstacle(const struct opponent_prediction* opponent,
+                                        float horizon,
+                                        float opponent_size,
+                                        float robot_size,
+                                        poly_t* obstacle)
+{
+    const point_t origin = opponent->position;
+    const float inflation = (opponent_size + robot_size) / 2;
+    float along_min = 0, along_max = 0, across_min = 0, across_max = 0;
+    vect_t axis = {1, 0};
+
+    if (opponent->speed >= OPPONENT_PREDICTION_MIN_SPEED) {
+        axis.x = cosf(opponent->heading);
+        axis.y = sinf(opponent->heading);
+    }
+
+    /* Bounding box of the predicted positions, in the frame of the motion */
+    for (int i = 1; i <= SWEPT_OBSTACLE_SAMPLES; i++) {
+        point_t p = opponent_prediction_position(opponent, horizon * i / SWEPT_OBSTACLE_SAMPLES);
+        float dx = p.x - origin.x;
+        float dy = p.y - origin.y;
+        float along = dx * axis.x + dy * axis.y;
+        float across = -dx * axis.y + dy * axis.x;
+
+        along_min = fminf(along_min, along);
+        along_max = fmaxf(along_max, along);
+        across_min = fminf(across_min, across);
+        across_max = fmaxf(across_max, across);
+    }
+
+    along_min -= inflation;
+    along_max += inflation;
+    across_min -= inflation;
+    across_max += inflation;
+
+    const float corners[OPPONENT_PREDICTION_SWEPT_EDGES][2] = {
+        {along_max, across_min},
+        {along_max, across_max},
+        {along_min, across_max},
+        {along_min, across_min},
+    };
+
+    for (int i = 0; i < OPPONENT_PREDICTION_SWEPT_EDGES; i++) {
+        obstacle->pts[i].x = origin.x + corners[i][0] * axis.x - corners[i][1] * axis.y;
+        obstacle->pts[i].y = origin.y + corners[i][0] * axis.y + corners[i][1] * axis.x;
+    }
+}
+
+float opponent_prediction_time_to_collision(const struct opponent_prediction* opponent,
+                                            timestamp_t now,
+                                            point_t start,
+                                            point_t target,
+                                            float speed,
+                                            float horizon,
+                                            float min_distance)
+{
+    if (opponent->num_measurements == 0) {
+        return -1;
+    }
+
+    float age = timestamp_duration_s(opponent->timestamp, now);
+    if (age > OPPONENT_PREDICTION_TIMEOUT) {
+        return -1;
+    }
+
+    const float length = pt_norm(&start, &target);
+
+    for (float t = 0; t <= horizon; t += COLLISION_CHECK_STEP) {
+        point_t us = start;
+        if (length > 0) {
+            float travelled = fminf(speed * t, length) / length;
+            us.x += (target.x - start.x) * travelled;
+            us.y += (target.y - start.y) * travelled;
+        }
+
+        point_t them = opponent_prediction_position(opponent, age + t);
+
+        if (pt_norm(&us, &them) < min_distance) {
+            return t;
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,87 @@
+#ifndef OPPONENT_PREDICTION_H
+#define OPPONENT_PREDICTION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <timestamp/timestamp.h>
+#include <aversive/math/geometry/polygon.h>
+
+/** Above this speed (mm/s), a measurement is considered an outlier */
+#define OPPONENT_PREDICTION_MAX_SPEED 2000.f
+
+/** Below this speed (mm/s), the opponent heading is not tracked */
+#define OPPONENT_PREDICTION_MIN_SPEED 50.f
+
+/** Measurements older than this (s) are discarded and the opponent is
+ * considered static until seen again */
+#define OPPONENT_PREDICTION_TIMEOUT 0.5f
+
+/** Number of points of the swept obstacle */
+#define OPPONENT_PREDICTION_SWEPT_EDGES 4
+
+/** Constant speed and turn rate model of an opponent, fed with the
+ * (noisy) positions measured by the beacon.
+ */
+struct opponent_prediction {
+    point_t position; /**< Last measured position, in mm. */
+    timestamp_t timestamp; /**< Time of the last measurement. */
+    float speed; /**< Filtered speed, in mm/s. */
+    float heading; /**< Filtered direction of motion, in rad. */
+    float turn_rate; /**< Filtered turn rate, in rad/s. */
+    float smoothing; /**< Weight of a new measurement in the filters, in ]0, 1]. */
+    int num_measurements; /**< Zero if the opponent was never seen. */
+};
+
+/** Initialize the prediction, with no opponent seen yet
+ */
+void opponent_prediction_init(struct opponent_prediction* opponent, float smoothing);
+
+/** Forget the opponent, for example when it is not seen anymore
+ */
+void opponent_prediction_reset(struct opponent_prediction* opponent);
+
+/** Add a measured position of the opponent
+ */
+void opponent_prediction_update(struct opponent_prediction* opponent, point_t position, timestamp_t timestamp);
+
+/** Predict the position of the opponent dt seconds after its last measurement
+ */
+point_t opponent_prediction_position(const struct opponent_prediction* opponent, float dt);
+
+/** Set a rectangle covering the opponent during the next horizon seconds
+ *
+ * The rectangle is aligned with the predicted motion and inflated by half the
+ * size of the opponent plus half of ours, like map_set_rectangular_obstacle.
+ * @param [out] obstacle Polygon of OPPONENT_PREDICTION_SWEPT_EDGES points,
+ * ordered counter clock wise.
+ */
+void opponent_prediction_swept_obstacle(const struct opponent_prediction* opponent,
+                                        float horizon,
+                                        float opponent_size,
+                                        float robot_size,
+                                        poly_t* obstacle);
+
+/** Check when our robot, moving in straight line from start to target at the
+ * given speed (mm/s), first gets closer than min_distance to the opponent
+ *
+ * Both robots are sampled at the same times, so that paths crossing at
+ * different times are not reported.
+ * @returns The time of the collision from now, in seconds, or a negative
+ * value if there is none within horizon seconds.
+ */
+float opponent_prediction_time_to_collision(const struct opponent_prediction* opponent,
+                                            timestamp_t now,
+                                            point_t start,
+                                            point_t target,
+                                            float speed,
+                                            float horizon,
+                                            float min_distance);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OPPONENT_PREDICTION_H */
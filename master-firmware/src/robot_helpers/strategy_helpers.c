@@ -88,12 +88,8 @@ float strategy_flight_distance_to_goal(point_t pos, point_t goal)
 float strategy_distance_to_goal(point_t pos, point_t goal)
 {
     float distance;
-    struct _map* map = map_server_map_lock_and_get();
-    oa_start_end_points(&map->oa, pos.x, pos.y, goal.x, goal.y);
-    oa_process(&map->oa);
-
-    point_t* points;
-    int num_points = oa_get_path(&map->oa, &points);
+    point_t points[MAX_CHKPOINTS];
+    int num_points = map_server_plan_path(pos, goal, false, points, MAX_CHKPOINTS);
 
     if (num_points <= 0) {
         distance = INFINITY;
@@ -104,8 +100,6 @@ float strategy_distance_to_goal(point_t pos, point_t goal)
         }
     }
 
-    map_server_map_release(map);
-
     return distance;
 }
 
@@ -1,25 +1,22 @@
-// TODO: Define this once map is converted to Linux, then delete all USE_MAP
-// ifdefs
+#include <algorithm>
 #include <unordered_map>
-#define USE_MAP 0
+#include <absl/time/clock.h>
 #include <absl/time/time.h>
 #include <absl/synchronization/mutex.h>
 #include <absl/types/optional.h>
 #include <thread>
 
 #include <error/error.h>
+#include <timestamp/timestamp.h>
 
 #include <aversive/trajectory_manager/trajectory_manager_utils.h>
 #include <aversive/trajectory_manager/trajectory_manager_core.h>
 
-#if USE_MAP
 #include "base/map.h"
-#endif
+#include "base/map_server.h"
 
 #include "math_helpers.h"
-#include "beacon_helpers.h"
 
-#include "protobuf/beacons.pb.h"
 #include "protobuf/ally_position.pb.h"
 
 #include "trajectory_helpers.h"
@@ -37,13 +34,53 @@ static const std::unordered_map<int, std::string> trajectory_reasons = {
     {TRAJ_END_ALLY_NEAR, "ally nearby"},
 };
 
+/* End reasons which are not signaled, such as beacon data getting stale, are
+ * still checked this often */
+static const absl::Duration trajectory_wait_max_sleep = absl::Milliseconds(100);
+
+static absl::Time trajectory_game_end_time();
+
+/* Events after which the watched end reasons must be checked again */
+static unsigned trajectory_watched_events(int watched_end_reasons)
+{
+    unsigned events = 0;
+
+    if (watched_end_reasons & (TRAJ_END_GOAL_REACHED | TRAJ_END_NEAR_GOAL)) {
+        events |= ROBOT_EVENT_TRAJECTORY;
+    }
+
+    if (watched_end_reasons & TRAJ_END_COLLISION) {
+        events |= ROBOT_EVENT_BLOCKING;
+    }
+
+    /* Our own motion changes the collision checks as well */
+    if (watched_end_reasons & (TRAJ_END_OPPONENT_NEAR | TRAJ_END_ALLY_NEAR)) {
+        events |= ROBOT_EVENT_OBSTACLE | ROBOT_EVENT_POSE;
+    }
+
+    return events;
+}
+
 int trajectory_wait_for_end(int watched_end_reasons)
 {
     std::this_thread::sleep_for(100ms);
+
+    const unsigned events = trajectory_watched_events(watched_end_reasons);
     int traj_end_reason = 0;
-    while (traj_end_reason == 0) {
+    while (true) {
+        /* Marked before checking, so no event can be missed in between */
+        RobotEvents::Mark mark = robot.events.mark();
+
         traj_end_reason = trajectory_has_ended(watched_end_reasons);
-        std::this_thread::sleep_for(1ms);
+        if (traj_end_reason != 0) {
+            break;
+        }
+
+        absl::Time deadline = absl::Now() + trajectory_wait_max_sleep;
+        if (watched_end_reasons & TRAJ_END_TIMER) {
+            deadline = std::min(deadline, trajectory_game_end_time());
+        }
+        robot.events.wait(mark, events, deadline);
     }
 
     auto reason = trajectory_reasons.find(traj_end_reason);
@@ -63,7 +100,6 @@ int trajectory_wait_for_end(int watched_end_reasons)
 
 int trajectory_has_ended(int watched_end_reasons)
 {
-    absl::MutexLock _(&robot.lock);
     if ((watched_end_reasons & TRAJ_END_GOAL_REACHED) && trajectory_finished(&robot.traj)) {
         return TRAJ_END_GOAL_REACHED;
     }
@@ -73,38 +109,32 @@ int trajectory_has_ended(int watched_end_reasons)
     }
 
     if (watched_end_reasons & TRAJ_END_COLLISION) {
-        if (bd_get(&robot.angle_bd) || bd_get(&robot.distance_bd)) {
-            WARNING("Stopping because of a collision");
+        bool collision;
+        {
+            absl::MutexLock _(&robot.bd_lock);
+            collision = bd_get(&robot.angle_bd) || bd_get(&robot.distance_bd);
+            if (collision) {
+                bd_reset(&robot.distance_bd);
+                bd_reset(&robot.angle_bd);
+            }
+        }
 
+        if (collision) {
+            WARNING("Stopping because of a collision");
             trajectory_hardstop(&robot.traj);
-            bd_reset(&robot.distance_bd);
-            bd_reset(&robot.angle_bd);
             return TRAJ_END_COLLISION;
         }
     }
 
-#if USE_MAP
     if (watched_end_reasons & TRAJ_END_OPPONENT_NEAR) {
-        BeaconSignal beacon_signal;
-        messagebus_topic_t* proximity_beacon_topic = messagebus_find_topic_blocking(&bus, "/proximity_beacon");
-
-        // only consider recent beacon signal
-        if (messagebus_topic_read(proximity_beacon_topic, &beacon_signal, sizeof(beacon_signal)) && timestamp_duration_s(beacon_signal.timestamp.us, timestamp_get()) < TRAJ_MAX_TIME_DELAY_OPPONENT_DETECTION && beacon_signal.range.range.distance < TRAJ_MIN_DISTANCE_TO_OPPONENT) {
-            float x_opp, y_opp;
-            beacon_cartesian_convert(&robot.pos,
-                                     1000 * beacon_signal.range.range.distance,
-                                     beacon_signal.range.angle,
-                                     &x_opp,
-                                     &y_opp);
-
-            if (trajectory_is_on_collision_path(&robot, x_opp, y_opp)) {
-                return TRAJ_END_OPPONENT_NEAR;
-            }
+        // Same prediction as the obstacle of the map, only set if the
+        // opponent was seen recently
+        struct opponent_prediction opponent;
+        if (map_server_opponent_prediction(&opponent) && trajectory_will_collide_with_opponent(&robot, &opponent)) {
+            return TRAJ_END_OPPONENT_NEAR;
         }
     }
-#endif
 
-#if USE_MAP
     if (watched_end_reasons & TRAJ_END_ALLY_NEAR) {
         messagebus_topic_t* topic = messagebus_find_topic(&bus, "/ally_pos");
         AllyPosition pos;
@@ -115,7 +145,6 @@ int trajectory_has_ended(int watched_end_reasons)
             }
         }
     }
-#endif
 
     if (watched_end_reasons & TRAJ_END_TIMER && trajectory_game_has_ended()) {
         trajectory_hardstop(&robot.traj);
@@ -128,7 +157,10 @@ int trajectory_has_ended(int watched_end_reasons)
 void trajectory_align_with_wall(void)
 {
     /* Disable angle control */
-    robot.mode = BOARD_MODE_DISTANCE_ONLY;
+    {
+        absl::MutexLock _(&robot.cs_lock);
+        robot.mode = BOARD_MODE_DISTANCE_ONLY;
+    }
 
     /* Move in direction until we hit a wall */
     trajectory_d_rel(&robot.traj, robot.calibration_direction * 2000.);
@@ -136,11 +168,17 @@ void trajectory_align_with_wall(void)
 
     /* Stop moving on collision */
     trajectory_hardstop(&robot.traj);
-    bd_reset(&robot.distance_bd);
-    bd_reset(&robot.angle_bd);
+    {
+        absl::MutexLock _(&robot.bd_lock);
+        bd_reset(&robot.distance_bd);
+        bd_reset(&robot.angle_bd);
+    }
 
     /* Enable angle control back */
-    robot.mode = BOARD_MODE_ANGLE_DISTANCE;
+    {
+        absl::MutexLock _(&robot.cs_lock);
+        robot.mode = BOARD_MODE_ANGLE_DISTANCE;
+    }
 }
 
 void trajectory_move_to(int32_t x_mm, int32_t y_mm, int32_t a_deg)
@@ -173,11 +211,8 @@ static bool trajectory_is_cartesian(struct trajectory* traj) EXCLUSIVE_LOCKS_REQ
     return false;
 }
 
-bool trajectory_crosses_obstacle(struct _robot* robot, poly_t* opponent, point_t* intersection)
+static point_t trajectory_target_position(struct _robot* robot, point_t current_position)
 {
-    point_t current_position = {
-        position_get_x_float(&robot->pos),
-        position_get_y_float(&robot->pos)};
     point_t target_position;
 
     absl::MutexLock l(&robot->traj.lock_);
@@ -199,6 +234,16 @@ bool trajectory_crosses_obstacle(struct _robot* robot, poly_t* opponent, point_t
         target_position.y = current_position.y + delta_xy.y;
     }
 
+    return target_position;
+}
+
+bool trajectory_crosses_obstacle(struct _robot* robot, poly_t* opponent, point_t* intersection)
+{
+    point_t current_position = {
+        position_get_x_float(&robot->pos),
+        position_get_y_float(&robot->pos)};
+    point_t target_position = trajectory_target_position(robot, current_position);
+
     uint8_t path_crosses_obstacle = is_crossing_poly(current_position, target_position, intersection, opponent);
     bool current_pos_inside_obstacle =
         math_point_is_in_square(opponent, position_get_x_s16(&robot->pos), position_get_y_s16(&robot->pos));
@@ -206,7 +251,6 @@ bool trajectory_crosses_obstacle(struct _robot* robot, poly_t* opponent, point_t
     return path_crosses_obstacle == 1 || current_pos_inside_obstacle;
 }
 
-#if USE_MAP
 bool trajectory_is_on_collision_path(struct _robot* robot, int x, int y)
 {
     point_t points[4];
@@ -221,7 +265,29 @@ bool trajectory_is_on_collision_path(struct _robot* robot, int x, int y)
     point_t intersection;
     return trajectory_crosses_obstacle(robot, &opponent, &intersection);
 }
-#endif
+
+bool trajectory_will_collide_with_opponent(struct _robot* robot, const struct opponent_prediction* opponent)
+{
+    /* Measured speed rather than the speed consign, which the robot has not
+     * reached yet when accelerating or when going slowly */
+    struct robot_pose pose = robot->pose.load();
+    point_t current_position = {pose.x, pose.y};
+    point_t target_position = trajectory_target_position(robot, current_position);
+    float speed = fabsf(pose.distance_speed);
+
+    /* Same clearance as the obstacle used by trajectory_is_on_collision_path */
+    float min_distance = (robot->opponent_size * 1.25 + robot->robot_size) / 2;
+
+    float time_to_collision = opponent_prediction_time_to_collision(opponent,
+                                                                    timestamp_get(),
+                                                                    current_position,
+                                                                    target_position,
+                                                                    speed,
+                                                                    TRAJ_OPPONENT_PREDICTION_HORIZON,
+                                                                    min_distance);
+
+    return time_to_collision >= 0;
+}
 
 void trajectory_set_mode_aligning(
     enum board_mode_t* robot_mode,
@@ -299,6 +365,17 @@ int trajectory_get_time_ms()
     return absl::ToInt64Milliseconds(absl::Now() - *game_start_time);
 }
 
+static absl::Time trajectory_game_end_time()
+{
+    absl::MutexLock _(&game_start_time_lock);
+
+    if (!game_start_time.has_value()) {
+        return absl::InfiniteFuture();
+    }
+
+    return *game_start_time + absl::Seconds(GAME_DURATION);
+}
+
 bool trajectory_game_has_ended()
 {
     return trajectory_get_time() >= GAME_DURATION;
@@ -7,6 +7,7 @@
 #include <aversive/trajectory_manager/trajectory_manager.h>
 #include <aversive/obstacle_avoidance/obstacle_avoidance.h>
 #include "base/base_controller.h"
+#include "opponent_prediction.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -15,10 +16,11 @@ extern "C" {
 /** Duration of a game in seconds. */
 #define GAME_DURATION 100
 
-#define TRAJ_MIN_DISTANCE_TO_OPPONENT 1.1f // minimum distance to opponent to stop, should be in meters, measurement is not linear though
 #define TRAJ_MIN_DIRECTION_TO_OPPONENT 0.5f // defines cone in which to consider opponents (cone is double the angle in size)
 #define TRAJ_MAX_TIME_DELAY_OPPONENT_DETECTION 0.5f // if delay bigger than this, beacon signal is discarded
 #define TRAJ_MAX_TIME_DELAY_ALLY_DETECTION 1.0f // if delay bigger that this, ally position is discarded
+#define TRAJ_OPPONENT_PREDICTION_HORIZON 0.8f // how far in the future the opponent motion is predicted, in seconds
+#define TRAJ_OPPONENT_PREDICTION_SMOOTHING 0.5f // weight of a new beacon measurement in the opponent speed estimate
 
 #define TRAJ_END_GOAL_REACHED (1 << 0)
 #define TRAJ_END_COLLISION (1 << 1)
@@ -35,7 +37,8 @@ extern "C" {
 
 /** Returns when ongoing trajectory is finished for the reasons specified
  *  For example when goal is reached
- * @note This is a blocking function call
+ * @note This is a blocking function call, sleeping until the robot signals
+ *      an event relevant to the watched reasons (see RobotEvents)
  * @warning Will not return if you misspecify the reasons to watch
  *      (ie. the reason watched never occurs)
  *
@@ -69,6 +72,12 @@ bool trajectory_crosses_obstacle(struct _robot* robot, poly_t* opponent, point_t
  */
 bool trajectory_is_on_collision_path(struct _robot* robot, int x, int y);
 
+/** Check if the current trajectory segment, at the current speed, will get
+ * too close to where the opponent is predicted to be in the next
+ * TRAJ_OPPONENT_PREDICTION_HORIZON seconds
+ */
+bool trajectory_will_collide_with_opponent(struct _robot* robot, const struct opponent_prediction* opponent);
+
 /** Prepare robot for aligning by settings its dynamics accordingly
  * ie. slower and less sensitive to collisions
  */
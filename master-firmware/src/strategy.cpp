@@ -1,6 +1,3 @@
-// TODO: Enable this once map is ported
-#define USE_MAP 0
-
 #include <array>
 #include <thread>
 
@@ -17,10 +14,8 @@
 #include "robot_helpers/motor_helpers.h"
 #include "base/base_controller.h"
 
-#if USE_MAP
 #include "base/map.h"
 #include "base/map_server.h"
-#endif
 
 #include "config.h"
 #include "control_panel.h"
@@ -209,9 +204,7 @@ void strategy_play_game()
 
     NOTICE("Waiting for color selection...");
     //auto color = wait_for_color_selection();
-#if USE_MAP
-    map_server_start(color);
-#endif
+    map_server_start(YELLOW);
 
     strategy_order_play_game(state, YELLOW);
 }
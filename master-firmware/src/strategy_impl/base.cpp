@@ -39,34 +39,24 @@ void strategy_hardstop_robot(strategy_context_t* strat)
 
 bool strategy_goto_avoid(strategy_context_t* strat, int x_mm, int y_mm, int a_deg, int traj_end_flags)
 {
-    auto map = map_server_map_lock_and_get();
-
     // Dangerous mode: removes opponent
-    if (traj_end_flags == TRAJ_FLAGS_ALL_IGNORE_OPPONENT) {
+    const bool ignore_opponents = traj_end_flags == TRAJ_FLAGS_ALL_IGNORE_OPPONENT;
+    if (ignore_opponents) {
         WARNING("Ignoring opponent, lalala");
-        map_server_enable_opponent(map, false);
     }
 
     /* Compute path */
     const point_t start = {
         position_get_x_float(&strat->robot->pos),
         position_get_y_float(&strat->robot->pos)};
-    oa_start_end_points(&map->oa, start.x, start.y, x_mm, y_mm);
-    oa_process(&map->oa);
-
-    // Disable the dangerous mode that removes opponent
-    if (traj_end_flags == TRAJ_FLAGS_ALL_IGNORE_OPPONENT) {
-        map_server_enable_opponent(map, true);
-    }
+    const point_t end = {(float)x_mm, (float)y_mm};
+    point_t points[MAX_CHKPOINTS];
+    int num_points = map_server_plan_path(start, end, ignore_opponents, points, MAX_CHKPOINTS);
 
-    /* Retrieve path */
-    point_t* points;
-    int num_points = oa_get_path(&map->oa, &points);
     DEBUG("Path to (%d, %d) computed with %d points", x_mm, y_mm, num_points);
     if (num_points <= 0) {
         WARNING("No path found!");
         strategy_stop_robot(strat);
-        map_server_map_release(map);
         return false;
     }
 
@@ -95,7 +85,6 @@ bool strategy_goto_avoid(strategy_context_t* strat, int x_mm, int y_mm, int a_de
         trajectory_wait_for_end(TRAJ_END_GOAL_REACHED);
 
         DEBUG("Goal reached successfully");
-        map_server_map_release(map);
 
         return true;
     } else if (end_reason == TRAJ_END_OPPONENT_NEAR) {
@@ -118,7 +107,6 @@ bool strategy_goto_avoid(strategy_context_t* strat, int x_mm, int y_mm, int a_de
         WARNING("Trajectory ended with reason %d", end_reason);
     }
 
-    map_server_map_release(map);
     return false;
 }
 
@@ -0,0 +1,112 @@
+#include <CppUTest/TestHarness.h>
+#include "debug/control_latency.hpp"
+
+TEST_GROUP (ControlLatencyBins) {
+};
+
+TEST(ControlLatencyBins, fastestBinIsBelowAHundredMicroseconds)
+{
+    CHECK_EQUAL(0, control_latency_bin(0));
+    CHECK_EQUAL(0, control_latency_bin(99));
+}
+
+TEST(ControlLatencyBins, boundsBelongToTheNextBin)
+{
+    CHECK_EQUAL(1, control_latency_bin(100));
+    CHECK_EQUAL(6, control_latency_bin(9999));
+    CHECK_EQUAL(7, control_latency_bin(10000));
+}
+
+TEST(ControlLatencyBins, lastBinCountsAnythingSlower)
+{
+    CHECK_EQUAL(CONTROL_LATENCY_BINS - 1, control_latency_bin(100000));
+    CHECK_EQUAL(CONTROL_LATENCY_BINS - 1, control_latency_bin(10000000));
+}
+
+TEST_GROUP (AControlLatencyTrace) {
+    ControlLatencyTrace trace;
+
+    void sample(int64_t rx, int64_t published)
+    {
+        trace.encoders_received(rx);
+        trace.encoders_published(published);
+    }
+};
+
+TEST(AControlLatencyTrace, measuresEachStageOfASample)
+{
+    sample(1000, 1050);
+    trace.control_updated(1300);
+    trace.setpoint_sent(5300);
+
+    ControlLatencyStats stats = trace.stats();
+    CHECK_EQUAL(50, stats.publish.max_us);
+    CHECK_EQUAL(250, stats.control.max_us);
+    CHECK_EQUAL(4000, stats.transmit.max_us);
+    CHECK_EQUAL(4300, stats.total.max_us);
+}
+
+TEST(AControlLatencyTrace, countsControlOnlyOncePerSample)
+{
+    sample(1000, 1050);
+    trace.control_updated(1300);
+    trace.control_updated(11300);
+
+    CHECK_EQUAL(1, trace.stats().control.count);
+}
+
+TEST(AControlLatencyTrace, ignoresControlBeforeFirstSample)
+{
+    trace.control_updated(1300);
+    trace.setpoint_sent(1400);
+
+    CHECK_EQUAL(0, trace.stats().control.count);
+    CHECK_EQUAL(0, trace.stats().total.count);
+}
+
+TEST(AControlLatencyTrace, countsControlDoneWhilePublishingAsImmediate)
+{
+    trace.encoders_received(1000);
+    trace.control_updated(1040);
+    trace.encoders_published(1050);
+    trace.setpoint_sent(5040);
+
+    ControlLatencyStats stats = trace.stats();
+    CHECK_EQUAL(1, stats.control.count);
+    CHECK_EQUAL(0, stats.control.max_us);
+    CHECK_EQUAL(4040, stats.total.max_us);
+}
+
+TEST(AControlLatencyTrace, ignoresSetpointsResentWithoutNewControl)
+{
+    sample(1000, 1050);
+    trace.control_updated(1300);
+    trace.setpoint_sent(5300);
+    trace.setpoint_sent(55300);
+
+    CHECK_EQUAL(1, trace.stats().transmit.count);
+}
+
+TEST(AControlLatencyTrace, totalStartsAtTheSampleUsedByControl)
+{
+    sample(1000, 1050);
+    trace.control_updated(1300);
+
+    /* A newer sample arrives before the setpoint is sent */
+    sample(3000, 3050);
+    trace.setpoint_sent(5300);
+
+    CHECK_EQUAL(4300, trace.stats().total.max_us);
+}
+
+TEST(AControlLatencyTrace, accumulatesMeanAndHistogram)
+{
+    sample(0, 50);
+    sample(1000, 1150);
+
+    ControlLatencyStats stats = trace.stats();
+    CHECK_EQUAL(2, stats.publish.count);
+    CHECK_EQUAL(200, stats.publish.sum_us);
+    CHECK_EQUAL(1, stats.publish.bins[0]);
+    CHECK_EQUAL(1, stats.publish.bins[1]);
+}
@@ -1,5 +1,4 @@
 #include <CppUTest/TestHarness.h>
-#include <CppUTestExt/MockSupport.h>
 
 extern "C" {
 #include <aversive/obstacle_avoidance/obstacle_avoidance.h>
@@ -97,7 +96,12 @@ TEST_GROUP (MapOpponentObstacleSetter) {
 
     void setup(void)
     {
-        map_init(&map, arbitrary_robot_size, true);
+        CHECK_EQUAL(0, map_init(&map, arbitrary_robot_size, true));
+    }
+
+    void teardown(void)
+    {
+        map_deinit(&map);
     }
 };
 
@@ -121,7 +125,12 @@ TEST_GROUP (MapOpponentObstacleUpdater) {
 
     void setup(void)
     {
-        map_init(&map, arbitrary_robot_size, true);
+        CHECK_EQUAL(0, map_init(&map, arbitrary_robot_size, true));
+    }
+
+    void teardown(void)
+    {
+        map_deinit(&map);
     }
 };
 
@@ -170,7 +179,12 @@ TEST_GROUP (MapEurobot2019) {
 
     void setup(void)
     {
-        map_init(&map, arbitrary_robot_size, true);
+        CHECK_EQUAL(0, map_init(&map, arbitrary_robot_size, true));
+    }
+
+    void teardown(void)
+    {
+        map_deinit(&map);
     }
 };
 
@@ -246,33 +260,134 @@ TEST(MapEurobot2019, goesToThePuckInFrontOfTheRamp)
     }
 };
 
-TEST_GROUP (AMap) {
+TEST_GROUP (MapGridPlanner) {
     struct _map map;
+    const int arbitrary_robot_size = 260;
+    const point_t start = {.x = 250, .y = 450};
+
+    void setup(void)
+    {
+        struct grid_planner_params params;
+        params.resolution_mm = 20;
+        params.safety_margin_mm = 20;
+        params.clearance_mm = 150;
+        params.clearance_weight = 2;
+        params.max_checkpoints = MAX_CHKPOINTS;
+
+        CHECK_EQUAL(0, map_init(&map, arbitrary_robot_size, true));
+        CHECK_EQUAL(0, map_init_grid_planner(&map, &params));
+        map_set_planner(&map, MAP_PLANNER_GRID);
+    }
+
+    void teardown(void)
+    {
+        map_deinit(&map);
+    }
+
+    std::vector<point_t> plan(point_t from, point_t to)
+    {
+        point_t* points;
+        int point_cnt = map_plan_path(&map, from, to, &points);
+
+        std::vector<point_t> path;
+        path.assign(points, points + (point_cnt > 0 ? point_cnt : 0));
+        return path;
+    }
+};
+
+TEST(MapGridPlanner, goesToThePuckInFrontOfTheRamp)
+{
+    point_t end = {.x = 950, .y = 1383};
+
+    CHECK_PATH_REACHES_GOAL(plan(start, end), end);
+};
+
+TEST(MapGridPlanner, doesNotGoOnTheRamp)
+{
+    point_t end = {.x = 834, .y = 1800};
+
+    CHECK_EQUAL(0, plan(start, end).size());
+};
+
+TEST(MapGridPlanner, goesAroundTheOpponent)
+{
+    point_t end = {.x = 1500, .y = 450};
+
+    map_set_opponent_obstacle(&map, 0, 900, 450, 400, arbitrary_robot_size);
+    auto path = plan(start, end);
+
+    CHECK_PATH_REACHES_GOAL(path, end);
+    CHECK_TRUE(path.size() > 1);
+};
+
+TEST_GROUP (AMapCopy) {
+    struct _map map, copy;
+    const int arbitrary_robot_size = 260;
+    const point_t start = {.x = 250, .y = 450};
+    const point_t end = {.x = 1500, .y = 450};
 
     void setup()
     {
-        map_init(&map, 0, true);
-        lock_mocks_enable(true);
+        CHECK_EQUAL(0, map_init(&map, arbitrary_robot_size, true));
+        CHECK_EQUAL(0, map_init(&copy, 0, false));
     }
 
     void teardown()
     {
-        lock_mocks_enable(false);
+        map_deinit(&map);
+        map_deinit(&copy);
+    }
+
+    std::vector<point_t> plan(struct _map* m)
+    {
+        point_t* points;
+        int point_cnt = map_plan_path(m, start, end, &points);
+
+        std::vector<point_t> path;
+        path.assign(points, points + (point_cnt > 0 ? point_cnt : 0));
+        return path;
     }
 };
 
-TEST(AMap, canSetOpponentObstacleAtomically)
+TEST(AMapCopy, plansLikeTheOriginal)
 {
-    mock().expectOneCall("chMtxLock").withPointerParameter("lock", &map.lock);
-    mock().expectOneCall("chMtxUnlock").withPointerParameter("lock", &map.lock);
+    map_set_opponent_obstacle(&map, 0, 900, 450, 400, arbitrary_robot_size);
+
+    CHECK_EQUAL(0, map_copy(&copy, &map));
 
-    map_set_opponent_obstacle(&map, 0, 0, 0, 0, 0);
+    auto path = plan(&map);
+    auto copied_path = plan(&copy);
+    CHECK_EQUAL(path.size(), copied_path.size());
+    for (size_t i = 0; i < path.size(); i++) {
+        POINT_EQUAL(path[i], copied_path[i]);
+    }
 }
 
-TEST(AMap, canUpdateOpponentObstacleAtomically)
+TEST(AMapCopy, isIndependentFromTheOriginal)
 {
-    mock().expectOneCall("chMtxLock").withPointerParameter("lock", &map.lock);
-    mock().expectOneCall("chMtxUnlock").withPointerParameter("lock", &map.lock);
+    CHECK_EQUAL(0, map_copy(&copy, &map));
+    map_set_opponent_obstacle(&copy, 0, 900, 450, 400, arbitrary_robot_size);
 
-    map_update_opponent_obstacle(&map, 0, 0, 0, 0);
+    CHECK_EQUAL(1, plan(&map).size());
+    CHECK_TRUE(plan(&copy).size() > 1);
+}
+
+TEST(AMapCopy, copiesTheGridPlanner)
+{
+    struct grid_planner_params params;
+    params.resolution_mm = 20;
+    params.safety_margin_mm = 20;
+    params.clearance_mm = 150;
+    params.clearance_weight = 2;
+    params.max_checkpoints = MAX_CHKPOINTS;
+
+    map_init_grid_planner(&map, &params);
+    map_set_planner(&map, MAP_PLANNER_GRID);
+    map_set_opponent_obstacle(&map, 0, 900, 450, 400, arbitrary_robot_size);
+
+    CHECK_EQUAL(0, map_copy(&copy, &map));
+
+    CHECK_TRUE(copy.has_grid);
+    CHECK_EQUAL(MAP_PLANNER_GRID, copy.planner);
+    CHECK_EQUAL(plan(&map).size(), plan(&copy).size());
 }
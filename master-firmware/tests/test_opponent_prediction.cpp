@@ -0,0 +1,186 @@
+#include <CppUTest/TestHarness.h>
+#include <math.h>
+
+#include "robot_helpers/opponent_prediction.h"
+
+/* Measurements are 100ms apart, like the beacon */
+static timestamp_t at(int i)
+{
+    return 1000000 + i * 100000;
+}
+
+TEST_GROUP (AnOpponentPrediction) {
+    struct opponent_prediction opponent;
+
+    void setup()
+    {
+        opponent_prediction_init(&opponent, 1.);
+    }
+
+    void feed_straight_line(point_t start, float vx, float vy, int count)
+    {
+        for (int i = 0; i < count; i++) {
+            point_t p = {start.x + vx * i * 0.1f, start.y + vy * i * 0.1f};
+            opponent_prediction_update(&opponent, p, at(i));
+        }
+    }
+};
+
+TEST(AnOpponentPrediction, StaysAtLastPositionWhenStatic)
+{
+    feed_straight_line({1000, 1000}, 0, 0, 5);
+
+    point_t p = opponent_prediction_position(&opponent, 1.);
+
+    DOUBLES_EQUAL(1000, p.x, 1e-3);
+    DOUBLES_EQUAL(1000, p.y, 1e-3);
+}
+
+TEST(AnOpponentPrediction, ExtrapolatesConstantVelocity)
+{
+    feed_straight_line({1000, 1000}, 500, 0, 5);
+
+    point_t p = opponent_prediction_position(&opponent, 0.5);
+
+    DOUBLES_EQUAL(500, opponent.speed, 1e-1);
+    DOUBLES_EQUAL(0, opponent.heading, 1e-3);
+    DOUBLES_EQUAL(1200 + 250, p.x, 1.);
+    DOUBLES_EQUAL(1000, p.y, 1.);
+}
+
+TEST(AnOpponentPrediction, FollowsArcWithTurnRate)
+{
+    /* Opponent on a circle of 500 mm radius at 1 rad/s */
+    const float radius = 500, rate = 1;
+    for (int i = 0; i < 10; i++) {
+        float angle = rate * i * 0.1f;
+        point_t p = {1500 + radius * sinf(angle), 1000 - radius * cosf(angle)};
+        opponent_prediction_update(&opponent, p, at(i));
+    }
+
+    DOUBLES_EQUAL(rate, opponent.turn_rate, 1e-2);
+
+    /* The heading comes from the last two measurements, so it lags by half a
+     * sample */
+    float angle = rate * (0.9 + 0.5);
+    point_t p = opponent_prediction_position(&opponent, 0.5);
+
+    DOUBLES_EQUAL(1500 + radius * sinf(angle), p.x, 20.);
+    DOUBLES_EQUAL(1000 - radius * cosf(angle), p.y, 20.);
+}
+
+TEST(AnOpponentPrediction, RestartsOnOutlier)
+{
+    feed_straight_line({1000, 1000}, 500, 0, 5);
+
+    opponent_prediction_update(&opponent, {2500, 200}, at(5));
+
+    CHECK_EQUAL(1, opponent.num_measurements);
+    DOUBLES_EQUAL(0, opponent.speed, 1e-3);
+    DOUBLES_EQUAL(2500, opponent.position.x, 1e-3);
+}
+
+TEST(AnOpponentPrediction, RestartsAfterTimeout)
+{
+    feed_straight_line({1000, 1000}, 500, 0, 5);
+
+    opponent_prediction_update(&opponent, {1300, 1000}, at(20));
+
+    CHECK_EQUAL(1, opponent.num_measurements);
+    DOUBLES_EQUAL(0, opponent.speed, 1e-3);
+}
+
+TEST(AnOpponentPrediction, IgnoresRepeatedMeasurement)
+{
+    feed_straight_line({1000, 1000}, 500, 0, 5);
+
+    opponent_prediction_update(&opponent, {1200, 1000}, at(4));
+
+    CHECK_EQUAL(5, opponent.num_measurements);
+    DOUBLES_EQUAL(500, opponent.speed, 1e-1);
+}
+
+TEST(AnOpponentPrediction, SweptObstacleCoversFuturePositions)
+{
+    feed_straight_line({1000, 1000}, 0, 500, 5);
+
+    poly_t obstacle;
+    point_t pts[OPPONENT_PREDICTION_SWEPT_EDGES];
+    obstacle.pts = pts;
+    obstacle.l = OPPONENT_PREDICTION_SWEPT_EDGES;
+    opponent_prediction_swept_obstacle(&opponent, 1., 200, 200, &obstacle);
+
+    for (int i = 0; i <= 10; i++) {
+        point_t p = opponent_prediction_position(&opponent, i * 0.1f);
+        CHECK_TRUE(is_in_poly(&p, &obstacle) > 0);
+    }
+
+    point_t behind = {1000, 1000};
+    point_t ahead = {1000, 1200 + 500 + 250};
+    point_t beside = {1250, 1400};
+    CHECK_TRUE(is_in_poly(&behind, &obstacle) > 0);
+    CHECK_TRUE(is_in_poly(&ahead, &obstacle) == 0);
+    CHECK_TRUE(is_in_poly(&beside, &obstacle) == 0);
+}
+
+TEST(AnOpponentPrediction, SweptObstacleIsSquareWhenStatic)
+{
+    feed_straight_line({1000, 1000}, 0, 0, 5);
+
+    poly_t obstacle;
+    point_t pts[OPPONENT_PREDICTION_SWEPT_EDGES];
+    obstacle.pts = pts;
+    obstacle.l = OPPONENT_PREDICTION_SWEPT_EDGES;
+    opponent_prediction_swept_obstacle(&opponent, 1., 200, 200, &obstacle);
+
+    for (int i = 0; i < OPPONENT_PREDICTION_SWEPT_EDGES; i++) {
+        DOUBLES_EQUAL(200, fabsf(pts[i].x - 1000), 1e-3);
+        DOUBLES_EQUAL(200, fabsf(pts[i].y - 1000), 1e-3);
+    }
+}
+
+TEST(AnOpponentPrediction, NoCollisionWhenPathsCrossAtDifferentTimes)
+{
+    /* The opponent crosses our path at (1500, 1000) in 0.2s, we only get
+     * there in 1s */
+    feed_straight_line({1500, 200}, 0, 1000, 7);
+
+    float t = opponent_prediction_time_to_collision(&opponent, at(6),
+                                                    {1000, 1000}, {2000, 1000},
+                                                    500, 2., 150);
+
+    CHECK_TRUE(t < 0);
+}
+
+TEST(AnOpponentPrediction, CollisionWhenTimingMatches)
+{
+    /* The opponent crosses our path at (1500, 1000) in 1s, like us */
+    feed_straight_line({1500, 200}, 0, 500, 7);
+
+    float t = opponent_prediction_time_to_collision(&opponent, at(6),
+                                                    {1000, 1000}, {2000, 1000},
+                                                    500, 2., 150);
+
+    CHECK_TRUE(t >= 0);
+    DOUBLES_EQUAL(1., t, 0.3);
+}
+
+TEST(AnOpponentPrediction, NoCollisionWithStaleMeasurement)
+{
+    feed_straight_line({1500, 1000}, 0, 0, 5);
+
+    float t = opponent_prediction_time_to_collision(&opponent, at(20),
+                                                    {1000, 1000}, {2000, 1000},
+                                                    500, 2., 150);
+
+    CHECK_TRUE(t < 0);
+}
+
+TEST(AnOpponentPrediction, NoCollisionWhenNeverSeen)
+{
+    float t = opponent_prediction_time_to_collision(&opponent, at(0),
+                                                    {1000, 1000}, {2000, 1000},
+                                                    500, 2., 150);
+
+    CHECK_TRUE(t < 0);
+}
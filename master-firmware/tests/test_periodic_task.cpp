@@ -0,0 +1,87 @@
+#include <CppUTest/TestHarness.h>
+#include "base/periodic_task.hpp"
+
+TEST_GROUP (PeriodicTaskDeadline) {
+    uint64_t missed = 0;
+};
+
+TEST(PeriodicTaskDeadline, advancesByOnePeriod)
+{
+    CHECK_EQUAL(1100, periodic_task_next_deadline(1000, 1050, 100, &missed));
+    CHECK_EQUAL(0, missed);
+}
+
+TEST(PeriodicTaskDeadline, doesNotDriftWithExecutionTime)
+{
+    int64_t deadline = 1000;
+    deadline = periodic_task_next_deadline(deadline, 1090, 100, &missed);
+    deadline = periodic_task_next_deadline(deadline, 1190, 100, &missed);
+
+    CHECK_EQUAL(1200, deadline);
+    CHECK_EQUAL(0, missed);
+}
+
+TEST(PeriodicTaskDeadline, skipsMissedPeriods)
+{
+    /* Iteration of 1000 ran until 1250: 1100 and 1200 are gone */
+    CHECK_EQUAL(1300, periodic_task_next_deadline(1000, 1250, 100, &missed));
+    CHECK_EQUAL(2, missed);
+}
+
+TEST(PeriodicTaskDeadline, skipsDeadlineReachedExactly)
+{
+    CHECK_EQUAL(1200, periodic_task_next_deadline(1000, 1100, 100, &missed));
+    CHECK_EQUAL(1, missed);
+}
+
+TEST_GROUP (PeriodicTaskStats) {
+    PeriodicTaskStats stats;
+};
+
+TEST(PeriodicTaskStats, startsEmpty)
+{
+    CHECK_EQUAL(0, stats.iterations);
+    CHECK_EQUAL(0, stats.overruns);
+    for (int i = 0; i < PERIODIC_TASK_HISTOGRAM_BINS; i++) {
+        CHECK_EQUAL(0, stats.execution_histogram[i]);
+    }
+}
+
+TEST(PeriodicTaskStats, tracksWorstLatenessAndExecution)
+{
+    stats.record(10, 200, 1000);
+    stats.record(30, 100, 1000);
+    stats.record(20, 300, 1000);
+
+    CHECK_EQUAL(3, stats.iterations);
+    CHECK_EQUAL(30, stats.max_lateness);
+    CHECK_EQUAL(300, stats.max_execution);
+}
+
+TEST(PeriodicTaskStats, binsExecutionTimeByFractionOfPeriod)
+{
+    stats.record(0, 50, 1000);
+    stats.record(0, 150, 1000);
+    stats.record(0, 199, 1000);
+
+    CHECK_EQUAL(1, stats.execution_histogram[0]);
+    CHECK_EQUAL(2, stats.execution_histogram[1]);
+}
+
+TEST(PeriodicTaskStats, countsOverrunsInLastBin)
+{
+    stats.record(0, 5000, 1000);
+
+    CHECK_EQUAL(1, stats.overruns);
+    CHECK_EQUAL(1, stats.execution_histogram[PERIODIC_TASK_HISTOGRAM_BINS - 1]);
+}
+
+TEST(PeriodicTaskStats, countsLateWakeUpAsOverrun)
+{
+    /* Short execution, but started so late that it ended after the next
+     * deadline */
+    stats.record(900, 200, 1000);
+
+    CHECK_EQUAL(1, stats.overruns);
+    CHECK_EQUAL(1, stats.execution_histogram[2]);
+}
@@ -0,0 +1,54 @@
+#include <CppUTest/TestHarness.h>
+#include <thread>
+#include <absl/time/clock.h>
+#include "base/robot_events.hpp"
+
+TEST_GROUP (ARobotEvents) {
+    RobotEvents events;
+};
+
+TEST(ARobotEvents, returnsAtOnceIfSignaledSinceMark)
+{
+    RobotEvents::Mark mark = events.mark();
+    events.signal(ROBOT_EVENT_BLOCKING);
+
+    CHECK_TRUE(events.wait(mark, ROBOT_EVENT_BLOCKING, absl::InfiniteFuture()));
+}
+
+TEST(ARobotEvents, ignoresEventsSignaledBeforeMark)
+{
+    events.signal(ROBOT_EVENT_BLOCKING);
+    RobotEvents::Mark mark = events.mark();
+
+    CHECK_FALSE(events.wait(mark, ROBOT_EVENT_BLOCKING, absl::Now()));
+}
+
+TEST(ARobotEvents, ignoresEventsNotWaitedFor)
+{
+    RobotEvents::Mark mark = events.mark();
+    events.signal(ROBOT_EVENT_POSE);
+
+    CHECK_FALSE(events.wait(mark, ROBOT_EVENT_TRAJECTORY | ROBOT_EVENT_BLOCKING, absl::Now()));
+}
+
+TEST(ARobotEvents, timesOutAtDeadline)
+{
+    RobotEvents::Mark mark = events.mark();
+    absl::Time start = absl::Now();
+
+    CHECK_FALSE(events.wait(mark, ROBOT_EVENT_TRAJECTORY, start + absl::Milliseconds(20)));
+    CHECK_TRUE(absl::Now() - start >= absl::Milliseconds(20));
+}
+
+TEST(ARobotEvents, wakesUpWhenSignaledByAnotherThread)
+{
+    RobotEvents::Mark mark = events.mark();
+
+    std::thread signaler([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        events.signal(ROBOT_EVENT_OBSTACLE | ROBOT_EVENT_POSE);
+    });
+
+    CHECK_TRUE(events.wait(mark, ROBOT_EVENT_OBSTACLE, absl::Now() + absl::Seconds(10)));
+    signaler.join();
+}
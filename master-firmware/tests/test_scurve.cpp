@@ -0,0 +1,125 @@
+#include <CppUTest/TestHarness.h>
+#include <math.h>
+#include "math/scurve.h"
+
+TEST_GROUP (AnSCurve) {
+    scurve_t s;
+    const float max_vel = 0.5, max_acc = 1, max_jerk = 10;
+
+    /* Walks the whole motion, checking it never exceeds the limits */
+    void check_limits()
+    {
+        const float dt = 1e-3;
+        scurve_point_t prev = scurve_sample(&s, 0);
+
+        for (float t = dt; t < scurve_duration(&s) + 0.1; t += dt) {
+            scurve_point_t p = scurve_sample(&s, t);
+
+            CHECK_TRUE(fabsf(p.velocity) <= max_vel * 1.001);
+            CHECK_TRUE(fabsf(p.acceleration) <= max_acc * 1.001);
+            CHECK_TRUE(fabsf(p.acceleration - prev.acceleration) / dt <= max_jerk * 1.01);
+
+            /* Continuous, even across segments */
+            DOUBLES_EQUAL(prev.position, p.position, max_vel * dt * 1.01);
+
+            prev = p;
+        }
+    }
+};
+
+TEST(AnSCurve, startsAndEndsAtRest)
+{
+    scurve_plan(&s, 0.2, 1.2, max_vel, max_acc, max_jerk);
+
+    scurve_point_t start = scurve_sample(&s, 0);
+    scurve_point_t end = scurve_sample(&s, scurve_duration(&s));
+
+    DOUBLES_EQUAL(0.2, start.position, 1e-6);
+    DOUBLES_EQUAL(0, start.velocity, 1e-6);
+    DOUBLES_EQUAL(1.2, end.position, 1e-6);
+    DOUBLES_EQUAL(0, end.velocity, 1e-6);
+    DOUBLES_EQUAL(0, end.acceleration, 1e-6);
+}
+
+TEST(AnSCurve, longMotionCruisesAtMaxVelocity)
+{
+    scurve_plan(&s, 0, 1, max_vel, max_acc, max_jerk);
+
+    /* distance / max_vel + max_vel / max_acc + max_acc / max_jerk */
+    DOUBLES_EQUAL(2.6, scurve_duration(&s), 1e-4);
+    DOUBLES_EQUAL(max_vel, scurve_sample(&s, 1.3).velocity, 1e-5);
+    check_limits();
+}
+
+TEST(AnSCurve, arrivesSmoothlyAtTheEnd)
+{
+    scurve_plan(&s, 0, 1, max_vel, max_acc, max_jerk);
+
+    scurve_point_t p = scurve_sample(&s, scurve_duration(&s) - 1e-3);
+
+    DOUBLES_EQUAL(1, p.position, 1e-4);
+    DOUBLES_EQUAL(0, p.velocity, 1e-3);
+}
+
+TEST(AnSCurve, shortMotionDoesNotReachMaxVelocity)
+{
+    scurve_plan(&s, 0, 0.1, max_vel, max_acc, max_jerk);
+
+    scurve_point_t middle = scurve_sample(&s, scurve_duration(&s) / 2);
+
+    CHECK_TRUE(middle.velocity < max_vel);
+    DOUBLES_EQUAL(0.05, middle.position, 1e-4);
+    DOUBLES_EQUAL(0.1, scurve_sample(&s, scurve_duration(&s)).position, 1e-6);
+    check_limits();
+}
+
+TEST(AnSCurve, veryShortMotionDoesNotReachMaxAcceleration)
+{
+    scurve_plan(&s, 0, 0.01, max_vel, max_acc, max_jerk);
+
+    float max_reached = 0;
+    for (float t = 0; t < scurve_duration(&s); t += 1e-3) {
+        max_reached = fmaxf(max_reached, scurve_sample(&s, t).acceleration);
+    }
+
+    CHECK_TRUE(max_reached < max_acc);
+    check_limits();
+}
+
+TEST(AnSCurve, canMoveBackward)
+{
+    scurve_plan(&s, 1, 0, max_vel, max_acc, max_jerk);
+
+    CHECK_TRUE(scurve_sample(&s, 1).velocity < 0);
+    DOUBLES_EQUAL(0, scurve_sample(&s, scurve_duration(&s)).position, 1e-6);
+    check_limits();
+}
+
+TEST(AnSCurve, zeroDistanceTakesNoTime)
+{
+    scurve_plan(&s, 3, 3, max_vel, max_acc, max_jerk);
+
+    DOUBLES_EQUAL(0, scurve_duration(&s), 1e-9);
+    DOUBLES_EQUAL(3, scurve_sample(&s, 1).position, 1e-9);
+}
+
+TEST(AnSCurve, samplesChunksUntilTheEnd)
+{
+    scurve_point_t points[100];
+    scurve_plan(&s, 0, 1, max_vel, max_acc, max_jerk);
+
+    /* 2.6 s long, sampled every 50 ms from 2 s on */
+    int n = scurve_sample_chunk(&s, 2, 0.05, points, 100);
+
+    CHECK_EQUAL(13, n);
+    DOUBLES_EQUAL(scurve_sample(&s, 2.05).position, points[1].position, 1e-6);
+    DOUBLES_EQUAL(1, points[n - 1].position, 1e-6);
+}
+
+TEST(AnSCurve, chunkStopsAtMaxPoints)
+{
+    scurve_point_t points[5];
+    scurve_plan(&s, 0, 1, max_vel, max_acc, max_jerk);
+
+    CHECK_EQUAL(5, scurve_sample_chunk(&s, 0, 0.05, points, 5));
+}
@@ -0,0 +1,67 @@
+#include <CppUTest/TestHarness.h>
+#include <atomic>
+#include <thread>
+#include "base/seqlock.hpp"
+
+namespace {
+struct Pose {
+    float x, y, a;
+    uint32_t timestamp;
+};
+} // namespace
+
+TEST_GROUP (ASeqLock) {
+    SeqLock<Pose> lock;
+};
+
+TEST(ASeqLock, readsZeroBeforeFirstStore)
+{
+    Pose p = lock.load();
+
+    CHECK_EQUAL(0, p.x);
+    CHECK_EQUAL(0, p.timestamp);
+}
+
+TEST(ASeqLock, readsLastStoredValue)
+{
+    lock.store({1, 2, 3, 4});
+    lock.store({5, 6, 7, 8});
+
+    Pose p = lock.load();
+
+    CHECK_EQUAL(5, p.x);
+    CHECK_EQUAL(6, p.y);
+    CHECK_EQUAL(7, p.a);
+    CHECK_EQUAL(8, p.timestamp);
+}
+
+TEST(ASeqLock, supportsValuesNotMultipleOfAWord)
+{
+    SeqLock<char> c;
+    c.store('a');
+
+    CHECK_EQUAL('a', c.load());
+}
+
+TEST(ASeqLock, neverReadsTornValue)
+{
+    std::atomic<bool> done{false};
+    std::atomic<int> inconsistencies{0};
+
+    std::thread reader([&]() {
+        while (!done) {
+            Pose p = lock.load();
+            if (p.x != p.y || p.y != p.a || p.a != p.timestamp) {
+                inconsistencies++;
+            }
+        }
+    });
+
+    for (uint32_t i = 0; i < 100000; i++) {
+        lock.store({(float)i, (float)i, (float)i, i});
+    }
+    done = true;
+    reader.join();
+
+    CHECK_EQUAL(0, inconsistencies.load());
+}
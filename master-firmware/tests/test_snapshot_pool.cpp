@@ -0,0 +1,113 @@
+#include <CppUTest/TestHarness.h>
+#include <atomic>
+#include <thread>
+#include "base/snapshot_pool.hpp"
+
+TEST_GROUP (ASnapshotPool) {
+    SnapshotPool<int, 3> pool;
+};
+
+TEST(ASnapshotPool, hasNothingToReadBeforeFirstPublication)
+{
+    POINTERS_EQUAL(nullptr, pool.acquire());
+}
+
+TEST(ASnapshotPool, readsLatestPublishedSnapshot)
+{
+    int* snapshot = pool.writable();
+    *snapshot = 42;
+    pool.publish(snapshot);
+
+    const int* read = pool.acquire();
+    CHECK_EQUAL(42, *read);
+    pool.release(read);
+
+    snapshot = pool.writable();
+    *snapshot = 43;
+    pool.publish(snapshot);
+
+    read = pool.acquire();
+    CHECK_EQUAL(43, *read);
+    pool.release(read);
+}
+
+TEST(ASnapshotPool, neverWritesIntoThePublishedSnapshot)
+{
+    int* published = pool.writable();
+    pool.publish(published);
+
+    for (int i = 0; i < 10; i++) {
+        CHECK_TRUE(pool.writable() != published);
+    }
+}
+
+TEST(ASnapshotPool, neverWritesIntoASnapshotBeingRead)
+{
+    int* old = pool.writable();
+    pool.publish(old);
+    const int* read = pool.acquire();
+
+    int* next = pool.writable();
+    pool.publish(next);
+
+    CHECK_TRUE(pool.writable() != old);
+    CHECK_TRUE(pool.writable() != next);
+
+    pool.release(read);
+    CHECK_TRUE(pool.writable() == old);
+}
+
+TEST(ASnapshotPool, runsOutOfSnapshotsWhenAllAreRead)
+{
+    const int* reads[2];
+
+    for (int i = 0; i < 2; i++) {
+        pool.publish(pool.writable());
+        reads[i] = pool.acquire();
+    }
+    pool.publish(pool.writable());
+
+    POINTERS_EQUAL(nullptr, pool.writable());
+
+    pool.release(reads[0]);
+    CHECK_TRUE(pool.writable() != nullptr);
+    pool.release(reads[1]);
+}
+
+TEST(ASnapshotPool, readersAlwaysSeeConsistentSnapshots)
+{
+    struct Pair {
+        int a, b;
+    };
+    SnapshotPool<Pair, 3> pairs;
+    std::atomic<bool> done{false};
+    std::atomic<int> inconsistencies{0};
+
+    Pair* first = pairs.writable();
+    *first = {0, 0};
+    pairs.publish(first);
+
+    std::thread reader([&]() {
+        while (!done) {
+            const Pair* p = pairs.acquire();
+            if (p->a != p->b) {
+                inconsistencies++;
+            }
+            pairs.release(p);
+        }
+    });
+
+    for (int i = 1; i < 100000; i++) {
+        Pair* p;
+        while ((p = pairs.writable()) == nullptr) {
+        }
+        p->a = i;
+        p->b = i;
+        pairs.publish(p);
+    }
+
+    done = true;
+    reader.join();
+
+    CHECK_EQUAL(0, inconsistencies.load());
+}
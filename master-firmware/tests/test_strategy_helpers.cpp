@@ -1,6 +1,7 @@
 #include <CppUTest/TestHarness.h>
 #include <array>
 #include <math.h>
+#include <string.h>
 
 extern "C" {
 #include <aversive/obstacle_avoidance/obstacle_avoidance.h>
@@ -87,20 +88,23 @@ TEST(ABlockPositionComputer, FindsClosestPositionToCubesCase4)
 }
 
 static struct _map map;
-struct _map* map_server_map_lock_and_get(void)
+int map_server_plan_path(point_t start, point_t end, bool ignore_opponents, point_t* path, int max_points)
 {
-    return &map;
-}
+    CHECK_FALSE(ignore_opponents);
 
-void map_server_map_release(struct _map* map_ptr)
-{
-    POINTERS_EQUAL(&map, map_ptr);
+    point_t* points;
+    int num_points = map_plan_path(&map, start, end, &points);
+    CHECK_TRUE(num_points <= max_points);
+    if (num_points > 0) {
+        memcpy(path, points, num_points * sizeof(point_t));
+    }
+    return num_points;
 }
 
 TEST_GROUP (ADistanceToTargetPosition) {
     void setup()
     {
-        oa_init(&map.oa);
+        CHECK_EQUAL(0, oa_init(&map.oa));
         polygon_set_boundingbox(0, 0, 3000, 2000);
 
         poly_t* obstacle = oa_new_poly(&map.oa, 4);
@@ -109,6 +113,11 @@ TEST_GROUP (ADistanceToTargetPosition) {
         obstacle->pts[2] = {600, 600};
         obstacle->pts[3] = {400, 600};
     }
+
+    void teardown()
+    {
+        oa_deinit(&map.oa);
+    }
 };
 
 TEST(ADistanceToTargetPosition, ComputesInfinityForUnreachablePoint)
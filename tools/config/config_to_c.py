@@ -4,6 +4,10 @@ Generates C code to initialize the parameter tree given a YAML file
 
 When given multiple YAML files as input, the generated code is compared.
 If the code does not match, an error is raised.
+
+Optionally generates a header with typed accessors for each parameter, which
+read it through its parameter_t without looking up its path, and a
+CONFIG_PATH() macro which fails to compile for paths not in the YAML.
 """
 import yaml
 from binascii import hexlify
@@ -23,6 +27,63 @@ def sanitize_keys(to_convert):
     return {k: sanitize_keys(v) for k, v in to_convert.items()}
 
 
+ACCESSORS_HEADER = """/* Generated by config_to_c.py, do not edit. */
+#ifndef CONFIG_ACCESSORS_H
+#define CONFIG_ACCESSORS_H
+
+#include <parameter/parameter.h>
+
+#ifdef __cplusplus
+extern "C" {{
+#endif
+
+/* For each parameter, eg master/robot_size_x_mm:
+ *  - config_master_robot_size_x_mm_param() returns the parameter itself,
+ *  - config_master_robot_size_x_mm() reads its value.
+ * Neither looks up the path nor clears the changed flag of the parameter, use
+ * parameter_generation() to know if it was set since it was last read. */
+{declarations}
+
+#ifdef __cplusplus
+}}
+
+{path_table}
+
+constexpr int config_path_index(const char* path)
+{{
+    if (*path == '/') {{
+        path++;
+    }}
+
+    for (int i = 0; config_paths[i] != nullptr; i++) {{
+        int j = 0;
+        while (path[j] != '\\0' && path[j] == config_paths[i][j]) {{
+            j++;
+        }}
+        if (path[j] == config_paths[i][j]) {{
+            return i;
+        }}
+    }}
+
+    return -1;
+}}
+
+template <int Index>
+constexpr const char* config_checked_path()
+{{
+    static_assert(Index >= 0, "Unknown config parameter");
+    return config_paths[Index];
+}}
+
+/* Checks at compile time that the path is a parameter of the config, eg
+ * config_get_scalar(CONFIG_PATH("master/odometry/external_track_mm")) */
+#define CONFIG_PATH(path) config_checked_path<config_path_index(path)>()
+#endif
+
+#endif /* CONFIG_ACCESSORS_H */
+"""
+
+
 def parse_args():
     parser = argparse.ArgumentParser()
     parser.add_argument(
@@ -34,6 +95,11 @@ def parse_args():
     parser.add_argument(
         "output", type=argparse.FileType("w"), help="Name of the generated C file"
     )
+    parser.add_argument(
+        "--accessors",
+        type=argparse.FileType("w"),
+        help="Name of the generated header declaring the typed accessors",
+    )
 
     return parser.parse_args()
 
@@ -55,6 +121,11 @@ def main():
         code += "\n"
         code += "\n"
         code += tree.to_init_code("config_master_init")
+        if args.accessors:
+            code += "\n"
+            code += "\n"
+            code += tree.to_accessor_code()
+            code += "\n"
 
         if previous_code is None:
             previous_code = code
@@ -63,6 +134,14 @@ def main():
 
     args.output.write(code)
 
+    if args.accessors:
+        args.accessors.write(
+            ACCESSORS_HEADER.format(
+                declarations=tree.to_accessor_declarations(),
+                path_table=tree.to_path_table(),
+            )
+        )
+
 
 if __name__ == "__main__":
     main()
@@ -2,6 +2,7 @@
 import msgpack
 import yaml
 import argparse
+import os
 
 from binascii import hexlify
 
@@ -19,23 +20,40 @@ def keys_to_str(to_convert):
 
 def main():
     parser = argparse.ArgumentParser()
+    parser.add_argument("--name", help="symbol name of the MessagePack buffer")
     parser.add_argument(
-        "--name", required=True, help="symbol name of the MessagePack buffer"
+        "--raw",
+        action="store_true",
+        help="write the MessagePack data itself instead of C code, "
+        "for example for the --config_file option of master-firmware",
     )
     parser.add_argument(
         "config_file", type=argparse.FileType(), help="YAML file containing the config"
     )
     parser.add_argument(
         "output",
-        type=argparse.FileType("w"),
         help="Name of the MessagePack encoded output file",
     )
     args = parser.parse_args()
 
+    if not args.raw and args.name is None:
+        parser.error("--name is required to generate C code")
+
     config = yaml.safe_load(args.config_file)
     config = keys_to_str(config)
     binary = msgpack.packb(config, use_single_float=True)
 
+    if args.raw:
+        # Written next to the destination then renamed, so that a program
+        # watching the file never reads it half written
+        tmp_path = args.output + ".tmp"
+        with open(tmp_path, "wb") as f:
+            f.write(binary)
+        os.replace(tmp_path, args.output)
+        return
+
+    args.output = open(args.output, "w")
+
     args.output.write("/* generated file */\n")
     args.output.write("#include <stddef.h>\n")
     args.output.write("unsigned char {:s}[] = {{".format(args.name))
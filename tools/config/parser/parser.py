@@ -30,6 +30,56 @@ class Parameter:
 
         return s.format(var=self.var, name=self.name, parent=".".join(self.parents))
 
+    def path(self):
+        """Path of the parameter relative to the root namespace"""
+        return "/".join(self.parents[1:] + [self.name])
+
+    def _accessor_name(self):
+        return "_".join(p.replace("-", "_") for p in self.parents + [self.name])
+
+    def _accessor_signature(self):
+        name = self._accessor_name()
+        if isinstance(self.value, bool):
+            return "bool {}(void)".format(name)
+        elif isinstance(self.value, int):
+            return "int32_t {}(void)".format(name)
+        elif isinstance(self.value, float):
+            return "float {}(void)".format(name)
+        elif isinstance(self.value, str):
+            return "uint16_t {}(char* out, uint16_t out_size)".format(name)
+        else:
+            raise TypeError("[Parameter] Unsupported type: {}".format(type(self.value)))
+
+    def to_accessor_declaration(self):
+        return [
+            "parameter_t* {}_param(void);".format(self._accessor_name()),
+            "{};".format(self._accessor_signature()),
+        ]
+
+    def to_accessor_code(self):
+        param = "&{}.{}".format(".".join(self.parents), self.var)
+
+        if isinstance(self.value, bool):
+            read = "return parameter_boolean_read({});".format(param)
+        elif isinstance(self.value, int):
+            read = "return parameter_integer_read({});".format(param)
+        elif isinstance(self.value, float):
+            read = "return parameter_scalar_read({});".format(param)
+        else:
+            read = "return parameter_string_read({}, out, out_size);".format(param)
+
+        return [
+            "parameter_t* {}_param(void)".format(self._accessor_name()),
+            "{",
+            "    return {};".format(param),
+            "}",
+            "",
+            self._accessor_signature(),
+            "{",
+            "    " + read,
+            "}",
+        ]
+
 
 class ParameterNamespace:
     def __init__(self, name, params, parents=[], indent=0):
@@ -100,6 +150,36 @@ class ParameterNamespace:
 
         return "\n".join(string)
 
+    def parameters(self):
+        """All the parameters of the namespace and its sub-namespaces"""
+        for child in self.params or []:
+            if isinstance(child, ParameterNamespace):
+                yield from child.parameters()
+            else:
+                yield child
+
+    def to_accessor_declarations(self):
+        string = []
+        for param in self.parameters():
+            string += param.to_accessor_declaration()
+
+        return "\n".join(string)
+
+    def to_accessor_code(self):
+        string = []
+        for param in self.parameters():
+            string += param.to_accessor_code() + [""]
+
+        return "\n".join(string[:-1])
+
+    def to_path_table(self):
+        """C++ table of the parameter paths, for CONFIG_PATH()"""
+        string = ["static constexpr const char* config_paths[] = {"]
+        string += ['    "{}",'.format(p.path()) for p in self.parameters()]
+        string += ["    nullptr,", "};"]
+
+        return "\n".join(string)
+
 
 def depth(d, level=1):
     if isinstance(d, dict):
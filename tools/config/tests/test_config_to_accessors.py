@@ -0,0 +1,77 @@
+import unittest
+
+from parser.parser import parse_tree
+
+
+class TestAccessorGenerator(unittest.TestCase):
+    def test_declares_handle_and_typed_read(self):
+        config = {"controller": {"kp": 0.1, "mode": 3, "on": True}}
+        expected_code = [
+            "parameter_t* config_controller_kp_param(void);",
+            "float config_controller_kp(void);",
+            "parameter_t* config_controller_mode_param(void);",
+            "int32_t config_controller_mode(void);",
+            "parameter_t* config_controller_on_param(void);",
+            "bool config_controller_on(void);",
+        ]
+
+        code = parse_tree(config).to_accessor_declarations().split("\n")
+
+        self.assertEqual(code, expected_code)
+
+    def test_accessors_use_the_struct_member(self):
+        config = {"robot": {"size": 42}}
+        expected_code = [
+            "parameter_t* config_robot_size_param(void)",
+            "{",
+            "    return &config.robot.size;",
+            "}",
+            "",
+            "int32_t config_robot_size(void)",
+            "{",
+            "    return parameter_integer_read(&config.robot.size);",
+            "}",
+        ]
+
+        code = parse_tree(config).to_accessor_code().split("\n")
+
+        self.assertEqual(code, expected_code)
+
+    def test_string_accessor_copies_to_buffer(self):
+        config = {"name": "foo"}
+
+        code = parse_tree(config).to_accessor_code().split("\n")
+
+        self.assertIn("uint16_t config_name(char* out, uint16_t out_size)", code)
+        self.assertIn(
+            "    return parameter_string_read(&config.name, out, out_size);", code
+        )
+
+    def test_replaces_dash_in_accessor_name(self):
+        config = {"the-answer": 42}
+
+        code = parse_tree(config).to_accessor_declarations().split("\n")
+
+        self.assertEqual(code[1], "int32_t config_the_answer(void);")
+
+    def test_path_table_lists_every_parameter(self):
+        config = {"a": 1, "robot": {"controller": {"kp": 1.0}, "size": 42}}
+        expected_code = [
+            "static constexpr const char* config_paths[] = {",
+            '    "a",',
+            '    "robot/controller/kp",',
+            '    "robot/size",',
+            "    nullptr,",
+            "};",
+        ]
+
+        code = parse_tree(config).to_path_table().split("\n")
+
+        self.assertEqual(code, expected_code)
+
+    def test_empty_config_has_no_accessors(self):
+        self.assertEqual(parse_tree({}).to_accessor_declarations(), "")
+
+
+if __name__ == "__main__":
+    unittest.main()